@@ -2,8 +2,11 @@
 
 void* ArrayElements::locate(int i)
 {
-  int segment_index = floor(log2(i/16 + 1));
-  int element_offset = i - 16 * ((1 << segment_index) - 1);
+  if (i < flat_capacity) {
+    return (uint8_t*)segments[0] + i * element_size;
+  }
+  int segment_index = 31 - __builtin_clz((i >> flat_shift) + 1);
+  int element_offset = i - (((1 << segment_index) - 1) << flat_shift);
   void* element_slot = (uint8_t*)segments[segment_index] + element_offset * element_size;
   return element_slot;
 }
@@ -12,13 +15,14 @@ Array* Array::allocate(Arena* storage, int element_size, int segment_count)
 {
   assert(segment_count >= 1 && segment_count <= 16);
 
-  Array* array = (Array*)storage->allocate(sizeof(Array), 1);
-  storage->allocate(sizeof(void**), segment_count);
+  /* The segment table is a flexible array member, allocated together with the struct. */
+  Array* array = (Array*)storage->allocate(sizeof(Array) + sizeof(void*) * segment_count, 1, alignof(Array));
   array->storage = storage;
   array->elements.segment_count = segment_count;
   array->elements.element_size = element_size;
   array->elements.segments[0] = storage->allocate(element_size, 16);
-  memset(array->elements.segments[0], 0, sizeof(element_size) * 16);
+  array->elements.flat_capacity = 16;
+  array->elements.flat_shift = 4;
   array->element_count = 0;
   array->capacity = 16;
   return array;
@@ -28,14 +32,22 @@ void Array::extend()
 {
   assert(element_count >= capacity);
 
-  int last_segment = floor(log2(capacity/16 + 1));
+  if (capacity == elements.flat_capacity) {
+    uint64_t flat_size = (uint64_t)elements.element_size * capacity;
+    if (storage->try_extend(elements.segments[0], flat_size, 2 * flat_size)) {
+      capacity = elements.flat_capacity = 2 * capacity;
+      elements.flat_shift += 1;
+      return;
+    }
+  }
+  int last_segment = 31 - __builtin_clz((capacity >> elements.flat_shift) + 1);
   if (last_segment >= elements.segment_count) {
     printf("\nMaximum array capacity has been reached.\n");
     exit(1);
   }
-  int segment_capacity = 16 * (1 << last_segment);
+  int segment_capacity = elements.flat_capacity * (1 << last_segment);
   elements.segments[last_segment] = storage->allocate(elements.element_size, segment_capacity);
-  capacity = 16 * ((1 << (last_segment + 1)) - 1);
+  capacity += segment_capacity;
 }
 
 void* Array::get(int i)
@@ -54,4 +66,45 @@ void* Array::append()
   void* elem_slot = elements.locate(element_count);
   element_count += 1;
   return elem_slot;
-}
\ No newline at end of file
+}
+
+ArrayIterator::ArrayIterator()
+{
+  array = 0;
+}
+
+ArrayIterator::ArrayIterator(Array* array)
+{
+  begin(array);
+}
+
+void ArrayIterator::begin(Array* array_)
+{
+  array = array_;
+  slot = (uint8_t*)array->elements.segments[0];
+  segment_end = slot + array->elements.element_size * array->elements.flat_capacity;
+  segment_index = 0;
+  i = 0;
+}
+
+void* ArrayIterator::next()
+{
+  if (i >= array->element_count) {
+    return 0;
+  }
+  if (slot == segment_end) {
+    ArrayElements* elements = &array->elements;
+    if (segment_index == 0 && elements->flat_capacity * elements->element_size > segment_end - (uint8_t*)elements->segments[0]) {
+      /* The first segment has grown in place since. */
+      segment_end = (uint8_t*)elements->segments[0] + elements->element_size * elements->flat_capacity;
+    } else {
+      segment_index += 1;
+      slot = (uint8_t*)elements->segments[segment_index];
+      segment_end = slot + elements->element_size * (elements->flat_capacity << segment_index);
+    }
+  }
+  void* element_slot = slot;
+  slot += array->elements.element_size;
+  i += 1;
+  return element_slot;
+}
@@ -3,7 +3,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
 #include "adt/basic.h"
 #include "adt/array.h"
 #include "memory/arena.h"
@@ -26,11 +26,23 @@
  * ...
  *
  * C(n) = (2^n - 1)*16
+ *
+ * The first segment is doubled in place for as long as it is the last
+ * allocation in its arena, and only then are further segments added,
+ * each twice the size of the previous. With F the final capacity of the first segment:
+ *
+ * C(n) = (2^n - 1)*F
+ *
+ * F is a power of two, so the segment of element i >= F is found with integer math:
+ *
+ *   k = floor(log2(i/F + 1)),  starting at index (2^k - 1)*F
  **/
 
 struct ArrayElements {
   int segment_count;
   int element_size;
+  int flat_capacity;
+  int flat_shift;
   void* segments[];
 
   void* locate(int i);
@@ -47,3 +59,90 @@ struct Array {
   void* get(int i);
   void* append();
 };
+
+/**
+ * Walks the elements in order, one segment at a time, without locating
+ * each element. Appending while iterating is fine.
+ **/
+struct ArrayIterator {
+  Array* array;
+  uint8_t* slot;
+  uint8_t* segment_end;
+  int segment_index;
+  int i;
+
+  ArrayIterator();
+  ArrayIterator(Array* array);
+  void begin(Array* array);
+  void* next();
+};
+
+template<class T>
+struct SegmentedArray : Array {
+  static SegmentedArray<T>* allocate(Arena* storage, int segment_count) {
+    return (SegmentedArray<T>*)Array::allocate(storage, sizeof(T), segment_count);
+  }
+
+  T* get(int i) {
+    return (T*)Array::get(i);
+  }
+
+  T* append() {
+    return (T*)Array::append();
+  }
+};
+
+template<class T>
+struct SegmentedArrayIterator : ArrayIterator {
+  SegmentedArrayIterator(SegmentedArray<T>* array) : ArrayIterator(array) {}
+
+  T* next() {
+    return (T*)ArrayIterator::next();
+  }
+};
+
+/**
+ * Elements in one block. When the block is full, it grows in place if it is
+ * the last allocation in its arena, and otherwise the elements move to a block
+ * twice the size. Indices stay valid across appends; pointers to the elements
+ * only until the next append.
+ **/
+template<class T>
+struct FlatArray {
+  Arena* storage;
+  T* elements;
+  int element_count;
+  int capacity;
+
+  static FlatArray<T>* allocate(Arena* storage, int capacity) {
+    assert(capacity >= 1);
+    FlatArray<T>* array = storage->allocate<FlatArray<T>>();
+    array->storage = storage;
+    array->elements = storage->allocate<T>(capacity);
+    array->element_count = 0;
+    array->capacity = capacity;
+    return array;
+  }
+
+  void extend() {
+    uint64_t size = sizeof(T) * (uint64_t)capacity;
+    if (!storage->try_extend(elements, size, 2 * size)) {
+      T* moved = storage->allocate<T>(2 * capacity);
+      memcpy(moved, elements, size);
+      elements = moved;
+    }
+    capacity = 2 * capacity;
+  }
+
+  T* get(int i) {
+    assert(i >= 0 && i < element_count);
+    return &elements[i];
+  }
+
+  T* append() {
+    if (element_count >= capacity) {
+      extend();
+    }
+    return &elements[element_count++];
+  }
+};
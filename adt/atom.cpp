@@ -0,0 +1,102 @@
+#include <memory.h>
+#include "adt/basic.h"
+#include "adt/atom.h"
+
+static const uint64_t K_MUL = 0xff51afd7ed558ccdull, K_FINAL = 0xc4ceb9fe1a85ec53ull;
+static const uint64_t SIGMA = 0x9e3779b97f4a7c15ull;
+
+/**
+ * Linear probing over a power-of-two table of atoms. The atoms
+ * live as long as the program, in their own arena.
+ * The table is not locked: interning is done by the frontend thread.
+ **/
+static Arena atom_storage = {};
+static char** atom_slots = 0;
+static uint32_t atom_capacity = 0;
+static uint32_t atom_count = 0;
+
+static inline uint64_t mix_word(uint64_t h, uint64_t word)
+{
+  h = (h ^ word) * K_MUL;
+  return h ^ (h >> 32);
+}
+
+namespace atom {
+  /**
+   * Hashes 8 bytes per step, seeded with the length.
+   **/
+  uint32_t hash_bytes(uint8_t* bytes, uint32_t len) {
+    uint64_t h = len * SIGMA;
+    uint64_t word;
+    uint32_t n = len;
+    for (; n >= 8; n -= 8, bytes += 8) {
+      memcpy(&word, bytes, 8);
+      h = mix_word(h, word);
+    }
+    if (n > 0) {
+      word = 0;
+      for (uint32_t i = 0; i < n; i++) {
+        word |= (uint64_t)bytes[i] << (8 * i);
+      }
+      h = mix_word(h, word);
+    }
+    h ^= h >> 29;
+    h *= K_FINAL;
+    h ^= h >> 32;
+    return (uint32_t)h;
+  }
+
+  static void grow() {
+    char** old_slots = atom_slots;
+    uint32_t old_capacity = atom_capacity;
+
+    if (!old_capacity) {
+      Memory::name_arena(&atom_storage, "atom_storage");
+    }
+    atom_capacity = old_capacity ? 2 * old_capacity : 1024;
+    atom_slots = atom_storage.allocate<char*>(atom_capacity);
+    for (uint32_t i = 0; i < old_capacity; i++) {
+      char* atom = old_slots[i];
+      if (!atom) {
+        continue;
+      }
+      uint32_t slot = hash(atom) & (atom_capacity - 1);
+      while (atom_slots[slot]) {
+        slot = (slot + 1) & (atom_capacity - 1);
+      }
+      atom_slots[slot] = atom;
+    }
+  }
+
+  /**
+   * The atom for the string [begin, end).
+   **/
+  char* intern(char* begin, char* end) {
+    uint32_t len = end - begin;
+    uint32_t h = hash_bytes((uint8_t*)begin, len);
+
+    if (2 * (atom_count + 1) > atom_capacity) {
+      grow();
+    }
+    uint32_t slot = h & (atom_capacity - 1);
+    for (char* atom = atom_slots[slot]; atom; atom = atom_slots[slot]) {
+      if (hash(atom) == h && atom::len(atom) == len && memcmp(atom, begin, len) == 0) {
+        return atom;
+      }
+      slot = (slot + 1) & (atom_capacity - 1);
+    }
+    AtomHeader* header = (AtomHeader*)atom_storage.allocate_uninit(sizeof(AtomHeader) + len + 1, 1, alignof(AtomHeader));
+    header->hash = h;
+    header->len = len;
+    char* atom = (char*)(header + 1);
+    memcpy(atom, begin, len);
+    atom[len] = '\0';
+    atom_slots[slot] = atom;
+    atom_count += 1;
+    return atom;
+  }
+
+  char* intern(char* string) {
+    return intern(string, string + strlen(string));
+  }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include "memory/arena.h"
+
+/**
+ * An atom is the one copy of a string kept in the intern table, so that
+ * two atoms are equal iff their pointers are.
+ *
+ * The hash and the length of the string are stored just before its first character:
+ *
+ *   [hash : 4][len : 4][chars ... \0]
+ *                      ^ atom
+ **/
+struct AtomHeader {
+  uint32_t hash;
+  uint32_t len;
+};
+
+namespace atom {
+  char* intern(char* begin, char* end);
+  char* intern(char* string);
+  uint32_t hash_bytes(uint8_t* bytes, uint32_t len);
+
+  inline uint32_t hash(char* atom) {
+    return ((AtomHeader*)atom - 1)->hash;
+  }
+
+  inline uint32_t len(char* atom) {
+    return ((AtomHeader*)atom - 1)->len;
+  }
+
+  inline bool match(char* atom_a, char* atom_b) {
+    return atom_a == atom_b;
+  }
+}
@@ -4,7 +4,8 @@
 #include <stdint.h>
 
 #define KILOBYTE 1024
-#define MEGABYTE 1024 * KILOBYTE
+#define MEGABYTE (1024 * KILOBYTE)
+#define GIGABYTE (1024ull * MEGABYTE)
 
 void assert_(char* message, char* file, int line);
 #define assert(expr) do { if(!(expr)) assert_(#expr, __FILE__, __LINE__); } while(0)
@@ -1,49 +1,67 @@
 #include "adt/map.h"
 
-MapEntry* Map::search_entry(MapEntry* entry, void* key)
+static inline uint32_t hash_pointer(void* key)
 {
-  if (!entry) {
-    return 0;
-  } else if (entry->key == key) {
-    return entry;
-  } else if (key < entry->key) {
-    return search_entry(entry->left_branch, key);
-  } else {
-    return search_entry(entry->right_branch, key);
+  uint64_t h = (uint64_t)key;
+  h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdull;
+  return (uint32_t)(h ^ (h >> 32));
+}
+
+Map* Map::allocate(Arena* storage, int capacity)
+{
+  Map* map = storage->allocate<Map>();
+  map->storage = storage;
+  map->reserve(capacity);
+  return map;
+}
+
+void Map::reserve(int capacity_)
+{
+  assert(!slots);
+  capacity = MAP_MIN_CAPACITY;
+  while (capacity < capacity_) {
+    capacity *= 2;
   }
-  assert(0);
-  return 0;
+  slots = storage->allocate<MapSlot>(capacity);
 }
 
-MapEntry* Map::insert_entry(MapEntry** branch, MapEntry* entry,
-             void* key, void* value, bool return_if_found)
+void Map::grow()
 {
-  if (!entry) {
-    entry = (MapEntry*)storage->allocate(sizeof(MapEntry), 1);
-    *branch = entry;
-    entry->key = key;
-    entry->value = value;
-    entry->left_branch = 0;
-    entry->right_branch = 0;
-    entry->next = first;
-    first = entry;
-    return entry;
-  } else if (entry->key == key) {
-    if (return_if_found) { return entry; } else { return 0; }
-  } else if (key < entry->key) {
-    return insert_entry(&entry->left_branch, entry->left_branch,
-                        key, value, return_if_found);
-  } else {
-    return insert_entry(&entry->right_branch, entry->right_branch,
-                        key, value, return_if_found);
+  MapSlot* old_slots = slots;
+  int old_capacity = capacity;
+
+  capacity = 2 * old_capacity;
+  slots = storage->allocate<MapSlot>(capacity);
+  for (int i = 0; i < old_capacity; i++) {
+    if (!old_slots[i].entry) {
+      continue;
+    }
+    uint32_t s = hash_pointer(old_slots[i].key) & (capacity - 1);
+    while (slots[s].entry) {
+      s = (s + 1) & (capacity - 1);
+    }
+    slots[s] = old_slots[i];
   }
-  assert(0);
-  return 0;
+}
+
+/**
+ * The slot holding `key`, or the empty slot where it would be inserted.
+ **/
+MapSlot* Map::find_slot(void* key)
+{
+  uint32_t s = hash_pointer(key) & (capacity - 1);
+  while (slots[s].entry && slots[s].key != key) {
+    s = (s + 1) & (capacity - 1);
+  }
+  return &slots[s];
 }
 
 void* Map::lookup(void* key, MapEntry** entry)
 {
-  MapEntry* m = search_entry(root, key);
+  MapEntry* m = 0;
+  if (slots) {
+    m = find_slot(key)->entry;
+  }
   void* value = 0;
   if (m) { value = m->value; }
   if (entry) { *entry = m; }
@@ -52,14 +70,27 @@ void* Map::lookup(void* key, MapEntry** entry)
 
 MapEntry* Map::insert(void* key, void* value, bool return_if_found)
 {
-  return insert_entry(&root, root, key, value, return_if_found);
+  if (!slots) {
+    reserve(MAP_MIN_CAPACITY);
+  } else if (2 * (entry_count + 1) > capacity) {
+    grow();
+  }
+  MapSlot* slot = find_slot(key);
+  if (slot->entry) {
+    if (return_if_found) { return slot->entry; } else { return 0; }
+  }
+  MapEntry* entry = storage->allocate<MapEntry>();
+  entry->key = key;
+  entry->value = value;
+  entry->next = first;
+  first = entry;
+  slot->key = key;
+  slot->entry = entry;
+  entry_count += 1;
+  return entry;
 }
 
 int Map::count()
 {
-  int c = 0;
-  for (MapEntry*  m = first; m != 0; m = m->next) {
-    c += 1;
-  }
-  return c;
+  return entry_count;
 }
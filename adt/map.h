@@ -2,22 +2,40 @@
 
 #include "memory/arena.h"
 
+/**
+ * A hash table keyed by pointer, with linear probing. The slots hold the
+ * key next to its entry, so a probe doesn't have to load the entry;
+ * a slot is empty when its entry is null (a null key is allowed).
+ *
+ * Entries don't move when the table grows, and are also linked in a list,
+ * most recently inserted first, for iteration.
+ * The slot array is allocated on the first insert, so a zero-initialized
+ * Map with its `storage` set is an empty map.
+ **/
+#define MAP_MIN_CAPACITY  8
+
 struct MapEntry {
   MapEntry* next;
-  MapEntry* left_branch;
-  MapEntry* right_branch;
   void* key;
   void* value;
 };
 
+struct MapSlot {
+  void* key;
+  MapEntry* entry;
+};
+
 struct Map {
   Arena* storage;
   MapEntry* first;
-  MapEntry* root;
+  MapSlot* slots;
+  int capacity;
+  int entry_count;
 
-  MapEntry* search_entry(MapEntry* entry, void* key);
-  MapEntry* insert_entry(MapEntry** branch, MapEntry* entry,
-               void* key, void* value, bool return_if_found);
+  static Map* allocate(Arena* storage, int capacity = MAP_MIN_CAPACITY);
+  void reserve(int capacity);
+  void grow();
+  MapSlot* find_slot(void* key);
   void* lookup(void* key, MapEntry** entry);
   MapEntry* insert(void* key, void* value, bool return_if_found);
   int count();
@@ -1,100 +1,159 @@
+#include <stdio.h>
 #include <memory.h>
+#if __SSE2__
+#include <emmintrin.h>
+#endif
 #include "adt/strmap.h"
-#include "adt/cstring.h"
+#include "adt/atom.h"
 
-static const uint32_t P = 257, Q = 4294967029;
-static const uint32_t SIGMA = 2654435769;
-
-static uint32_t hash_string(char* string, uint32_t m)
+/**
+ * Bit i of the result is set when slot i of the group has the control byte `tag`.
+ **/
+static uint32_t match_group(uint8_t* group, uint8_t tag)
 {
-  assert(m > 0 && m <= 32);
-
-  uint32_t K = 0;
-  for (uint8_t* s = (uint8_t*)string; (*s); s++) {
-    K = (P * K + (*s)) % Q;
+#if __SSE2__
+  __m128i control = _mm_load_si128((__m128i*)group);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(tag)));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < STRMAP_GROUP_SIZE; i++) {
+    mask |= (uint32_t)(group[i] == tag) << i;
   }
-  uint64_t KxSigma = (uint64_t)K * (uint64_t)SIGMA;
-  uint32_t h = ((uint32_t)KxSigma) >> (32 - m);  /* 0 <= h < 2^m */
-  return h;
+  return mask;
+#endif
 }
 
-static uint32_t hash_key(char* key, int m, int capacity)
+static uint32_t match_empty(uint8_t* group)
 {
-  uint32_t h = hash_string(key, m) % capacity;
-  return h;
+#if __SSE2__
+  return _mm_movemask_epi8(_mm_load_si128((__m128i*)group));
+#else
+  return match_group(group, STRMAP_EMPTY);
+#endif
 }
 
-Strmap* Strmap::allocate(Arena* storage, int segment_count)
+Strmap* Strmap::allocate(Arena* storage, int capacity)
 {
-  assert(segment_count >= 1 && segment_count <= 16);
+  assert(capacity >= 1);
 
-  Strmap* strmap = (Strmap*)storage->allocate(sizeof(Strmap), 1);
-  storage->allocate(sizeof(StrmapEntry*), segment_count);
+  Strmap* strmap = storage->allocate<Strmap>();
   strmap->storage = storage;
-  strmap->entries.element_size = sizeof(StrmapEntry*);
-  strmap->entries.segment_count = segment_count;
-  strmap->entries.segments[0] = (StrmapEntry**)storage->allocate(sizeof(StrmapEntry*), 16);
-  memset(strmap->entries.segments[0], 0, sizeof(StrmapEntry*) * 16);
+  strmap->capacity = STRMAP_GROUP_SIZE;
+  while (strmap->capacity < capacity) {
+    strmap->capacity *= 2;
+  }
+  strmap->control = storage->allocate<uint8_t>(strmap->capacity, STRMAP_GROUP_SIZE);
+  memset(strmap->control, STRMAP_EMPTY, strmap->capacity);
+  strmap->slots = storage->allocate<StrmapEntry>(strmap->capacity);
   strmap->entry_count = 0;
-  strmap->capacity = 16;
   return strmap;
 }
 
-void Strmap::grow()
+/**
+ * Puts an entry moved from the old table in the first empty slot on its probe sequence.
+ **/
+void Strmap::place(StrmapEntry* old_entry)
 {
-  int last_segment = floor(log2(capacity/16 + 1));
-  if (last_segment >= entries.segment_count) {
-    printf("\nMaximum capacity has been reached.\n");
-    exit(1);
-  }
-  StrmapIterator it(this);
-  StrmapEntry* first_entry = it.next();
-  StrmapEntry* last_entry = first_entry;
-  int entry_count = first_entry ? 1 : 0;
-  for (StrmapEntry* entry = it.next();
-       entry != 0; entry = it.next()) {
-    last_entry->next_entry = entry;
-    last_entry = entry;
-    entry_count += 1;
+  uint32_t group_mask = capacity / STRMAP_GROUP_SIZE - 1;
+  uint32_t g = (old_entry->hash >> 7) & group_mask;
+  for (int step = 1; ; step++) {
+    uint32_t empty_slots = match_empty(&control[g * STRMAP_GROUP_SIZE]);
+    if (empty_slots) {
+      int slot = g * STRMAP_GROUP_SIZE + __builtin_ctz(empty_slots);
+      control[slot] = old_entry->hash & 0x7F;
+      slots[slot] = *old_entry;
+      return;
+    }
+    g = (g + step) & group_mask;
   }
-  assert(entry_count == this->entry_count);
-  int segment_capacity = 16 * (1 << last_segment);
-  entries.segments[last_segment] = (StrmapEntry**)storage->allocate(sizeof(StrmapEntry*), segment_capacity);
-  capacity = 16 * ((1 << (last_segment + 1)) - 1);
-  for (int i = 0; i <= last_segment; i++) {
-    segment_capacity = 16 * (1 << i);
-    for (int j = 0; j < segment_capacity; j ++) {
-      StrmapEntry** segment = (StrmapEntry**)entries.segments[i];
-      segment[j] = 0;
+}
+
+/**
+ * Moves the entries of the next `group_count` groups of the old table.
+ * The old control bytes are left as they are, see Strmap::lookup.
+ **/
+void Strmap::migrate(int group_count)
+{
+  int old_group_count = old_capacity / STRMAP_GROUP_SIZE;
+  for (; group_count > 0 && migrate_at < old_group_count; group_count--, migrate_at++) {
+    for (int i = migrate_at * STRMAP_GROUP_SIZE; i < (migrate_at + 1) * STRMAP_GROUP_SIZE; i++) {
+      if (old_control[i] != STRMAP_EMPTY) {
+        place(&old_slots[i]);
+      }
     }
   }
-  for (StrmapEntry* entry = first_entry; entry != 0; ) {
-    StrmapEntry* next_entry = entry->next_entry;
-    uint32_t h = hash_key(entry->key, 4 + (last_segment + 1), capacity);
-    StrmapEntry** entry_slot = (StrmapEntry**) entries.locate(h);
-    entry->next_entry = *entry_slot;
-    *entry_slot = entry;
-    entry = next_entry;
+  if (migrate_at == old_group_count) {
+    old_control = 0;
+    old_slots = 0;
+    old_capacity = 0;
+    migrate_at = 0;
   }
 }
 
-void* Strmap::lookup(char* key, StrmapEntry** entry_/*out*/, StrmapBucket* bucket/*out*/)
+void Strmap::grow()
 {
-  int last_segment = floor(log2(capacity/16));
-  uint32_t h = hash_key(key, 4 + (last_segment + 1), capacity);
-  StrmapEntry** entry_slot = (StrmapEntry**) entries.locate(h);
-  StrmapEntry* entry = *entry_slot;
-  while (entry) {
-    if (cstring::match(entry->key, key)) {
-      break;
+  if (old_control) {
+    migrate(old_capacity / STRMAP_GROUP_SIZE);
+  }
+  old_control = control;
+  old_slots = slots;
+  old_capacity = capacity;
+  migrate_at = 0;
+
+  capacity = 2 * old_capacity;
+  control = storage->allocate<uint8_t>(capacity, STRMAP_GROUP_SIZE);
+  memset(control, STRMAP_EMPTY, capacity);
+  slots = storage->allocate<StrmapEntry>(capacity);
+  migrate(STRMAP_MIGRATE_GROUPS);
+}
+
+/**
+ * The entry for `key` in the table, and the empty slot where the key
+ * would be inserted otherwise.
+ **/
+static StrmapEntry* probe(uint8_t* control, StrmapEntry* slots, int capacity,
+         char* key, uint32_t h, int* empty_slot/*out*/)
+{
+  uint8_t tag = h & 0x7F;
+  uint32_t group_mask = capacity / STRMAP_GROUP_SIZE - 1;
+  uint32_t g = (h >> 7) & group_mask;
+
+  /* Triangular probing visits every group, when the group count is a power of 2. */
+  for (uint32_t step = 1; step <= group_mask + 1; step++) {
+    uint8_t* group = &control[g * STRMAP_GROUP_SIZE];
+    for (uint32_t candidates = match_group(group, tag); candidates; candidates &= candidates - 1) {
+      StrmapEntry* candidate = &slots[g * STRMAP_GROUP_SIZE + __builtin_ctz(candidates)];
+      if (atom::match(candidate->key, key)) {
+        return candidate;
+      }
+    }
+    uint32_t empty_slots = match_empty(group);
+    if (empty_slots) {
+      /* A key is never placed past a group with room in it. */
+      *empty_slot = g * STRMAP_GROUP_SIZE + __builtin_ctz(empty_slots);
+      return 0;
     }
-    entry = entry->next_entry;
+    g = (g + step) & group_mask;
+  }
+  *empty_slot = -1;
+  return 0;
+}
+
+void* Strmap::lookup(char* key, StrmapEntry** entry_/*out*/, StrmapBucket* bucket/*out*/)
+{
+  int empty_slot, old_empty_slot;
+
+  uint32_t h = atom::hash(key);
+  StrmapEntry* entry = probe(control, slots, capacity, key, h, &empty_slot);
+  if (!entry && old_control) {
+    /* An entry that was migrated would have been found in the new table,
+       so whatever is found in the old one is still live there. */
+    entry = probe(old_control, old_slots, old_capacity, key, h, &old_empty_slot);
   }
   if (entry_) { *entry_ = entry; }
   if (bucket) {
     bucket->h = h;
-    bucket->entry_slot = entry_slot;
-    bucket->last_segment = last_segment;
+    bucket->empty_slot = empty_slot;
   }
   if (entry) { return entry->value; }
   return 0;
@@ -105,55 +164,47 @@ StrmapEntry* Strmap::insert(char* key, void* value, bool return_if_found)
   StrmapEntry* entry;
   StrmapBucket bucket = {};
 
+  if (old_control) {
+    migrate(STRMAP_MIGRATE_GROUPS);
+  }
+  /* Keep the load under 7/8. */
+  if (8 * (entry_count + 1) > 7 * capacity) {
+    grow();
+  }
   lookup(key, &entry, &bucket);
   if (entry) {
     if (return_if_found) { return entry; } else { return 0; }
   }
-
-  if (entry_count >= capacity) {
-    grow();
-    bucket.last_segment = floor(log2(capacity/16));
-    bucket.h = hash_key(key, 4 + (bucket.last_segment + 1), capacity);
-    bucket.entry_slot = (StrmapEntry**) entries.locate(bucket.h);
-  }
-  entry = (StrmapEntry*)storage->allocate(sizeof(StrmapEntry), 1);
+  assert(bucket.empty_slot >= 0);
+  control[bucket.empty_slot] = bucket.h & 0x7F;
+  entry = &slots[bucket.empty_slot];
   entry->key = key;
   entry->value = value;
-  entry->next_entry = *bucket.entry_slot;
-  *bucket.entry_slot = entry;
+  entry->hash = bucket.h;
   entry_count += 1;
   return entry;
 }
 
 void Strmap::DEBUG_occupancy()
 {
-  int empty_buckets = 0;
-  int total_entry_count = 0,
-      entry_count = 0,
-      max_bucket_length = 0;
-
-  for (int i = 0; i < capacity; i++) {
-    StrmapEntry** entry_slot = (StrmapEntry**) entries.locate(i);
-    StrmapEntry* entry = *entry_slot;
-    entry_count = 0;
-    if (entry) {
-      while (entry) {
-        entry_count += 1;
-        entry = entry->next_entry;
-      }
-      if (entry_count > max_bucket_length) {
-        max_bucket_length = entry_count;
-      }
-    } else {
-      empty_buckets += 1;
+  int empty_groups = 0,
+      max_group_occupancy = 0;
+
+  for (int g = 0; g < capacity / STRMAP_GROUP_SIZE; g++) {
+    int occupancy = STRMAP_GROUP_SIZE - __builtin_popcount(match_empty(&control[g * STRMAP_GROUP_SIZE]));
+    if (occupancy == 0) {
+      empty_groups += 1;
+    }
+    if (occupancy > max_group_occupancy) {
+      max_group_occupancy = occupancy;
     }
-    total_entry_count += entry_count;
-    printf("[%d] -> %d\n", i, entry_count);
+    printf("[%d] -> %d\n", g, occupancy);
   }
   printf(
       "Entry count: %d\n" \
-      "Empty buckets: %d\n" \
-      "Max. bucket length: %d\n", total_entry_count, empty_buckets, max_bucket_length
+      "Capacity: %d\n" \
+      "Empty groups: %d\n" \
+      "Max. group occupancy: %d\n", entry_count, capacity, empty_groups, max_group_occupancy
   );
 }
 
@@ -179,23 +230,29 @@ void StrmapIterator::begin(Strmap* strmap)
 StrmapEntry* StrmapIterator::next()
 {
   Strmap* strmap = this->strmap;
-  StrmapEntry* entry = this->entry;
-  if (entry) {
-    entry = entry->next_entry;
-    if (entry) {
-      this->entry = entry;
-      return this->entry;
-    }
-  }
+  entry = 0;
   i++;
   while (i < strmap->capacity) {
-    StrmapEntry** entry_slot = (StrmapEntry**) strmap->entries.locate(i);
-    entry = *entry_slot;
-    if (entry) {
-      this->entry = entry;
-      break;
+    if (strmap->control[i] != STRMAP_EMPTY) {
+      entry = &strmap->slots[i];
+      return entry;
     }
     i++;
   }
+  /* Then the entries not yet migrated from the old table. */
+  if (strmap->old_control) {
+    int j = i - strmap->capacity;
+    if (j < strmap->migrate_at * STRMAP_GROUP_SIZE) {
+      j = strmap->migrate_at * STRMAP_GROUP_SIZE;
+      i = strmap->capacity + j;
+    }
+    while (j < strmap->old_capacity) {
+      if (strmap->old_control[j] != STRMAP_EMPTY) {
+        entry = &strmap->old_slots[j];
+        break;
+      }
+      i++, j++;
+    }
+  }
   return entry;
 }
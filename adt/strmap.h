@@ -2,27 +2,52 @@
 
 #include <stdint.h>
 #include "memory/arena.h"
-#include "adt/array.h"
+
+/**
+ * Open addressing, in the manner of a Swiss table: the slots are divided
+ * into groups of 16, and each slot has a control byte which is either
+ * STRMAP_EMPTY or the low 7 bits of the key's hash (the tag).
+ * A probe compares the tags of a whole group at once.
+ *
+ * The keys are atoms (see adt/atom.h): their hash is computed once, when
+ * they are interned, and keys are compared by pointer.
+ *
+ * The table grows without a stop: a grown table keeps the old one
+ * alongside, and each insert moves the entries of a few old groups over,
+ * until none are left. Lookups try the new table, then the old.
+ *
+ * Entries move when the table grows, so an entry pointer is only good
+ * until the next insert.
+ **/
+#define STRMAP_GROUP_SIZE      16
+#define STRMAP_EMPTY           0x80
+#define STRMAP_MIGRATE_GROUPS  2
 
 struct StrmapEntry {
   char* key;
   void* value;
-  StrmapEntry* next_entry;
+  uint32_t hash;
 };
 
 struct StrmapBucket {
   uint32_t h;
-  StrmapEntry** entry_slot;
-  int last_segment;
+  int empty_slot;
 };
 
 struct Strmap {
   Arena* storage;
   int entry_count;
   int capacity;
-  ArrayElements entries;
+  uint8_t* control;
+  StrmapEntry* slots;
+  uint8_t* old_control;
+  StrmapEntry* old_slots;
+  int old_capacity;
+  int migrate_at;
 
-  static Strmap* allocate(Arena* storage, int segment_count);
+  static Strmap* allocate(Arena* storage, int capacity);
+  void place(StrmapEntry* old_entry);
+  void migrate(int group_count);
   void grow();
   void* lookup(char* key, StrmapEntry** entry_/*out*/, StrmapBucket* bucket/*out*/);
   StrmapEntry* insert(char* key, void* value, bool return_if_found);
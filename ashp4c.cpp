@@ -8,7 +8,9 @@ int main(int arg_count, char* args[])
 {
   Arena storage = {}, scratch = {};
 
-  Memory::reserve(600 * KILOBYTE);
+  Memory::reserve(1 * GIGABYTE);
+  Memory::name_arena(&storage, "storage");
+  Memory::name_arena(&scratch, "scratch");
 
   CommandLineArg* cmdline_arg = CommandLineArg::parse_cmdline(&storage, arg_count, args);
   CommandLineArg* filename = cmdline_arg->find_unnamed_arg();
@@ -17,14 +19,52 @@ int main(int arg_count, char* args[])
     exit(1);
   }
 
+  if (cmdline_arg->find_named_arg("huge-pages")) {
+    Memory::use_huge_pages();
+  }
+
+  CommandLineArg* release_pages = cmdline_arg->find_named_arg("release-pages");
+  CommandLineArg* release_threshold = cmdline_arg->find_named_arg("release-threshold");
+  if (release_pages || release_threshold) {
+    PageRelease policy = PageRelease::DontNeed;
+    if (release_pages) {
+      if (release_pages->value && cstring::match(release_pages->value, "keep")) {
+        policy = PageRelease::Keep;
+      } else if (release_pages->value && cstring::match(release_pages->value, "free")) {
+        policy = PageRelease::Free;
+      } else if (!release_pages->value || !cstring::match(release_pages->value, "dontneed")) {
+        printf("-release-pages=keep|dontneed|free\n");
+        exit(1);
+      }
+    }
+    uint64_t threshold = PAGE_RELEASE_THRESHOLD;
+    if (release_threshold) {
+      char* end = 0;
+      threshold = release_threshold->value ? strtoull(release_threshold->value, &end, 10) : 0;
+      if (!end || end == release_threshold->value || *end != '\0') {
+        printf("-release-threshold=<kilobytes>\n");
+        exit(1);
+      }
+      threshold *= KILOBYTE;
+    }
+    Memory::set_release_policy(policy, threshold);
+  }
+
+  Memory::begin_phase("SourceText::read_source");
   SourceText source_text = {};
   source_text.read_source(&storage, &scratch, filename->value);
 
   Frontend frontend = {};
+  /* Experimental: a measured slowdown so far, see Ast::compact. */
+  frontend.compact_ast = (cmdline_arg->find_named_arg("compact-ast") != 0);
   frontend.do_analysis(&storage, &scratch, &source_text);
 
   Midend midend = {};
   midend.do_analysis(&storage, &scratch, &source_text, &frontend);
 
+  if (cmdline_arg->find_named_arg("mem-report")) {
+    Memory::print_report();
+  }
+
   return 0;
 }
@@ -0,0 +1,71 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "memory/arena.h"
+#include "bench/bench.h"
+
+/**
+ * How the page pool scales with the number of threads. Each thread owns an
+ * arena and goes through rounds of growing it by a few small blocks and
+ * freeing or rewinding it, the pattern of the compiler's scratch arenas.
+ * Every thread does the same amount of work, so with enough cores the time
+ * stays flat as threads are added, as long as they don't contend on the pool lock.
+ *
+ *   bench_arena_threads [thread_count ...]    (default: 1 2 4 8)
+ **/
+#define ROUND_COUNT       20000
+#define ALLOCATION_COUNT  8
+#define THREAD_COUNT_MAX  64
+
+static void* run_worker(void* arg)
+{
+  BenchRandom random = {(uint64_t)(uintptr_t)arg};
+  Arena arena = {};
+  for (int round = 0; round < ROUND_COUNT; round++) {
+    ArenaMark mark = arena.mark();
+    for (int i = 0; i < ALLOCATION_COUNT; i++) {
+      uint8_t* bytes = (uint8_t*)arena.allocate_uninit(4 * KILOBYTE + random.next() % (28 * KILOBYTE), 1);
+      bytes[0] = 1;
+    }
+    if (round % 4 == 0) {
+      arena.free();
+    } else {
+      arena.rewind(mark);
+    }
+  }
+  arena.free();
+  return 0;
+}
+
+static void run(int thread_count)
+{
+  pthread_t threads[THREAD_COUNT_MAX];
+  double start = bench_now();
+  for (int i = 0; i < thread_count; i++) {
+    pthread_create(&threads[i], 0, run_worker, (void*)(uintptr_t)(i + 1));
+  }
+  for (int i = 0; i < thread_count; i++) {
+    pthread_join(threads[i], 0);
+  }
+  double elapsed = bench_now() - start;
+  printf("threads %2d  %.1f ms, %.2f us per round\n", thread_count, elapsed * 1e3,
+         elapsed / ROUND_COUNT * 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+  Memory::reserve(1 * GIGABYTE);
+  printf("cpus %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      int thread_count = atoi(argv[i]);
+      run(thread_count < THREAD_COUNT_MAX ? thread_count : THREAD_COUNT_MAX);
+    }
+  } else {
+    run(1);
+    run(2);
+    run(4);
+    run(8);
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include "adt/array.h"
+#include "bench/bench.h"
+
+/**
+ * Access to a segmented array of 10^6 ints spread over 16 segments:
+ * get() in index order and in a random order, and the iterator.
+ *
+ *   bench_array_access
+ **/
+#define ELEMENT_COUNT  (1000 * 1000)
+#define ROUND_COUNT    20
+
+int main(int argc, char* argv[])
+{
+  Memory::reserve(4 * GIGABYTE);
+  Arena storage = {};
+  SegmentedArray<int>* array = SegmentedArray<int>::allocate(&storage, 16);
+  /* Keeps the first segment from growing in place, so that all the segments are used. */
+  storage.allocate(8, 1);
+  for (int i = 0; i < ELEMENT_COUNT; i++) {
+    *array->append() = i;
+  }
+  uint32_t* order = storage.allocate<uint32_t>(ELEMENT_COUNT);
+  BenchRandom random = {12345};
+  for (int i = 0; i < ELEMENT_COUNT; i++) {
+    order[i] = random.next() % ELEMENT_COUNT;
+  }
+
+  uint64_t element_count = (uint64_t)ROUND_COUNT * ELEMENT_COUNT;
+  int64_t sum = 0;
+  double start = bench_now();
+  for (int r = 0; r < ROUND_COUNT; r++) {
+    for (int i = 0; i < ELEMENT_COUNT; i++) {
+      sum += *array->get(i);
+    }
+  }
+  printf("sequential get  %.2f ns/element\n", (bench_now() - start) / element_count * 1e9);
+
+  start = bench_now();
+  for (int r = 0; r < ROUND_COUNT; r++) {
+    for (int i = 0; i < ELEMENT_COUNT; i++) {
+      sum += *array->get(order[i]);
+    }
+  }
+  printf("random get      %.2f ns/element\n", (bench_now() - start) / element_count * 1e9);
+
+  start = bench_now();
+  for (int r = 0; r < ROUND_COUNT; r++) {
+    SegmentedArrayIterator<int> it(array);
+    for (int* element = it.next(); element != 0; element = it.next()) {
+      sum += *element;
+    }
+  }
+  printf("iterator        %.2f ns/element\n", (bench_now() - start) / element_count * 1e9);
+
+  printf("segments %d, checksum %lld\n", array->elements.segment_count, (long long)sum);
+  storage.free();
+  return 0;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+
+/**
+ * Helpers shared by the benchmark drivers. Each driver prints one line per
+ * measurement, and takes the best of several runs where a run is short.
+ **/
+static double bench_now()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * A small xorshift generator, so that every driver sees the same sequence
+ * whatever the C library.
+ **/
+struct BenchRandom {
+  uint64_t state;
+
+  uint32_t next()
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (uint32_t)(state >> 32);
+  }
+};
+
+/**
+ * Inputs for the frontend drivers, written to a temporary file that the
+ * caller unlinks. Both return the path, or exit when the file can't be written.
+ *
+ * The generated program has `unit_count` units, each a header, a struct, a
+ * typedef and a control with an action and a table, with block and line
+ * comments in between. It is repeated `copy_count` times: 2000 units make a
+ * 54k-line, 1.2 MB program, and 8 copies of it 9.4 MB.
+ **/
+static FILE* bench_open_input(char* path)
+{
+  strcpy(path, "/tmp/ashp4c_bench_XXXXXX.p4");
+  int fd = mkstemps(path, 3);
+  FILE* file = (fd >= 0) ? fdopen(fd, "w") : 0;
+  if (!file) {
+    printf("Could not create '%s'.\n", path);
+    exit(1);
+  }
+  return file;
+}
+
+static char* bench_generate_program(int unit_count, int copy_count)
+{
+  static char path[64];
+  FILE* file = bench_open_input(path);
+  for (int copy = 0; copy < copy_count; copy++) {
+    fprintf(file, "extern void verify(in bool check, in error toSignal);\n"
+                  "match_kind { exact, ternary }\n");
+    for (int i = 0; i < unit_count; i++) {
+      fprintf(file,
+          "\n"
+          "/* header number %d with a comment block that the lexer has to skip over */\n"
+          "header H%d {\n"
+          "    bit<32> field_a%d;\n"
+          "    bit<16> field_b%d;\n"
+          "    bool    valid_flag;\n"
+          "}\n"
+          "// single line comment %d\n"
+          "struct S%d {\n"
+          "    H%d hdr;\n"
+          "    bit<8> counter;\n"
+          "}\n"
+          "typedef bit<%d> T%d;\n"
+          "control C%d(inout S%d s, in bit<32> x)() {\n"
+          "    action act%d(bit<32> v) {\n"
+          "        s.hdr.field_a%d = v;\n"
+          "    }\n"
+          "    table tbl%d {\n"
+          "        key = { s.hdr.field_b%d : exact; }\n"
+          "        actions = { act%d; }\n"
+          "    }\n"
+          "    apply {\n"
+          "        bit<32> tmp = 32w0x%08x;\n"
+          "        s.counter = 8w1;\n"
+          "        tbl%d.apply();\n"
+          "    }\n"
+          "}\n",
+          i, i, i, i, i, i, i, i % 60 + 1, i, i, i, i, i, i, i, i, i, i);
+    }
+  }
+  fclose(file);
+  return path;
+}
+
+/**
+ * The .p4 files of `directory`, one after the other, `copy_count` times over.
+ **/
+static char* bench_concatenate_files(const char* directory, int copy_count)
+{
+  static char path[64];
+  FILE* file = bench_open_input(path);
+  for (int copy = 0; copy < copy_count; copy++) {
+    DIR* dir = opendir(directory);
+    if (!dir) {
+      printf("Could not open '%s'.\n", directory);
+      exit(1);
+    }
+    for (struct dirent* entry = readdir(dir); entry != 0; entry = readdir(dir)) {
+      int len = strlen(entry->d_name);
+      if (len < 3 || strcmp(entry->d_name + len - 3, ".p4") != 0) {
+        continue;
+      }
+      char file_path[1024];
+      snprintf(file_path, sizeof(file_path), "%s/%s", directory, entry->d_name);
+      FILE* source = fopen(file_path, "r");
+      if (!source) {
+        continue;
+      }
+      char buffer[4096];
+      size_t size;
+      while ((size = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+        fwrite(buffer, 1, size, file);
+      }
+      fputc('\n', file);
+      fclose(source);
+    }
+    closedir(dir);
+  }
+  fclose(file);
+  return path;
+}
@@ -0,0 +1,80 @@
+#include <sys/wait.h>
+#include "frontend/frontend.h"
+#include "midend/midend.h"
+#include "bench/bench.h"
+
+/**
+ * The frontend and the midend on a large generated program, with base pages
+ * and with Memory::use_huge_pages(), best of `repeat_count` runs each. Huge
+ * pages are timed under the default release policy, which drops the pages of
+ * every rewound block past the threshold, and with the pages kept. Huge page
+ * mode can't be turned off again, so each mode runs in a child process of its
+ * own, with a fresh pool. The source is read again for every run, outside of
+ * the timed part.
+ *
+ *   bench_huge_pages [-repeat=N] [unit_count]    (default: 5 runs of 16000 units)
+ **/
+static void run(char* filename, bool huge_pages, bool keep_pages, int repeat_count)
+{
+  Memory::reserve(4 * GIGABYTE);
+  if (huge_pages) {
+    Memory::use_huge_pages();
+  }
+  if (keep_pages) {
+    Memory::set_release_policy(PageRelease::Keep, 0);
+  }
+  double best_frontend = 1e9, best_midend = 1e9;
+  for (int n = 0; n < repeat_count; n++) {
+    Arena storage = {}, scratch = {};
+    SourceText source_text = {};
+    source_text.read_source(&storage, &scratch, filename);
+
+    Frontend frontend = {};
+    double start = bench_now();
+    frontend.do_analysis(&storage, &scratch, &source_text);
+    double frontend_done = bench_now();
+    Midend midend = {};
+    midend.do_analysis(&storage, &scratch, &source_text, &frontend);
+    double midend_done = bench_now();
+    if (frontend_done - start < best_frontend) {
+      best_frontend = frontend_done - start;
+    }
+    if (midend_done - frontend_done < best_midend) {
+      best_midend = midend_done - frontend_done;
+    }
+    storage.free();
+    scratch.free();
+  }
+  printf("%s pages, %-9s  frontend %.2f ms, midend %.2f ms, total %.2f ms\n", huge_pages ? "huge" : "base",
+         keep_pages ? "kept" : "released", best_frontend * 1e3, best_midend * 1e3, (best_frontend + best_midend) * 1e3);
+}
+
+int main(int argc, char* argv[])
+{
+  int repeat_count = 5;
+  int unit_count = 16000;
+  int first_arg = 1;
+  if (argc > 1 && sscanf(argv[1], "-repeat=%d", &repeat_count) == 1) {
+    first_arg = 2;
+  }
+  if (first_arg < argc) {
+    unit_count = atoi(argv[first_arg]);
+  }
+  char* path = bench_generate_program(unit_count, 1);
+  printf("%d units\n", unit_count);
+  fflush(stdout);
+  for (int mode = 0; mode < 3; mode++) {
+    pid_t child = fork();
+    if (child == 0) {
+      run(path, mode >= 1, mode == 2, repeat_count);
+      exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      printf("Run %d failed.\n", mode + 1);
+    }
+  }
+  unlink(path);
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "frontend/lexer.h"
+#include "bench/bench.h"
+
+/**
+ * Lexer throughput: Lexer::tokenize alone, best of `repeat_count` runs per input.
+ * Without files, the inputs are a generated 9.4 MB program and the testdata
+ * files 40 times over (4.9 MB). The token columns and the line table are measured
+ * in bytes per token, both the part in use and the part allocated.
+ *
+ *   bench_lexer [-repeat=N] [file.p4 ...]
+ **/
+static uint64_t column_bytes(TokenStream* tokens, SourceText* source_text, bool allocated)
+{
+  uint64_t size = 0;
+  size += sizeof(uint8_t) * (allocated ? tokens->klasses->capacity : tokens->klasses->element_count);
+  size += sizeof(uint32_t) * (allocated ? tokens->offsets->capacity : tokens->offsets->element_count);
+  size += sizeof(char*) * (allocated ? tokens->lexemes->capacity : tokens->lexemes->element_count);
+  size += sizeof(TokenInteger) * (allocated ? tokens->integers->capacity : tokens->integers->element_count);
+  size += sizeof(SourceLine) * (allocated ? source_text->lines->capacity : source_text->lines->element_count);
+  return size;
+}
+
+static void run(char* filename, const char* name, int repeat_count)
+{
+  Arena storage = {}, scratch = {};
+  SourceText source_text = {};
+  source_text.read_source(&storage, &scratch, filename);
+
+  double best = 1e9;
+  int token_count = 0;
+  uint64_t used_bytes = 0, allocated_bytes = 0;
+  for (int n = 0; n < repeat_count; n++) {
+    Lexer lexer = {};
+    lexer.storage = &storage;
+    lexer.scratch = &scratch;
+    double start = bench_now();
+    lexer.tokenize(&source_text);
+    double elapsed = bench_now() - start;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+    token_count = lexer.tokens->count();
+    used_bytes = column_bytes(lexer.tokens, &source_text, false);
+    allocated_bytes = column_bytes(lexer.tokens, &source_text, true);
+    scratch.free();
+  }
+  printf("%s: %.1f MB, %d tokens, %.2f ms, %.1f MB/s, %.1f Mtok/s, %.1f B/token used, %.1f B/token allocated\n",
+         name, source_text.text_size / 1e6, token_count, best * 1e3, source_text.text_size / best / 1e6,
+         token_count / best / 1e6, (double)used_bytes / token_count, (double)allocated_bytes / token_count);
+  storage.free();
+}
+
+int main(int argc, char* argv[])
+{
+  int repeat_count = 5;
+  int first_file = 1;
+  if (argc > 1 && sscanf(argv[1], "-repeat=%d", &repeat_count) == 1) {
+    first_file = 2;
+  }
+  Memory::reserve(4 * GIGABYTE);
+  if (first_file < argc) {
+    for (int i = first_file; i < argc; i++) {
+      run(argv[i], argv[i], repeat_count);
+    }
+  } else {
+    char* path = bench_generate_program(2000, 8);
+    run(path, "generated", repeat_count);
+    unlink(path);
+    path = bench_concatenate_files(BENCH_TESTDATA_DIR, 40);
+    run(path, "testdata x40", repeat_count);
+    unlink(path);
+  }
+  return 0;
+}
@@ -0,0 +1,57 @@
+#include <stdint.h>
+#include "adt/map.h"
+#include "bench/bench.h"
+
+/**
+ * Map inserts and lookups keyed by AST-like nodes: 48-byte arena allocations,
+ * inserted in address order and looked up in a scattered order.
+ *
+ *   bench_map_lookup [key_count ...]    (default: 1000 4000 16000 64000)
+ **/
+#define LOOKUP_COUNT  (2 * 1000 * 1000)
+#define KEY_SIZE      48
+
+static void run(int key_count)
+{
+  Arena storage = {};
+  void** keys = storage.allocate<void*>(key_count);
+  for (int i = 0; i < key_count; i++) {
+    keys[i] = storage.allocate(KEY_SIZE, 1);
+  }
+  Map* map = Map::allocate(&storage);
+
+  double start = bench_now();
+  for (int i = 0; i < key_count; i++) {
+    map->insert(keys[i], keys[i], 0);
+  }
+  double insert_time = bench_now() - start;
+
+  uint64_t sum = 0;
+  int round_count = (LOOKUP_COUNT + key_count - 1) / key_count;
+  start = bench_now();
+  for (int n = 0; n < round_count; n++) {
+    for (int i = 0; i < key_count; i++) {
+      sum += (uintptr_t)map->lookup(keys[(int)(((int64_t)i * 7919) % key_count)], 0);
+    }
+  }
+  double lookup_time = bench_now() - start;
+  printf("keys %6d  insert %.1f ns/op  lookup %.1f ns/op  (checksum %x)\n", key_count,
+         insert_time / key_count * 1e9, lookup_time / ((double)round_count * key_count) * 1e9, (uint32_t)sum);
+  storage.free();
+}
+
+int main(int argc, char* argv[])
+{
+  Memory::reserve(4 * GIGABYTE);
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      run(atoi(argv[i]));
+    }
+  } else {
+    run(1000);
+    run(4000);
+    run(16000);
+    run(64000);
+  }
+  return 0;
+}
@@ -0,0 +1,64 @@
+#include <stdint.h>
+#include <unistd.h>
+#include "memory/arena.h"
+#include "bench/bench.h"
+
+/**
+ * Cost of an arena growing and freeing its pages while the pool is fragmented.
+ *
+ * `arena_count` arenas get 1 to 4 times PAGE_CACHE_SIZE and a few pages more, then
+ * every other one is freed, so the pool holds many free blocks of several bins,
+ * separated by owned ones. Each operation grows a freed arena by such a size and
+ * frees it again. Sizes below PAGE_CACHE_SIZE would be served by the thread's page
+ * cache, and never reach the bins or the address tree.
+ *
+ *   bench_page_pool [arena_count ...]    (default: 1000 4000 10000)
+ **/
+#define OPERATION_COUNT  20000
+
+static uint64_t block_size(BenchRandom* random, int page_size)
+{
+  return PAGE_CACHE_SIZE * (1 + random->next() % 4) + page_size * (random->next() % 8);
+}
+
+static void run(int arena_count)
+{
+  BenchRandom random = {1};
+  int page_size = getpagesize();
+  Arena* arenas = (Arena*)calloc(arena_count, sizeof(Arena));
+  for (int i = 0; i < arena_count; i++) {
+    arenas[i].allocate(block_size(&random, page_size), 1);
+  }
+  for (int i = 0; i < arena_count; i += 2) {
+    arenas[i].free();
+  }
+
+  double start = bench_now();
+  for (int n = 0; n < OPERATION_COUNT; n++) {
+    Arena* arena = &arenas[(random.next() % (arena_count / 2)) * 2];
+    arena->allocate(block_size(&random, page_size), 1);
+    arena->free();
+  }
+  double elapsed = bench_now() - start;
+  printf("arenas %6d  grow+free %.2f us/op\n", arena_count, elapsed / OPERATION_COUNT * 1e6);
+
+  for (int i = 0; i < arena_count; i++) {
+    arenas[i].free();
+  }
+  free(arenas);
+}
+
+int main(int argc, char* argv[])
+{
+  Memory::reserve(16 * GIGABYTE);
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      run(atoi(argv[i]));
+    }
+  } else {
+    run(1000);
+    run(4000);
+    run(10000);
+  }
+  return 0;
+}
@@ -0,0 +1,57 @@
+#include "frontend/frontend.h"
+#include "bench/bench.h"
+
+/**
+ * Time spent in Frontend::do_analysis (lexing, parsing and the scope setup),
+ * best of `repeat_count` runs per input. The source is read again for every run,
+ * outside of the timed part. Without files, the input is a generated 9.4 MB program.
+ *
+ * bench_parse_time_memset is the same driver built with ZMEM_ON_ALLOC, so that
+ * every allocation is cleared, as it was before the arenas tracked `memory_zero`.
+ *
+ *   bench_parse_time [-repeat=N] [file.p4 ...]
+ *   bench_parse_time_memset [-repeat=N] [file.p4 ...]
+ **/
+static void run(char* filename, const char* name, int repeat_count)
+{
+  double best = 1e9;
+  int text_size = 0;
+  for (int n = 0; n < repeat_count; n++) {
+    Arena storage = {}, scratch = {};
+    SourceText source_text = {};
+    source_text.read_source(&storage, &scratch, filename);
+    text_size = source_text.text_size;
+
+    Frontend frontend = {};
+    double start = bench_now();
+    frontend.do_analysis(&storage, &scratch, &source_text);
+    double elapsed = bench_now() - start;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+    storage.free();
+    scratch.free();
+  }
+  printf("%s: %d bytes, %s, do_analysis %.3f ms\n", name, text_size,
+         ZMEM_ON_ALLOC ? "every allocation cleared" : "known-zero memory", best * 1e3);
+}
+
+int main(int argc, char* argv[])
+{
+  int repeat_count = 5;
+  int first_file = 1;
+  if (argc > 1 && sscanf(argv[1], "-repeat=%d", &repeat_count) == 1) {
+    first_file = 2;
+  }
+  Memory::reserve(4 * GIGABYTE);
+  if (first_file < argc) {
+    for (int i = first_file; i < argc; i++) {
+      run(argv[i], argv[i], repeat_count);
+    }
+  } else {
+    char* path = bench_generate_program(2000, 8);
+    run(path, "generated", repeat_count);
+    unlink(path);
+  }
+  return 0;
+}
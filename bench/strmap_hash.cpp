@@ -0,0 +1,62 @@
+#include <stdint.h>
+#include <string.h>
+#include "adt/atom.h"
+#include "bench/bench.h"
+
+/**
+ * Hashing common P4 identifiers: atom::hash_bytes, next to the byte-at-a-time
+ * polynomial hash that Strmap used before it, for comparison.
+ *
+ *   bench_strmap_hash
+ **/
+#define ROUND_COUNT  (1000 * 1000)
+
+static const char* identifiers[] = {
+  "hdr", "ipv4", "ethernet", "standard_metadata", "egress_spec", "ingress_port",
+  "meta", "srcAddr", "dstAddr", "etherType", "ttl", "protocol", "hdrChecksum",
+  "apply", "action", "table", "key", "actions", "default_action", "size",
+  "packet", "extract", "emit", "isValid", "setValid", "mark_to_drop",
+  "MyIngress", "MyEgress", "ipv4_lpm", "NoAction",
+};
+#define IDENTIFIER_COUNT  (int)(sizeof(identifiers) / sizeof(identifiers[0]))
+
+static uint32_t polynomial_hash(uint8_t* bytes, uint32_t len)
+{
+  const uint32_t P = 257, Q = 4294967029;
+  uint32_t K = 0;
+  for (uint32_t i = 0; i < len; i++) {
+    K = (P * K + bytes[i]) % Q;
+  }
+  return (uint32_t)((uint64_t)K * 2654435769u);
+}
+
+int main(int argc, char* argv[])
+{
+  uint32_t lens[IDENTIFIER_COUNT];
+  for (int i = 0; i < IDENTIFIER_COUNT; i++) {
+    lens[i] = strlen(identifiers[i]);
+  }
+
+  uint32_t sum = 0;
+  double start = bench_now();
+  for (int n = 0; n < ROUND_COUNT; n++) {
+    for (int i = 0; i < IDENTIFIER_COUNT; i++) {
+      sum += polynomial_hash((uint8_t*)identifiers[i], lens[i]);
+    }
+  }
+  double polynomial_time = bench_now() - start;
+
+  start = bench_now();
+  for (int n = 0; n < ROUND_COUNT; n++) {
+    for (int i = 0; i < IDENTIFIER_COUNT; i++) {
+      sum += atom::hash_bytes((uint8_t*)identifiers[i], lens[i]);
+    }
+  }
+  double hash_time = bench_now() - start;
+
+  uint64_t key_count = (uint64_t)ROUND_COUNT * IDENTIFIER_COUNT;
+  printf("polynomial hash  %.1f ns/key\n", polynomial_time / key_count * 1e9);
+  printf("atom::hash_bytes %.1f ns/key\n", hash_time / key_count * 1e9);
+  printf("checksum %08x\n", sum);
+  return 0;
+}
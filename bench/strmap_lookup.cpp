@@ -0,0 +1,202 @@
+#include <stdint.h>
+#include "adt/atom.h"
+#include "adt/strmap.h"
+#include "adt/cstring.h"
+#include "bench/bench.h"
+
+/**
+ * Strmap lookups of P4-style identifiers in tables of a few sizes, the range
+ * of a scope. Half of the keys looked up are not in the table. The chained
+ * table that Strmap used before is timed on the same keys, for comparison.
+ *
+ *   bench_strmap_lookup [entry_count ...]    (default: 12 48 200 1000)
+ **/
+#define LOOKUP_COUNT  (10 * 1000 * 1000)
+
+static const char* prefixes[] = { "hdr", "ipv4", "meta", "ingress", "egress", "smac", "dst_addr", "tbl" };
+#define PREFIX_COUNT  (int)(sizeof(prefixes) / sizeof(prefixes[0]))
+
+/**
+ * The chained Strmap, as it was: buckets of entry lists, in segments of
+ * 16, 32, 64 ... buckets, the keys hashed a byte at a time and compared
+ * as strings. It grows by a segment when there are as many entries as buckets.
+ **/
+#define CHAINED_SEGMENT_COUNT  16
+
+struct ChainedEntry {
+  char* key;
+  void* value;
+  ChainedEntry* next_entry;
+};
+
+struct ChainedStrmap {
+  Arena* storage;
+  int entry_count;
+  int capacity;
+  int segment_count;
+  ChainedEntry** segments[CHAINED_SEGMENT_COUNT];
+
+  static ChainedStrmap* allocate(Arena* storage);
+  uint32_t hash_key(char* key);
+  ChainedEntry** locate(uint32_t h);
+  void grow();
+  void* lookup(char* key, ChainedEntry** entry_/*out*/, ChainedEntry*** entry_slot/*out*/);
+  void insert(char* key, void* value);
+};
+
+ChainedStrmap* ChainedStrmap::allocate(Arena* storage)
+{
+  ChainedStrmap* strmap = storage->allocate<ChainedStrmap>();
+  strmap->storage = storage;
+  strmap->segments[0] = storage->allocate<ChainedEntry*>(16);
+  strmap->segment_count = 1;
+  strmap->capacity = 16;
+  return strmap;
+}
+
+uint32_t ChainedStrmap::hash_key(char* key)
+{
+  const uint32_t P = 257, Q = 4294967029;
+  uint32_t K = 0;
+  for (uint8_t* s = (uint8_t*)key; (*s); s++) {
+    K = (P * K + (*s)) % Q;
+  }
+  int m = 4 + segment_count;
+  uint32_t h = ((uint32_t)((uint64_t)K * 2654435769u)) >> (32 - m);
+  return h % capacity;
+}
+
+ChainedEntry** ChainedStrmap::locate(uint32_t h)
+{
+  int segment_index = 31 - __builtin_clz(h / 16 + 1);
+  return &segments[segment_index][h - 16 * ((1 << segment_index) - 1)];
+}
+
+void ChainedStrmap::grow()
+{
+  if (segment_count >= CHAINED_SEGMENT_COUNT) {
+    printf("\nMaximum capacity has been reached.\n");
+    exit(1);
+  }
+  ChainedEntry* all_entries = 0;
+  for (int i = 0; i < capacity; i++) {
+    ChainedEntry** entry_slot = locate(i);
+    for (ChainedEntry* entry = *entry_slot; entry != 0; ) {
+      ChainedEntry* next_entry = entry->next_entry;
+      entry->next_entry = all_entries;
+      all_entries = entry;
+      entry = next_entry;
+    }
+    *entry_slot = 0;
+  }
+  segments[segment_count] = storage->allocate<ChainedEntry*>(16 << segment_count);
+  segment_count += 1;
+  capacity = 16 * ((1 << segment_count) - 1);
+  for (ChainedEntry* entry = all_entries; entry != 0; ) {
+    ChainedEntry* next_entry = entry->next_entry;
+    ChainedEntry** entry_slot = locate(hash_key(entry->key));
+    entry->next_entry = *entry_slot;
+    *entry_slot = entry;
+    entry = next_entry;
+  }
+}
+
+void* ChainedStrmap::lookup(char* key, ChainedEntry** entry_/*out*/, ChainedEntry*** entry_slot/*out*/)
+{
+  ChainedEntry** slot = locate(hash_key(key));
+  ChainedEntry* entry = *slot;
+  while (entry && !cstring::match(entry->key, key)) {
+    entry = entry->next_entry;
+  }
+  if (entry_) { *entry_ = entry; }
+  if (entry_slot) { *entry_slot = slot; }
+  return entry ? entry->value : 0;
+}
+
+void ChainedStrmap::insert(char* key, void* value)
+{
+  ChainedEntry* entry;
+  ChainedEntry** entry_slot;
+  lookup(key, &entry, &entry_slot);
+  if (entry) {
+    return;
+  }
+  if (entry_count >= capacity) {
+    grow();
+    entry_slot = locate(hash_key(key));
+  }
+  entry = storage->allocate<ChainedEntry>();
+  entry->key = key;
+  entry->value = value;
+  entry->next_entry = *entry_slot;
+  *entry_slot = entry;
+  entry_count += 1;
+}
+
+static char* make_key(int i)
+{
+  char name[64];
+  int len = snprintf(name, sizeof(name), "%s_%d", prefixes[i % PREFIX_COUNT], i);
+  return atom::intern(name, name + len);
+}
+
+static void run(Arena* storage, int entry_count)
+{
+  Strmap* strmap = Strmap::allocate(storage, 16);
+  ChainedStrmap* chained_strmap = ChainedStrmap::allocate(storage);
+  char** keys = storage->allocate<char*>(2 * entry_count);
+  for (int i = 0; i < 2 * entry_count; i++) {
+    keys[i] = make_key(i);
+  }
+  for (int i = 0; i < entry_count; i++) {
+    strmap->insert(keys[2 * i], keys[2 * i], 0);
+    chained_strmap->insert(keys[2 * i], keys[2 * i]);
+  }
+
+  BenchRandom random = {1};
+  int found_count = 0;
+  double start = bench_now();
+  for (int n = 0; n < LOOKUP_COUNT; n++) {
+    char* key = keys[random.next() % (2 * entry_count)];
+    if (strmap->lookup(key, 0, 0)) {
+      found_count += 1;
+    }
+  }
+  double elapsed = bench_now() - start;
+
+  random = {1};
+  int chained_found_count = 0;
+  start = bench_now();
+  for (int n = 0; n < LOOKUP_COUNT; n++) {
+    char* key = keys[random.next() % (2 * entry_count)];
+    if (chained_strmap->lookup(key, 0, 0)) {
+      chained_found_count += 1;
+    }
+  }
+  double chained_elapsed = bench_now() - start;
+
+  printf("entries %5d  Strmap %.1f ns/lookup, chained %.1f ns/lookup (%d found)\n", entry_count,
+         elapsed / LOOKUP_COUNT * 1e9, chained_elapsed / LOOKUP_COUNT * 1e9, found_count);
+  if (chained_found_count != found_count) {
+    printf("The chained table found %d.\n", chained_found_count);
+    exit(1);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Memory::reserve(1 * GIGABYTE);
+  Arena storage = {};
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      run(&storage, atoi(argv[i]));
+    }
+  } else {
+    run(&storage, 12);
+    run(&storage, 48);
+    run(&storage, 200);
+    run(&storage, 1000);
+  }
+  storage.free();
+  return 0;
+}
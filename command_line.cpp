@@ -12,10 +12,21 @@ CommandLineArg* CommandLineArg::parse_cmdline(Arena* storage, int arg_count, cha
   CommandLineArg* prev_arg = &sentinel_arg;
   int i = 1;
   while (i < arg_count) {
-    CommandLineArg* cmdline_arg = (CommandLineArg*)storage->allocate(sizeof(CommandLineArg), 1);
+    CommandLineArg* cmdline_arg = storage->allocate<CommandLineArg>();
     if (cstring::start_with(args[i], "-")) {
       raw_arg = args[i] + 1;  /* skip the `-` prefix */
+      if (*raw_arg == '-') {
+        raw_arg += 1;  /* or `--` */
+      }
       cmdline_arg->name = raw_arg;
+      /* `-name=value` */
+      for (char* c = raw_arg; *c; c++) {
+        if (*c == '=') {
+          *c = '\0';
+          cmdline_arg->value = c + 1;
+          break;
+        }
+      }
     } else {
       cmdline_arg->value = args[i];
     }
@@ -46,6 +46,13 @@ char* AstEnum_to_string(enum AstEnum ast)
     case AstEnum::controlLocalDeclarations: return "controlLocalDeclarations";
     case AstEnum::controlLocalDeclaration: return "controlLocalDeclaration";
 
+      /** EXTERN **/
+
+    case AstEnum::externDeclaration: return "externDeclaration";
+    case AstEnum::externTypeDeclaration: return "externTypeDeclaration";
+    case AstEnum::methodPrototypes: return "methodPrototypes";
+    case AstEnum::functionPrototype: return "functionPrototype";
+
       /** TYPES **/
 
     case AstEnum::typeRef: return "typeRef";
@@ -133,6 +140,7 @@ char* AstEnum_to_string(enum AstEnum ast)
     case AstEnum::arraySubscript: return "arraySubscript";
     case AstEnum::indexExpression: return "indexExpression";
     case AstEnum::integerLiteral: return "integerLiteral";
+    case AstEnum::booleanLiteral: return "booleanLiteral";
     case AstEnum::stringLiteral: return "stringLiteral";
     case AstEnum::dontcare: return "dontcare";
     case AstEnum::default_: return "default";
@@ -143,6 +151,180 @@ char* AstEnum_to_string(enum AstEnum ast)
   return 0;
 }
 
+/**
+ * The size of the kind-specific part of a node, see Ast::allocate.
+ **/
+uint32_t AstEnum_payload_size(enum AstEnum ast)
+{
+  switch (ast) {
+      /** PROGRAM **/
+
+    case AstEnum::p4program: return sizeof(Ast_p4program);
+    case AstEnum::declarationList: return 0;
+    case AstEnum::declaration: return sizeof(Ast_declaration);
+    case AstEnum::name: return sizeof(Ast_name);
+    case AstEnum::parameterList: return 0;
+    case AstEnum::parameter: return sizeof(Ast_parameter);
+    case AstEnum::packageTypeDeclaration: return sizeof(Ast_packageTypeDeclaration);
+    case AstEnum::instantiation: return sizeof(Ast_instantiation);
+
+      /** PARSER **/
+
+    case AstEnum::parserDeclaration: return sizeof(Ast_parserDeclaration);
+    case AstEnum::parserTypeDeclaration: return sizeof(Ast_parserTypeDeclaration);
+    case AstEnum::parserLocalElements: return 0;
+    case AstEnum::parserLocalElement: return sizeof(Ast_parserLocalElement);
+    case AstEnum::parserStates: return 0;
+    case AstEnum::parserState: return sizeof(Ast_parserState);
+    case AstEnum::parserStatements: return 0;
+    case AstEnum::parserStatement: return sizeof(Ast_parserStatement);
+    case AstEnum::parserBlockStatement: return sizeof(Ast_parserBlockStatement);
+    case AstEnum::transitionStatement: return sizeof(Ast_transitionStatement);
+    case AstEnum::stateExpression: return sizeof(Ast_stateExpression);
+    case AstEnum::selectExpression: return sizeof(Ast_selectExpression);
+    case AstEnum::selectCaseList: return 0;
+    case AstEnum::selectCase: return sizeof(Ast_selectCase);
+    case AstEnum::keysetExpression: return sizeof(Ast_keysetExpression);
+    case AstEnum::tupleKeysetExpression: return sizeof(Ast_tupleKeysetExpression);
+    case AstEnum::simpleKeysetExpression: return sizeof(Ast_simpleKeysetExpression);
+    case AstEnum::simpleExpressionList: return 0;
+
+      /** CONTROL **/
+
+    case AstEnum::controlDeclaration: return sizeof(Ast_controlDeclaration);
+    case AstEnum::controlTypeDeclaration: return sizeof(Ast_controlTypeDeclaration);
+    case AstEnum::controlLocalDeclarations: return 0;
+    case AstEnum::controlLocalDeclaration: return sizeof(Ast_controlLocalDeclaration);
+
+      /** EXTERN **/
+
+    case AstEnum::externDeclaration: return sizeof(Ast_externDeclaration);
+    case AstEnum::externTypeDeclaration: return sizeof(Ast_externTypeDeclaration);
+    case AstEnum::methodPrototypes: return 0;
+    case AstEnum::functionPrototype: return sizeof(Ast_functionPrototype);
+
+      /** TYPES **/
+
+    case AstEnum::typeRef: return sizeof(Ast_typeRef);
+    case AstEnum::tupleType: return sizeof(Ast_tupleType);
+    case AstEnum::headerStackType: return sizeof(Ast_headerStackType);
+    case AstEnum::baseTypeBoolean: return sizeof(Ast_baseTypeBoolean);
+    case AstEnum::baseTypeInteger: return sizeof(Ast_baseTypeInteger);
+    case AstEnum::baseTypeBit: return sizeof(Ast_baseTypeBit);
+    case AstEnum::baseTypeVarbit: return sizeof(Ast_baseTypeVarbit);
+    case AstEnum::baseTypeString: return sizeof(Ast_baseTypeString);
+    case AstEnum::baseTypeVoid: return sizeof(Ast_baseTypeVoid);
+    case AstEnum::baseTypeError: return sizeof(Ast_baseTypeError);
+    case AstEnum::integerTypeSize: return sizeof(Ast_integerTypeSize);
+    case AstEnum::realTypeArg: return sizeof(Ast_realTypeArg);
+    case AstEnum::typeArg: return sizeof(Ast_typeArg);
+    case AstEnum::typeArgumentList: return 0;
+    case AstEnum::typeDeclaration: return sizeof(Ast_typeDeclaration);
+    case AstEnum::derivedTypeDeclaration: return sizeof(Ast_derivedTypeDeclaration);
+    case AstEnum::headerTypeDeclaration: return sizeof(Ast_headerTypeDeclaration);
+    case AstEnum::headerUnionDeclaration: return sizeof(Ast_headerUnionDeclaration);
+    case AstEnum::structTypeDeclaration: return sizeof(Ast_structTypeDeclaration);
+    case AstEnum::structFieldList: return 0;
+    case AstEnum::structField: return sizeof(Ast_structField);
+    case AstEnum::enumDeclaration: return sizeof(Ast_enumDeclaration);
+    case AstEnum::errorDeclaration: return sizeof(Ast_errorDeclaration);
+    case AstEnum::matchKindDeclaration: return sizeof(Ast_matchKindDeclaration);
+    case AstEnum::identifierList: return 0;
+    case AstEnum::specifiedIdentifierList: return 0;
+    case AstEnum::specifiedIdentifier: return sizeof(Ast_specifiedIdentifier);
+    case AstEnum::typedefDeclaration: return sizeof(Ast_typedefDeclaration);
+
+      /** STATEMENTS **/
+
+    case AstEnum::assignmentStatement: return sizeof(Ast_assignmentStatement);
+    case AstEnum::emptyStatement: return 0;
+    case AstEnum::returnStatement: return sizeof(Ast_returnStatement);
+    case AstEnum::exitStatement: return 0;
+    case AstEnum::conditionalStatement: return sizeof(Ast_conditionalStatement);
+    case AstEnum::directApplication: return sizeof(Ast_directApplication);
+    case AstEnum::statement: return sizeof(Ast_statement);
+    case AstEnum::blockStatement: return sizeof(Ast_blockStatement);
+    case AstEnum::statementOrDeclaration: return sizeof(Ast_statementOrDeclaration);
+    case AstEnum::statementOrDeclList: return 0;
+    case AstEnum::switchStatement: return sizeof(Ast_switchStatement);
+    case AstEnum::switchCases: return 0;
+    case AstEnum::switchCase: return sizeof(Ast_switchCase);
+    case AstEnum::switchLabel: return sizeof(Ast_switchLabel);
+
+      /** TABLES **/
+
+    case AstEnum::tableDeclaration: return sizeof(Ast_tableDeclaration);
+    case AstEnum::tablePropertyList: return 0;
+    case AstEnum::tableProperty: return sizeof(Ast_tableProperty);
+    case AstEnum::keyProperty: return sizeof(Ast_keyProperty);
+    case AstEnum::keyElementList: return 0;
+    case AstEnum::keyElement: return sizeof(Ast_keyElement);
+    case AstEnum::actionsProperty: return sizeof(Ast_actionsProperty);
+    case AstEnum::actionList: return 0;
+    case AstEnum::actionRef: return sizeof(Ast_actionRef);
+#if 0
+    case AstEnum::entriesProperty: return sizeof(Ast_entriesProperty);
+    case AstEnum::entriesList: return 0;
+    case AstEnum::entry: return sizeof(Ast_entry);
+    case AstEnum::simpleProperty: return sizeof(Ast_simpleProperty);
+#endif
+    case AstEnum::actionDeclaration: return sizeof(Ast_actionDeclaration);
+
+      /** VARIABLES **/
+
+    case AstEnum::variableDeclaration: return sizeof(Ast_variableDeclaration);
+
+      /** EXPRESSIONS **/
+
+    case AstEnum::functionDeclaration: return sizeof(Ast_functionDeclaration);
+    case AstEnum::argumentList: return 0;
+    case AstEnum::argument: return sizeof(Ast_argument);
+    case AstEnum::expressionList: return 0;
+    case AstEnum::expression: return sizeof(Ast_expression);
+    case AstEnum::lvalueExpression: return sizeof(Ast_lvalueExpression);
+    case AstEnum::binaryExpression: return sizeof(Ast_binaryExpression);
+    case AstEnum::unaryExpression: return sizeof(Ast_unaryExpression);
+    case AstEnum::functionCall: return sizeof(Ast_functionCall);
+    case AstEnum::memberSelector: return sizeof(Ast_memberSelector);
+    case AstEnum::castExpression: return sizeof(Ast_castExpression);
+    case AstEnum::arraySubscript: return sizeof(Ast_arraySubscript);
+    case AstEnum::indexExpression: return sizeof(Ast_indexExpression);
+    case AstEnum::integerLiteral: return sizeof(Ast_integerLiteral);
+    case AstEnum::booleanLiteral: return sizeof(Ast_booleanLiteral);
+    case AstEnum::stringLiteral: return sizeof(Ast_stringLiteral);
+    case AstEnum::dontcare: return 0;
+    case AstEnum::default_: return 0;
+
+    default: assert(0);
+  }
+  assert(0);
+  return 0;
+}
+
+uint32_t Ast::node_count = 0;
+
+/**
+ * The size of a node of the given kind: the header, and the payload
+ * of that kind only, rounded up to the alignment of Ast.
+ **/
+uint32_t Ast::size_of(enum AstEnum kind)
+{
+  uint32_t size = AST_HEADER_SIZE + AstEnum_payload_size(kind);
+  return (size + alignof(Ast) - 1) & ~(alignof(Ast) - 1);
+}
+
+Ast* Ast::allocate(Arena* storage, enum AstEnum kind ARENA_SITE_DECL)
+{
+  uint32_t size = size_of(kind);
+  Ast* ast = (Ast*)storage->allocate(size, 1, alignof(Ast) ARENA_SITE_ARGS);
+  ast->kind = kind;
+  ast->id = node_count++;
+#if ARENA_PROFILE
+  Memory::profile_count("ast kind", AstEnum_to_string(kind), size);
+#endif
+  return ast;
+}
+
 Ast* Ast::owner_of(Tree* tree)
 {
   return ::owner_of(tree, &Ast::tree);
@@ -153,10 +335,8 @@ Ast* Ast::clone(Arena* storage)
   Ast* clone, *sibling_clone, *child_clone;
 
   if (this == 0) return (Ast*)0;
-  clone = (Ast*)storage->allocate(sizeof(Ast), 1);
-  clone->kind = kind;
-  clone->line_no = line_no;
-  clone->column_no = column_no;
+  clone = Ast::allocate(storage, kind);
+  clone->offset = offset;
   if (tree.first_child) {
     child_clone = Ast::owner_of(tree.first_child)->clone(storage);
     clone->tree.first_child = &child_clone->tree;
@@ -477,737 +657,1011 @@ Ast* Ast::clone(Arena* storage)
   return clone;
 }
 
-Ast* Ast_p4program::allocate(Arena* storage)
+/**
+ * Stores the addresses of the node's Ast* fields (the tree links aside)
+ * in `fields`, and returns how many there are.
+ **/
+int Ast::child_fields(Ast** fields[AST_MAX_FIELDS])
+{
+  int n = 0;
+
+  /** PROGRAM **/
+  if (kind == AstEnum::p4program) {
+    fields[n++] = &p4program.decl_list;
+  } else if (kind == AstEnum::declarationList) {
+    ;
+  } else if (kind == AstEnum::declaration) {
+    fields[n++] = &declaration.decl;
+  } else if (kind == AstEnum::name) {
+    ;
+  } else if (kind == AstEnum::parameterList) {
+    ;
+  } else if (kind == AstEnum::parameter) {
+    fields[n++] = &parameter.name;
+    fields[n++] = &parameter.type;
+    fields[n++] = &parameter.init_expr;
+  } else if (kind == AstEnum::packageTypeDeclaration) {
+    fields[n++] = &packageTypeDeclaration.name;
+    fields[n++] = &packageTypeDeclaration.params;
+  } else if (kind == AstEnum::instantiation) {
+    fields[n++] = &instantiation.name;
+    fields[n++] = &instantiation.type;
+    fields[n++] = &instantiation.args;
+  }
+    /** PARSER **/
+  else if (kind == AstEnum::parserDeclaration) {
+    fields[n++] = &parserDeclaration.proto;
+    fields[n++] = &parserDeclaration.ctor_params;
+    fields[n++] = &parserDeclaration.local_elements;
+    fields[n++] = &parserDeclaration.states;
+  } else if (kind == AstEnum::parserTypeDeclaration) {
+    fields[n++] = &parserTypeDeclaration.name;
+    fields[n++] = &parserTypeDeclaration.params;
+    fields[n++] = &parserTypeDeclaration.method_protos;
+  } else if (kind == AstEnum::parserLocalElements) {
+    ;
+  } else if (kind == AstEnum::parserLocalElement) {
+    fields[n++] = &parserLocalElement.element;
+  } else if (kind == AstEnum::parserStates) {
+    ;
+  } else if (kind == AstEnum::parserState) {
+    fields[n++] = &parserState.name;
+    fields[n++] = &parserState.stmt_list;
+    fields[n++] = &parserState.transition_stmt;
+  } else if (kind == AstEnum::parserStatements) {
+    ;
+  } else if (kind == AstEnum::parserStatement) {
+    fields[n++] = &parserStatement.stmt;
+  } else if (kind == AstEnum::parserBlockStatement) {
+    fields[n++] = &parserBlockStatement.stmt_list;
+  } else if (kind == AstEnum::transitionStatement) {
+    fields[n++] = &transitionStatement.stmt;
+  } else if (kind == AstEnum::stateExpression) {
+    fields[n++] = &stateExpression.expr;
+  } else if (kind == AstEnum::selectExpression) {
+    fields[n++] = &selectExpression.expr_list;
+    fields[n++] = &selectExpression.case_list;
+  } else if (kind == AstEnum::selectCaseList) {
+    ;
+  } else if (kind == AstEnum::selectCase) {
+    fields[n++] = &selectCase.keyset_expr;
+    fields[n++] = &selectCase.name;
+  } else if (kind == AstEnum::keysetExpression) {
+    fields[n++] = &keysetExpression.expr;
+  } else if (kind == AstEnum::tupleKeysetExpression) {
+    fields[n++] = &tupleKeysetExpression.expr_list;
+  } else if (kind == AstEnum::simpleKeysetExpression) {
+    fields[n++] = &simpleKeysetExpression.expr;
+  } else if (kind == AstEnum::simpleExpressionList) {
+    ;
+  }
+    /** CONTROL **/
+  else if (kind == AstEnum::controlDeclaration) {
+    fields[n++] = &controlDeclaration.proto;
+    fields[n++] = &controlDeclaration.ctor_params;
+    fields[n++] = &controlDeclaration.local_decls;
+    fields[n++] = &controlDeclaration.apply_stmt;
+  } else if (kind == AstEnum::controlTypeDeclaration) {
+    fields[n++] = &controlTypeDeclaration.name;
+    fields[n++] = &controlTypeDeclaration.params;
+    fields[n++] = &controlTypeDeclaration.method_protos;
+  } else if (kind == AstEnum::controlLocalDeclarations) {
+    ;
+  } else if (kind == AstEnum::controlLocalDeclaration) {
+    fields[n++] = &controlLocalDeclaration.decl;
+  }
+    /** EXTERN **/
+  else if (kind == AstEnum::externDeclaration) {
+    fields[n++] = &externDeclaration.decl;
+  } else if (kind == AstEnum::externTypeDeclaration) {
+    fields[n++] = &externTypeDeclaration.name;
+    fields[n++] = &externTypeDeclaration.method_protos;
+  } else if (kind == AstEnum::methodPrototypes) {
+    ;
+  } else if (kind == AstEnum::functionPrototype) {
+    fields[n++] = &functionPrototype.return_type;
+    fields[n++] = &functionPrototype.name;
+    fields[n++] = &functionPrototype.params;
+  }
+    /** TYPES **/
+  else if (kind == AstEnum::typeRef) {
+    fields[n++] = &typeRef.type;
+  } else if (kind == AstEnum::tupleType) {
+    fields[n++] = &tupleType.type_args;
+  } else if (kind == AstEnum::headerStackType) {
+    fields[n++] = &headerStackType.type;
+    fields[n++] = &headerStackType.stack_expr;
+  } else if (kind == AstEnum::baseTypeBoolean) {
+    fields[n++] = &baseTypeBoolean.name;
+  } else if (kind == AstEnum::baseTypeInteger) {
+    fields[n++] = &baseTypeInteger.name;
+    fields[n++] = &baseTypeInteger.size;
+  } else if (kind == AstEnum::baseTypeBit) {
+    fields[n++] = &baseTypeBit.name;
+    fields[n++] = &baseTypeBit.size;
+  } else if (kind == AstEnum::baseTypeVarbit) {
+    fields[n++] = &baseTypeVarbit.name;
+    fields[n++] = &baseTypeVarbit.size;
+  } else if (kind == AstEnum::baseTypeString) {
+    fields[n++] = &baseTypeString.name;
+  } else if (kind == AstEnum::baseTypeVoid) {
+    fields[n++] = &baseTypeVoid.name;
+  } else if (kind == AstEnum::baseTypeError) {
+    fields[n++] = &baseTypeError.name;
+  } else if (kind == AstEnum::integerTypeSize) {
+    fields[n++] = &integerTypeSize.size;
+  } else if (kind == AstEnum::realTypeArg) {
+    fields[n++] = &realTypeArg.arg;
+  } else if (kind == AstEnum::typeArg) {
+    fields[n++] = &typeArg.arg;
+  } else if (kind == AstEnum::typeArgumentList) {
+    ;
+  } else if (kind == AstEnum::typeDeclaration) {
+    fields[n++] = &typeDeclaration.decl;
+  } else if (kind == AstEnum::derivedTypeDeclaration) {
+    fields[n++] = &derivedTypeDeclaration.decl;
+  } else if (kind == AstEnum::headerTypeDeclaration) {
+    fields[n++] = &headerTypeDeclaration.name;
+    fields[n++] = &headerTypeDeclaration.fields;
+  } else if (kind == AstEnum::headerUnionDeclaration) {
+    fields[n++] = &headerUnionDeclaration.name;
+    fields[n++] = &headerUnionDeclaration.fields;
+  } else if (kind == AstEnum::structTypeDeclaration) {
+    fields[n++] = &structTypeDeclaration.name;
+    fields[n++] = &structTypeDeclaration.fields;
+  } else if (kind == AstEnum::structFieldList) {
+    ;
+  } else if (kind == AstEnum::structField) {
+    fields[n++] = &structField.type;
+    fields[n++] = &structField.name;
+  } else if (kind == AstEnum::enumDeclaration) {
+    fields[n++] = &enumDeclaration.type_size;
+    fields[n++] = &enumDeclaration.name;
+    fields[n++] = &enumDeclaration.fields;
+  } else if (kind == AstEnum::errorDeclaration) {
+    fields[n++] = &errorDeclaration.fields;
+  } else if (kind == AstEnum::matchKindDeclaration) {
+    fields[n++] = &matchKindDeclaration.fields;
+  } else if (kind == AstEnum::identifierList) {
+    ;
+  } else if (kind == AstEnum::specifiedIdentifierList) {
+    ;
+  } else if (kind == AstEnum::specifiedIdentifier) {
+    fields[n++] = &specifiedIdentifier.name;
+    fields[n++] = &specifiedIdentifier.init_expr;
+  } else if (kind == AstEnum::typedefDeclaration) {
+    fields[n++] = &typedefDeclaration.type_ref;
+    fields[n++] = &typedefDeclaration.name;
+  }
+    /** STATEMENTS **/
+  else if (kind == AstEnum::assignmentStatement) {
+    fields[n++] = &assignmentStatement.lhs_expr;
+    fields[n++] = &assignmentStatement.rhs_expr;
+  } else if (kind == AstEnum::functionCall) {
+    fields[n++] = &functionCall.lhs_expr;
+    fields[n++] = &functionCall.args;
+  } else if (kind == AstEnum::returnStatement) {
+    fields[n++] = &returnStatement.expr;
+  } else if (kind == AstEnum::exitStatement) {
+    ;
+  } else if (kind == AstEnum::emptyStatement) {
+    ;
+  } else if (kind == AstEnum::conditionalStatement) {
+    fields[n++] = &conditionalStatement.cond_expr;
+    fields[n++] = &conditionalStatement.stmt;
+    fields[n++] = &conditionalStatement.else_stmt;
+  } else if (kind == AstEnum::directApplication) {
+    fields[n++] = &directApplication.name;
+    fields[n++] = &directApplication.args;
+  } else if (kind == AstEnum::statement) {
+    fields[n++] = &statement.stmt;
+  } else if (kind == AstEnum::blockStatement) {
+    fields[n++] = &blockStatement.stmt_list;
+  } else if (kind == AstEnum::statementOrDeclList) {
+    ;
+  } else if (kind == AstEnum::switchStatement) {
+    fields[n++] = &switchStatement.expr;
+    fields[n++] = &switchStatement.switch_cases;
+  } else if (kind == AstEnum::switchCases) {
+    ;
+  } else if (kind == AstEnum::switchCase) {
+    fields[n++] = &switchCase.label;
+    fields[n++] = &switchCase.stmt;
+  } else if (kind == AstEnum::switchLabel) {
+    fields[n++] = &switchLabel.label;
+  } else if (kind == AstEnum::statementOrDeclaration) {
+    fields[n++] = &statementOrDeclaration.stmt;
+  }
+    /** TABLES **/
+  else if (kind == AstEnum::tableDeclaration) {
+    fields[n++] = &tableDeclaration.name;
+    fields[n++] = &tableDeclaration.prop_list;
+    fields[n++] = &tableDeclaration.method_protos;
+  } else if (kind == AstEnum::tablePropertyList) {
+    ;
+  } else if (kind == AstEnum::tableProperty) {
+    fields[n++] = &tableProperty.prop;
+  } else if (kind == AstEnum::keyProperty) {
+    fields[n++] = &keyProperty.keyelem_list;
+  } else if (kind == AstEnum::keyElementList) {
+    ;
+  } else if (kind == AstEnum::keyElement) {
+    fields[n++] = &keyElement.expr;
+    fields[n++] = &keyElement.match;
+  } else if (kind == AstEnum::actionsProperty) {
+    fields[n++] = &actionsProperty.action_list;
+  } else if (kind == AstEnum::actionList) {
+    ;
+  } else if (kind == AstEnum::actionRef) {
+    fields[n++] = &actionRef.name;
+    fields[n++] = &actionRef.args;
+  } else if (kind == AstEnum::actionDeclaration) {
+    fields[n++] = &actionDeclaration.name;
+    fields[n++] = &actionDeclaration.params;
+    fields[n++] = &actionDeclaration.stmt;
+  }
+    /** VARIABLES **/
+  else if (kind == AstEnum::variableDeclaration) {
+    fields[n++] = &variableDeclaration.type;
+    fields[n++] = &variableDeclaration.name;
+    fields[n++] = &variableDeclaration.init_expr;
+  }
+    /** EXPRESSIONS **/
+  else if (kind == AstEnum::functionDeclaration) {
+    fields[n++] = &functionDeclaration.proto;
+    fields[n++] = &functionDeclaration.stmt;
+  } else if (kind == AstEnum::argumentList) {
+    ;
+  } else if (kind == AstEnum::argument) {
+    fields[n++] = &argument.arg;
+  } else if (kind == AstEnum::expressionList) {
+    ;
+  } else if (kind == AstEnum::lvalueExpression) {
+    fields[n++] = &lvalueExpression.expr;
+  } else if (kind == AstEnum::expression) {
+    fields[n++] = &expression.expr;
+  } else if (kind == AstEnum::castExpression) {
+    fields[n++] = &castExpression.type;
+    fields[n++] = &castExpression.expr;
+  } else if (kind == AstEnum::unaryExpression) {
+    fields[n++] = &unaryExpression.operand;
+  } else if (kind == AstEnum::binaryExpression) {
+    fields[n++] = &binaryExpression.left_operand;
+    fields[n++] = &binaryExpression.right_operand;
+  } else if (kind == AstEnum::memberSelector) {
+    fields[n++] = &memberSelector.lhs_expr;
+    fields[n++] = &memberSelector.name;
+  } else if (kind == AstEnum::arraySubscript) {
+    fields[n++] = &arraySubscript.lhs_expr;
+    fields[n++] = &arraySubscript.index_expr;
+  } else if (kind == AstEnum::indexExpression) {
+    fields[n++] = &indexExpression.start_index;
+    fields[n++] = &indexExpression.end_index;
+  } else if (kind == AstEnum::integerLiteral) {
+    ;
+  } else if (kind == AstEnum::booleanLiteral) {
+    ;
+  } else if (kind == AstEnum::stringLiteral) {
+    ;
+  } else if (kind == AstEnum::default_) {
+    ;
+  } else if (kind == AstEnum::dontcare) {
+    ;
+  }
+  else assert(0);
+  assert(n <= AST_MAX_FIELDS);
+  return n;
+}
+
+/**
+ * Copies a tree into one array, in preorder: a node, the subtrees of its
+ * fields, then its children. Nodes reachable more than once are copied once.
+ **/
+struct AstCompactor {
+  Arena* storage;
+  Ast** forward;
+  uint32_t node_count;
+
+  Ast* relocate(Ast* ast);
+  Ast* relocate_list(Ast* ast);
+};
+
+Ast* AstCompactor::relocate(Ast* ast)
+{
+  /* Nothing else is allocated in `storage` meanwhile, so the copies are adjacent. */
+  uint32_t size = Ast::size_of(ast->kind);
+  Ast* copy = (Ast*)storage->allocate_uninit(size, 1, alignof(Ast));
+  memcpy(copy, ast, size);
+  copy->id = node_count++;
+  copy->tree.right_sibling = 0;
+  forward[ast->id] = copy;
+
+  Ast** fields[AST_MAX_FIELDS];
+  int field_count = copy->child_fields(fields);
+  for (int i = 0; i < field_count; i++) {
+    *fields[i] = relocate_list(*fields[i]);
+  }
+  if (ast->tree.first_child) {
+    copy->tree.first_child = &relocate_list(Ast::owner_of(ast->tree.first_child))->tree;
+  }
+  return copy;
+}
+
+/**
+ * Relocates `ast` and the siblings that follow it.
+ **/
+Ast* AstCompactor::relocate_list(Ast* ast)
+{
+  Ast* first = 0, *last = 0;
+
+  while (ast) {
+    Ast* copy = forward[ast->id];
+    bool relocated = (copy != 0);
+    if (!relocated) {
+      copy = relocate(ast);
+    }
+    if (last) {
+      last->tree.right_sibling = &copy->tree;
+    } else {
+      first = copy;
+    }
+    if (relocated) {
+      /* The rest of the list went along with it. */
+      break;
+    }
+    last = copy;
+    ast = ast->tree.right_sibling ? Ast::owner_of(ast->tree.right_sibling) : 0;
+  }
+  return first;
+}
+
+/**
+ * Moves the tree under `root` into one contiguous block of `storage`, so that
+ * the passes walk memory in order. The nodes are renumbered from 0 in preorder,
+ * and the old ones must not be used anymore.
+ *
+ * Experimental, and off unless -compact-ast is given. The nodes are still
+ * linked by pointers, and so far the copy costs the frontend more than the
+ * passes gain from the order.
+ **/
+Ast* Ast::compact(Ast* root, Arena* storage, Arena* scratch)
+{
+  AstCompactor compactor = {};
+  compactor.storage = storage;
+  compactor.forward = scratch->allocate<Ast*>(node_count);
+  compactor.node_count = 0;
+
+  Ast* new_root = compactor.relocate_list(root);
+  node_count = compactor.node_count;
+  return new_root;
+}
+
+Ast* Ast_p4program::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::p4program;
+  Ast* ast = Ast::allocate(storage, AstEnum::p4program ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_declarationList::allocate(Arena* storage)
+Ast* Ast_declarationList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::declarationList;
+  Ast* ast = Ast::allocate(storage, AstEnum::declarationList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_declaration::allocate(Arena* storage)
+Ast* Ast_declaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::declaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::declaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_name::allocate(Arena* storage)
+Ast* Ast_name::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::name;
+  Ast* ast = Ast::allocate(storage, AstEnum::name ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parameterList::allocate(Arena* storage)
+Ast* Ast_parameterList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parameterList;
+  Ast* ast = Ast::allocate(storage, AstEnum::parameterList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parameter::allocate(Arena* storage)
+Ast* Ast_parameter::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parameter;
+  Ast* ast = Ast::allocate(storage, AstEnum::parameter ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_packageTypeDeclaration::allocate(Arena* storage)
+Ast* Ast_packageTypeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::packageTypeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::packageTypeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_instantiation::allocate(Arena* storage)
+Ast* Ast_instantiation::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::instantiation;
+  Ast* ast = Ast::allocate(storage, AstEnum::instantiation ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserDeclaration::allocate(Arena* storage)
+Ast* Ast_parserDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserTypeDeclaration::allocate(Arena* storage)
+Ast* Ast_parserTypeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserTypeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserTypeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserLocalElements::allocate(Arena* storage)
+Ast* Ast_parserLocalElements::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserLocalElements;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserLocalElements ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserLocalElement::allocate(Arena* storage)
+Ast* Ast_parserLocalElement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserLocalElement;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserLocalElement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserStates::allocate(Arena* storage)
+Ast* Ast_parserStates::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserStates;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserStates ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserState::allocate(Arena* storage)
+Ast* Ast_parserState::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserState;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserState ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserStatements::allocate(Arena* storage)
+Ast* Ast_parserStatements::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserStatements;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserStatements ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserStatement::allocate(Arena* storage)
+Ast* Ast_parserStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_parserBlockStatement::allocate(Arena* storage)
+Ast* Ast_parserBlockStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::parserBlockStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::parserBlockStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_transitionStatement::allocate(Arena* storage)
+Ast* Ast_transitionStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::transitionStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::transitionStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_stateExpression::allocate(Arena* storage)
+Ast* Ast_stateExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::stateExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::stateExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_selectExpression::allocate(Arena* storage)
+Ast* Ast_selectExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::selectExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::selectExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_selectCaseList::allocate(Arena* storage)
+Ast* Ast_selectCaseList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::selectCaseList;
+  Ast* ast = Ast::allocate(storage, AstEnum::selectCaseList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_selectCase::allocate(Arena* storage)
+Ast* Ast_selectCase::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::selectCase;
+  Ast* ast = Ast::allocate(storage, AstEnum::selectCase ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_keysetExpression::allocate(Arena* storage)
+Ast* Ast_keysetExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::keysetExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::keysetExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_tupleKeysetExpression::allocate(Arena* storage)
+Ast* Ast_tupleKeysetExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::tupleKeysetExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::tupleKeysetExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_simpleKeysetExpression::allocate(Arena* storage)
+Ast* Ast_simpleKeysetExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::simpleKeysetExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::simpleKeysetExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_simpleExpressionList::allocate(Arena* storage)
+Ast* Ast_simpleExpressionList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::simpleExpressionList;
+  Ast* ast = Ast::allocate(storage, AstEnum::simpleExpressionList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_controlDeclaration::allocate(Arena* storage)
+Ast* Ast_controlDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::controlDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::controlDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_controlTypeDeclaration::allocate(Arena* storage)
+Ast* Ast_controlTypeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::controlTypeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::controlTypeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_controlLocalDeclarations::allocate(Arena* storage)
+Ast* Ast_controlLocalDeclarations::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::controlLocalDeclarations;
+  Ast* ast = Ast::allocate(storage, AstEnum::controlLocalDeclarations ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_controlLocalDeclaration::allocate(Arena* storage)
+Ast* Ast_controlLocalDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::controlLocalDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::controlLocalDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_externDeclaration::allocate(Arena* storage)
+Ast* Ast_externDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::externDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::externDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_externTypeDeclaration::allocate(Arena* storage)
+Ast* Ast_externTypeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::externTypeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::externTypeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_methodPrototypes::allocate(Arena* storage)
+Ast* Ast_methodPrototypes::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::methodPrototypes;
+  Ast* ast = Ast::allocate(storage, AstEnum::methodPrototypes ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_functionPrototype::allocate(Arena* storage)
+Ast* Ast_functionPrototype::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::functionPrototype;
+  Ast* ast = Ast::allocate(storage, AstEnum::functionPrototype ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_typeRef::allocate(Arena* storage)
+Ast* Ast_typeRef::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::typeRef;
+  Ast* ast = Ast::allocate(storage, AstEnum::typeRef ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_tupleType::allocate(Arena* storage)
+Ast* Ast_tupleType::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::tupleType;
+  Ast* ast = Ast::allocate(storage, AstEnum::tupleType ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_headerStackType::allocate(Arena* storage)
+Ast* Ast_headerStackType::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::headerStackType;
+  Ast* ast = Ast::allocate(storage, AstEnum::headerStackType ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_baseTypeBoolean::allocate(Arena* storage)
+Ast* Ast_baseTypeBoolean::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::baseTypeBoolean;
+  Ast* ast = Ast::allocate(storage, AstEnum::baseTypeBoolean ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_baseTypeInteger::allocate(Arena* storage)
+Ast* Ast_baseTypeInteger::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::baseTypeInteger;
+  Ast* ast = Ast::allocate(storage, AstEnum::baseTypeInteger ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_baseTypeBit::allocate(Arena* storage)
+Ast* Ast_baseTypeBit::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::baseTypeBit;
+  Ast* ast = Ast::allocate(storage, AstEnum::baseTypeBit ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_baseTypeVarbit::allocate(Arena* storage)
+Ast* Ast_baseTypeVarbit::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::baseTypeVarbit;
+  Ast* ast = Ast::allocate(storage, AstEnum::baseTypeVarbit ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_baseTypeString::allocate(Arena* storage)
+Ast* Ast_baseTypeString::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::baseTypeString;
+  Ast* ast = Ast::allocate(storage, AstEnum::baseTypeString ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_baseTypeVoid::allocate(Arena* storage)
+Ast* Ast_baseTypeVoid::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::baseTypeVoid;
+  Ast* ast = Ast::allocate(storage, AstEnum::baseTypeVoid ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_baseTypeError::allocate(Arena* storage)
+Ast* Ast_baseTypeError::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::baseTypeError;
+  Ast* ast = Ast::allocate(storage, AstEnum::baseTypeError ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_integerTypeSize::allocate(Arena* storage)
+Ast* Ast_integerTypeSize::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::integerTypeSize;
+  Ast* ast = Ast::allocate(storage, AstEnum::integerTypeSize ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_realTypeArg::allocate(Arena* storage)
+Ast* Ast_realTypeArg::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::realTypeArg;
+  Ast* ast = Ast::allocate(storage, AstEnum::realTypeArg ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_typeArg::allocate(Arena* storage)
+Ast* Ast_typeArg::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::typeArg;
+  Ast* ast = Ast::allocate(storage, AstEnum::typeArg ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_typeArgumentList::allocate(Arena* storage)
+Ast* Ast_typeArgumentList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::typeArgumentList;
+  Ast* ast = Ast::allocate(storage, AstEnum::typeArgumentList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_typeDeclaration::allocate(Arena* storage)
+Ast* Ast_typeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::typeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::typeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_derivedTypeDeclaration::allocate(Arena* storage)
+Ast* Ast_derivedTypeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::derivedTypeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::derivedTypeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_headerTypeDeclaration::allocate(Arena* storage)
+Ast* Ast_headerTypeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::headerTypeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::headerTypeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_headerUnionDeclaration::allocate(Arena* storage)
+Ast* Ast_headerUnionDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::headerUnionDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::headerUnionDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_structTypeDeclaration::allocate(Arena* storage)
+Ast* Ast_structTypeDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::structTypeDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::structTypeDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_structFieldList::allocate(Arena* storage)
+Ast* Ast_structFieldList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::structFieldList;
+  Ast* ast = Ast::allocate(storage, AstEnum::structFieldList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_structField::allocate(Arena* storage)
+Ast* Ast_structField::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::structField;
+  Ast* ast = Ast::allocate(storage, AstEnum::structField ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_enumDeclaration::allocate(Arena* storage)
+Ast* Ast_enumDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::enumDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::enumDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_errorDeclaration::allocate(Arena* storage)
+Ast* Ast_errorDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::errorDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::errorDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_matchKindDeclaration::allocate(Arena* storage)
+Ast* Ast_matchKindDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::matchKindDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::matchKindDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_identifierList::allocate(Arena* storage)
+Ast* Ast_identifierList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::identifierList;
+  Ast* ast = Ast::allocate(storage, AstEnum::identifierList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_specifiedIdentifierList::allocate(Arena* storage)
+Ast* Ast_specifiedIdentifierList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::specifiedIdentifierList;
+  Ast* ast = Ast::allocate(storage, AstEnum::specifiedIdentifierList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_specifiedIdentifier::allocate(Arena* storage)
+Ast* Ast_specifiedIdentifier::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::specifiedIdentifier;
+  Ast* ast = Ast::allocate(storage, AstEnum::specifiedIdentifier ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_typedefDeclaration::allocate(Arena* storage)
+Ast* Ast_typedefDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::typedefDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::typedefDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_assignmentStatement::allocate(Arena* storage)
+Ast* Ast_assignmentStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::assignmentStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::assignmentStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_emptyStatement::allocate(Arena* storage)
+Ast* Ast_emptyStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::emptyStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::emptyStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_functionCall::allocate(Arena* storage)
+Ast* Ast_functionCall::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::functionCall;
+  Ast* ast = Ast::allocate(storage, AstEnum::functionCall ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_returnStatement::allocate(Arena* storage)
+Ast* Ast_returnStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::returnStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::returnStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_exitStatement::allocate(Arena* storage)
+Ast* Ast_exitStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::exitStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::exitStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_conditionalStatement::allocate(Arena* storage)
+Ast* Ast_conditionalStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::conditionalStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::conditionalStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_directApplication::allocate(Arena* storage)
+Ast* Ast_directApplication::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::directApplication;
+  Ast* ast = Ast::allocate(storage, AstEnum::directApplication ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_statement::allocate(Arena* storage)
+Ast* Ast_statement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::statement;
+  Ast* ast = Ast::allocate(storage, AstEnum::statement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_blockStatement::allocate(Arena* storage)
+Ast* Ast_blockStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::blockStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::blockStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_statementOrDeclList::allocate(Arena* storage)
+Ast* Ast_statementOrDeclList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::statementOrDeclList;
+  Ast* ast = Ast::allocate(storage, AstEnum::statementOrDeclList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_switchStatement::allocate(Arena* storage)
+Ast* Ast_switchStatement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::switchStatement;
+  Ast* ast = Ast::allocate(storage, AstEnum::switchStatement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_switchCases::allocate(Arena* storage)
+Ast* Ast_switchCases::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::switchCases;
+  Ast* ast = Ast::allocate(storage, AstEnum::switchCases ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_switchCase::allocate(Arena* storage)
+Ast* Ast_switchCase::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::switchCase;
+  Ast* ast = Ast::allocate(storage, AstEnum::switchCase ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_switchLabel::allocate(Arena* storage)
+Ast* Ast_switchLabel::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::switchLabel;
+  Ast* ast = Ast::allocate(storage, AstEnum::switchLabel ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_statementOrDeclaration::allocate(Arena* storage)
+Ast* Ast_statementOrDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::statementOrDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::statementOrDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_tableDeclaration::allocate(Arena* storage)
+Ast* Ast_tableDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::tableDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::tableDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_tablePropertyList::allocate(Arena* storage)
+Ast* Ast_tablePropertyList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::tablePropertyList;
+  Ast* ast = Ast::allocate(storage, AstEnum::tablePropertyList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_tableProperty::allocate(Arena* storage)
+Ast* Ast_tableProperty::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::tableProperty;
+  Ast* ast = Ast::allocate(storage, AstEnum::tableProperty ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_keyProperty::allocate(Arena* storage)
+Ast* Ast_keyProperty::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::keyProperty;
+  Ast* ast = Ast::allocate(storage, AstEnum::keyProperty ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_keyElementList::allocate(Arena* storage)
+Ast* Ast_keyElementList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::keyElementList;
+  Ast* ast = Ast::allocate(storage, AstEnum::keyElementList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_keyElement::allocate(Arena* storage)
+Ast* Ast_keyElement::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::keyElement;
+  Ast* ast = Ast::allocate(storage, AstEnum::keyElement ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_actionsProperty::allocate(Arena* storage)
+Ast* Ast_actionsProperty::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::actionsProperty;
+  Ast* ast = Ast::allocate(storage, AstEnum::actionsProperty ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_actionList::allocate(Arena* storage)
+Ast* Ast_actionList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::actionList;
+  Ast* ast = Ast::allocate(storage, AstEnum::actionList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_actionRef::allocate(Arena* storage)
+Ast* Ast_actionRef::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::actionRef;
+  Ast* ast = Ast::allocate(storage, AstEnum::actionRef ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_actionDeclaration::allocate(Arena* storage)
+Ast* Ast_actionDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::actionDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::actionDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_variableDeclaration::allocate(Arena* storage)
+Ast* Ast_variableDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::variableDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::variableDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_functionDeclaration::allocate(Arena* storage)
+Ast* Ast_functionDeclaration::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::functionDeclaration;
+  Ast* ast = Ast::allocate(storage, AstEnum::functionDeclaration ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_argumentList::allocate(Arena* storage)
+Ast* Ast_argumentList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::argumentList;
+  Ast* ast = Ast::allocate(storage, AstEnum::argumentList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_argument::allocate(Arena* storage)
+Ast* Ast_argument::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::argument;
+  Ast* ast = Ast::allocate(storage, AstEnum::argument ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_expressionList::allocate(Arena* storage)
+Ast* Ast_expressionList::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::expressionList;
+  Ast* ast = Ast::allocate(storage, AstEnum::expressionList ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_lvalueExpression::allocate(Arena* storage)
+Ast* Ast_lvalueExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::lvalueExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::lvalueExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_expression::allocate(Arena* storage)
+Ast* Ast_expression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::expression;
+  Ast* ast = Ast::allocate(storage, AstEnum::expression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_castExpression::allocate(Arena* storage)
+Ast* Ast_castExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::castExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::castExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_unaryExpression::allocate(Arena* storage)
+Ast* Ast_unaryExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::unaryExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::unaryExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_binaryExpression::allocate(Arena* storage)
+Ast* Ast_binaryExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::binaryExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::binaryExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_memberSelector::allocate(Arena* storage)
+Ast* Ast_memberSelector::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::memberSelector;
+  Ast* ast = Ast::allocate(storage, AstEnum::memberSelector ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_arraySubscript::allocate(Arena* storage)
+Ast* Ast_arraySubscript::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::arraySubscript;
+  Ast* ast = Ast::allocate(storage, AstEnum::arraySubscript ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_indexExpression::allocate(Arena* storage)
+Ast* Ast_indexExpression::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::indexExpression;
+  Ast* ast = Ast::allocate(storage, AstEnum::indexExpression ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_integerLiteral::allocate(Arena* storage)
+Ast* Ast_integerLiteral::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::integerLiteral;
+  Ast* ast = Ast::allocate(storage, AstEnum::integerLiteral ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_booleanLiteral::allocate(Arena* storage)
+Ast* Ast_booleanLiteral::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::booleanLiteral;
+  Ast* ast = Ast::allocate(storage, AstEnum::booleanLiteral ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_stringLiteral::allocate(Arena* storage)
+Ast* Ast_stringLiteral::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::stringLiteral;
+  Ast* ast = Ast::allocate(storage, AstEnum::stringLiteral ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_default::allocate(Arena* storage)
+Ast* Ast_default::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::default_;
+  Ast* ast = Ast::allocate(storage, AstEnum::default_ ARENA_SITE_ARGS);
   return ast;
 }
 
-Ast* Ast_dontcare::allocate(Arena* storage)
+Ast* Ast_dontcare::allocate(Arena* storage ARENA_SITE_DECL)
 {
-  Ast* ast = (Ast*)storage->allocate(sizeof(Ast), 1);
-  ast->kind = AstEnum::dontcare;
+  Ast* ast = Ast::allocate(storage, AstEnum::dontcare ARENA_SITE_ARGS);
   return ast;
 }
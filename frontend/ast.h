@@ -147,6 +147,7 @@ enum class AstEnum {
   dontcare,
 };
 char* AstEnum_to_string(enum AstEnum ast);
+uint32_t AstEnum_payload_size(enum AstEnum ast);
 
 enum class AstOperator : int {
   NONE = 0,
@@ -205,26 +206,26 @@ struct Ast;
 struct Ast_p4program {
   Ast* decl_list;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_declarationList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_declaration {
   Ast* decl;
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_name {
   char* strname;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parameterList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parameter {
@@ -233,14 +234,14 @@ struct Ast_parameter {
   Ast* type;
   Ast* init_expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_packageTypeDeclaration {
   Ast* name;
   Ast* params;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_instantiation {
@@ -248,7 +249,7 @@ struct Ast_instantiation {
   Ast* type;
   Ast* args;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** PARSER **/
@@ -259,7 +260,7 @@ struct Ast_parserDeclaration {
   Ast* local_elements;
   Ast* states;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserTypeDeclaration {
@@ -267,21 +268,21 @@ struct Ast_parserTypeDeclaration {
   Ast* params;
   Ast* method_protos;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserLocalElements {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserLocalElement {
   Ast* element;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserStates {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserState {
@@ -289,76 +290,76 @@ struct Ast_parserState {
   Ast* stmt_list;
   Ast* transition_stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserStatements {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserStatement {
   Ast* stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_parserBlockStatement {
   Ast* stmt_list;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_transitionStatement {
   Ast* stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_stateExpression {
   Ast* expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_selectExpression {
   Ast* expr_list;
   Ast* case_list;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_selectCaseList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_selectCase {
   Ast* keyset_expr;
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_keysetExpression {
   Ast* expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_tupleKeysetExpression {
   Ast* expr_list;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_simpleKeysetExpression {
   Ast* expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_simpleExpressionList {
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** CONTROL **/
@@ -369,7 +370,7 @@ struct Ast_controlDeclaration {
   Ast* local_decls;
   Ast* apply_stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_controlTypeDeclaration {
@@ -377,18 +378,18 @@ struct Ast_controlTypeDeclaration {
   Ast* params;
   Ast* method_protos;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_controlLocalDeclarations {
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_controlLocalDeclaration {
   Ast* decl;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** EXTERN **/
@@ -396,18 +397,18 @@ struct Ast_controlLocalDeclaration {
 struct Ast_externDeclaration {
   Ast* decl;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_externTypeDeclaration {
   Ast* name;
   Ast* method_protos;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_methodPrototypes {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_functionPrototype {
@@ -415,7 +416,7 @@ struct Ast_functionPrototype {
   Ast* name;
   Ast* params;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** TYPES **/
@@ -423,131 +424,131 @@ struct Ast_functionPrototype {
 struct Ast_typeRef {
   Ast* type;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_tupleType {
   Ast* type_args;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_headerStackType {
   Ast* type;
   Ast* stack_expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_baseTypeBoolean {
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_baseTypeInteger {
   Ast* name;
   Ast* size;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_baseTypeBit {
   Ast* name;
   Ast* size;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_baseTypeVarbit {
   Ast* name;
   Ast* size;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_baseTypeString {
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_baseTypeVoid {
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_baseTypeError {
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_integerTypeSize {
   Ast* size;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_realTypeArg {
   Ast* arg;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_typeArg {
   Ast* arg;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_typeArgumentList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_typeDeclaration {
   Ast* decl;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_derivedTypeDeclaration {
   Ast* decl;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_headerTypeDeclaration {
   Ast* name;
   Ast* fields;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_headerUnionDeclaration {
   Ast* name;
   Ast* fields;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_structTypeDeclaration {
   Ast* name;
   Ast* fields;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_structFieldList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_structField {
   Ast* type;
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_enumDeclaration {
@@ -555,41 +556,41 @@ struct Ast_enumDeclaration {
   Ast* name;
   Ast* fields;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_errorDeclaration {
   Ast* fields;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_matchKindDeclaration {
   Ast* fields;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_identifierList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_specifiedIdentifierList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_specifiedIdentifier {
   Ast* name;
   Ast* init_expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_typedefDeclaration {
   Ast* type_ref;
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** STATEMENTS **/
@@ -598,28 +599,28 @@ struct Ast_assignmentStatement {
   Ast* lhs_expr;
   Ast* rhs_expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_emptyStatement {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_functionCall {
   Ast* lhs_expr;
   Ast* args;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_returnStatement {
   Ast* expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_exitStatement {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_conditionalStatement {
@@ -627,60 +628,60 @@ struct Ast_conditionalStatement {
   Ast* stmt;
   Ast* else_stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_directApplication {
   Ast* name;
   Ast* args;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_statement {
   Ast* stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_blockStatement {
   Ast* stmt_list;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_statementOrDeclList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_switchStatement {
   Ast* expr;
   Ast* switch_cases;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_switchCases {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_switchCase {
   Ast* label;
   Ast* stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_switchLabel {
   Ast* label;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_statementOrDeclaration {
   Ast* stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** TABLES **/
@@ -690,51 +691,51 @@ struct Ast_tableDeclaration {
   Ast* prop_list;
   Ast* method_protos;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_tablePropertyList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_tableProperty {
   Ast* prop;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_keyProperty {
   Ast* keyelem_list;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_keyElementList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_keyElement {
   Ast* expr;
   Ast* match;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_actionsProperty {
   Ast* action_list;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_actionList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_actionRef {
   Ast* name;
   Ast* args;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 #if 0
@@ -762,7 +763,7 @@ struct Ast_actionDeclaration {
   Ast* params;
   Ast* stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** VARIABLES **/
@@ -773,7 +774,7 @@ struct Ast_variableDeclaration {
   Ast* init_expr;
   bool is_const;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 /** EXPRESSIONS **/
@@ -782,40 +783,40 @@ struct Ast_functionDeclaration {
   Ast* proto;
   Ast* stmt;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_argumentList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_argument {
   Ast* arg;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_expressionList {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_lvalueExpression {
   Ast* expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_expression {
   Ast* expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_castExpression {
   Ast* type;
   Ast* expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_unaryExpression {
@@ -823,7 +824,7 @@ struct Ast_unaryExpression {
   char* strname;
   Ast* operand;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_binaryExpression {
@@ -832,28 +833,28 @@ struct Ast_binaryExpression {
   Ast* left_operand;
   Ast* right_operand;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_memberSelector {
   Ast* lhs_expr;
   Ast* name;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_arraySubscript {
   Ast* lhs_expr;
   Ast* index_expr;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_indexExpression {
   Ast* start_index;
   Ast* end_index;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_integerLiteral {
@@ -861,33 +862,43 @@ struct Ast_integerLiteral {
   int value;
   int width;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_booleanLiteral {
   bool value;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_stringLiteral {
   char* value;
 
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_default {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
 struct Ast_dontcare {
-  static Ast* allocate(Arena* storage);
+  static Ast* allocate(Arena* storage ARENA_SITE_PARAMS);
 };
 
+/* The most Ast* fields any node kind has. */
+#define AST_MAX_FIELDS  4
+
+/**
+ * Every node gets the next id when it is allocated, so the ids of a
+ * program are dense, and per-node data can be kept in arrays (see AstAttribute).
+ *
+ * A node is allocated with room for the payload of its own kind only
+ * (see Ast::size_of), so the union members of other kinds must not be accessed.
+ **/
 struct Ast {
   enum AstEnum kind;
-  int line_no;
-  int column_no;
+  uint32_t offset;
+  uint32_t id;
   Tree tree;
 
   union {
@@ -1012,6 +1023,71 @@ struct Ast {
     struct Ast_dontcare dontcare;
   };
 
+  static uint32_t node_count;
+
+  static uint32_t size_of(enum AstEnum kind);
+  static Ast* allocate(Arena* storage, enum AstEnum kind ARENA_SITE_PARAMS);
   static Ast* owner_of(Tree* tree);
+  static Ast* compact(Ast* root, Arena* storage, Arena* scratch);
   Ast* clone(Arena* storage);
+  int child_fields(Ast** fields[AST_MAX_FIELDS]);
+};
+
+/* Where the kind-specific payload begins. */
+#define AST_HEADER_SIZE  offsetof(Ast, p4program)
+
+/**
+ * A value of type T for each node, indexed by the node id.
+ * Nodes without a value read as zero; the table grows for nodes
+ * allocated after it was sized.
+ **/
+template<class T>
+struct AstAttribute {
+  Arena* storage;
+  T* values;
+  uint32_t capacity;
+
+  static AstAttribute<T>* allocate(Arena* storage, uint32_t capacity)
+  {
+    AstAttribute<T>* attr = storage->allocate<AstAttribute<T>>();
+    attr->storage = storage;
+    attr->capacity = capacity > 0 ? capacity : 1;
+    attr->values = storage->allocate<T>(attr->capacity);
+    return attr;
+  }
+
+  void grow(uint32_t id)
+  {
+    uint32_t new_capacity = 2 * capacity;
+    while (new_capacity <= id) {
+      new_capacity *= 2;
+    }
+    if (!storage->try_extend(values, capacity * sizeof(T), new_capacity * sizeof(T))) {
+      T* new_values = storage->allocate<T>(new_capacity);
+      memcpy(new_values, values, capacity * sizeof(T));
+      values = new_values;
+    }
+    capacity = new_capacity;
+  }
+
+  T lookup(Ast* ast)
+  {
+    if (ast->id >= capacity) {
+      return 0;
+    }
+    return values[ast->id];
+  }
+
+  /* Does nothing and returns false if the node already has a value. */
+  bool insert(Ast* ast, T value)
+  {
+    if (ast->id >= capacity) {
+      grow(ast->id);
+    }
+    if (values[ast->id]) {
+      return false;
+    }
+    values[ast->id] = value;
+    return true;
+  }
 };
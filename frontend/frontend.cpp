@@ -4,16 +4,29 @@
 
 void Frontend::do_analysis(Arena* storage, Arena* scratch, SourceText* source_text)
 {
+  Memory::begin_phase("Frontend::do_analysis");
+
   Lexer lexer = {};
   lexer.storage = storage;
+  lexer.scratch = scratch;
   lexer.tokenize(source_text);
 
+  /* A tree that is going to be compacted is parsed into an arena of its own,
+     which is let go once the nodes have been copied out. */
+  Arena parse_storage = {};
+  Memory::name_arena(&parse_storage, "parse_storage");
+
   Parser parser = {};
   parser.storage = storage;
-  parser.source_file = source_text->filename;
+  parser.ast_storage = compact_ast ? &parse_storage : storage;
+  parser.source_text = source_text;
   parser.tokens = lexer.tokens;
   p4program = parser.parse();
   root_scope = parser.root_scope;
+  if (compact_ast) {
+    p4program = Ast::compact(p4program, storage, scratch);
+    parse_storage.free();
+  }
 
   scratch->free();
 }
\ No newline at end of file
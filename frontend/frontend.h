@@ -7,6 +7,7 @@
 struct Frontend {
   Ast* p4program;
   Scope* root_scope;
+  bool compact_ast;
 
   void do_analysis(Arena *storage, Arena *scratch, SourceText *source_text);
 };
\ No newline at end of file
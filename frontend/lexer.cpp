@@ -1,6 +1,20 @@
 #include <memory.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Without optimization the vector loops are slower than the scalar ones, so they are left out. */
+#if __SSE2__ && __OPTIMIZE__
+#define LEXER_SSE2  1
+#include <emmintrin.h>
+#else
+#define LEXER_SSE2  0
+#endif
+
 #include "adt/basic.h"
 #include "adt/cstring.h"
+#include "adt/atom.h"
 #include "frontend/lexer.h"
 
 static int digit_to_integer(char c, int base)
@@ -21,16 +35,21 @@ static int digit_to_integer(char c, int base)
   return digit_value;
 }
 
-static int parse_integer(char* str, int base)
+/**
+ * Reads the digits in place, straight from the source text.
+ **/
+static int parse_integer(Lexeme* lexeme, int base)
 {
   int result = 0;
 
+  char* str = lexeme->start;
   char c = *str++;
   assert(cstring::is_digit(c, base) || c == '_');
   if (c != '_') {
     result = digit_to_integer(c, base);
   }
-  for (c = *str++; c != '\0'; c = *str++) {
+  for (; str <= lexeme->end; str++) {
+    c = *str;
     if (cstring::is_digit(c, base)) {
       result = result*base + digit_to_integer(c, base);
     } else if (c == '_') {
@@ -40,26 +59,303 @@ static int parse_integer(char* str, int base)
   return result;
 }
 
+/**
+ * Character classes, and the state that a token starting with a given
+ * character begins in. Both tables are computed at compile time from the
+ * functions below, which are the single description of the first characters.
+ **/
+#define CHAR_BLANK       0x01
+#define CHAR_NEWLINE     0x02
+#define CHAR_LETTER      0x04
+#define CHAR_DIGIT       0x08
+#define CHAR_UNDERSCORE  0x10
+#define CHAR_WORD        (CHAR_LETTER | CHAR_DIGIT | CHAR_UNDERSCORE)
+
+static constexpr uint8_t char_class(int c)
+{
+  return (c == ' ' || c == '\t') ? CHAR_BLANK :
+         (c == '\n' || c == '\r') ? CHAR_NEWLINE :
+         (('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z')) ? CHAR_LETTER :
+         ('0' <= c && c <= '9') ? CHAR_DIGIT :
+         (c == '_') ? CHAR_UNDERSCORE : 0;
+}
+
+static constexpr uint16_t initial_state(int c)
+{
+  return (char_class(c) == CHAR_BLANK) ? 5 :
+         (char_class(c) == CHAR_NEWLINE) ? 6 :
+         (c == ';') ? 100 :
+         (c == '<') ? 101 :
+         (c == '>') ? 102 :
+         (c == '_') ? 103 :
+         (c == ':') ? 104 :
+         (c == '(') ? 105 :
+         (c == ')') ? 106 :
+         (c == '.') ? 107 :
+         (c == '{') ? 108 :
+         (c == '}') ? 109 :
+         (c == '[') ? 110 :
+         (c == ']') ? 111 :
+         (c == ',') ? 112 :
+         (c == '-') ? 113 :
+         (c == '+') ? 114 :
+         (c == '*') ? 115 :
+         (c == '/') ? 116 :
+         (c == '=') ? 117 :
+         (c == '!') ? 118 :
+         (c == '&') ? 119 :
+         (c == '|') ? 120 :
+         (c == '^') ? 121 :
+         (c == '~') ? 122 :
+         (c == '"') ? 200 :
+         (char_class(c) == CHAR_DIGIT) ? 400 :
+         (char_class(c) == CHAR_LETTER) ? 500 :
+         (c == '\0') ? 2 : 3;
+}
+
+#define CHAR_TABLE_4(f, c)   f(c), f(c + 1), f(c + 2), f(c + 3)
+#define CHAR_TABLE_16(f, c)  CHAR_TABLE_4(f, c), CHAR_TABLE_4(f, c + 4), CHAR_TABLE_4(f, c + 8), CHAR_TABLE_4(f, c + 12)
+#define CHAR_TABLE_64(f, c)  CHAR_TABLE_16(f, c), CHAR_TABLE_16(f, c + 16), CHAR_TABLE_16(f, c + 32), CHAR_TABLE_16(f, c + 48)
+#define CHAR_TABLE(f)        CHAR_TABLE_64(f, 0), CHAR_TABLE_64(f, 64), CHAR_TABLE_64(f, 128), CHAR_TABLE_64(f, 192)
+
+static constexpr uint8_t char_classes[256] = { CHAR_TABLE(char_class) };
+static constexpr uint16_t initial_states[256] = { CHAR_TABLE(initial_state) };
+
+/**
+ * Fast paths for the long runs in the source text: blanks, comment bodies,
+ * identifiers and decimal digits. Each one scans from `p` and returns the
+ * first character that is not part of the run. The '\0' terminator ends
+ * every run, and the padding after it keeps the 16-byte loads in bounds.
+ **/
+#if LEXER_SSE2
+static uint32_t match_char(__m128i chars, char c)
+{
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8(c)));
+}
+
+static uint32_t match_range(__m128i chars, char lo, char hi)
+{
+  __m128i offset = _mm_sub_epi8(chars, _mm_set1_epi8(lo));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(hi - lo)), offset));
+}
+#endif
+
+static char* skip_blanks(char* p)
+{
+#if LEXER_SSE2
+  for (;;) {
+    __m128i chars = _mm_loadu_si128((__m128i*)p);
+    uint32_t run = match_char(chars, ' ') | match_char(chars, '\t');
+    if (run != 0xFFFF) {
+      return p + __builtin_ctz(~run);
+    }
+    p += 16;
+  }
+#else
+  while (char_classes[(uint8_t)*p] & CHAR_BLANK) p++;
+  return p;
+#endif
+}
+
+static char* skip_line_comment(char* p)
+{
+#if LEXER_SSE2
+  for (;;) {
+    __m128i chars = _mm_loadu_si128((__m128i*)p);
+    uint32_t stop = match_char(chars, '\n') | match_char(chars, '\r') | match_char(chars, '\0');
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+    p += 16;
+  }
+#else
+  while (*p != '\n' && *p != '\r' && *p != '\0') p++;
+  return p;
+#endif
+}
+
+static char* skip_block_comment(char* p)
+{
+#if LEXER_SSE2
+  for (;;) {
+    __m128i chars = _mm_loadu_si128((__m128i*)p);
+    uint32_t stop = match_char(chars, '*') | match_char(chars, '\n') |
+                    match_char(chars, '\r') | match_char(chars, '\0');
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+    p += 16;
+  }
+#else
+  while (*p != '*' && *p != '\n' && *p != '\r' && *p != '\0') p++;
+  return p;
+#endif
+}
+
+static char* skip_word(char* p)
+{
+#if LEXER_SSE2
+  for (;;) {
+    __m128i chars = _mm_loadu_si128((__m128i*)p);
+    uint32_t run = match_range(_mm_or_si128(chars, _mm_set1_epi8(0x20)), 'a', 'z') |
+                   match_range(chars, '0', '9') | match_char(chars, '_');
+    if (run != 0xFFFF) {
+      return p + __builtin_ctz(~run);
+    }
+    p += 16;
+  }
+#else
+  while (char_classes[(uint8_t)*p] & CHAR_WORD) p++;
+  return p;
+#endif
+}
+
+static char* skip_digits(char* p)
+{
+#if LEXER_SSE2
+  for (;;) {
+    uint32_t run = match_range(_mm_loadu_si128((__m128i*)p), '0', '9');
+    if (run != 0xFFFF) {
+      return p + __builtin_ctz(~run);
+    }
+    p += 16;
+  }
+#else
+  while (char_classes[(uint8_t)*p] & CHAR_DIGIT) p++;
+  return p;
+#endif
+}
+
+/**
+ * Maps a regular file read-only, in place of copying it. The file is mapped
+ * over the front of a zero-filled anonymous region, which is long enough for
+ * the terminator and the padding:
+ *
+ *   [file pages ... | zero pages ...]
+ *   ^ text
+ *
+ * The rest of the file's last page reads as zero as well, so the text is
+ * always followed by '\0' and SOURCE_PADDING zeros.
+ **/
+static char* map_source(int fd, int text_size)
+{
+  int page_size = getpagesize();
+  uint64_t map_size = ((uint64_t)text_size + 1 + SOURCE_PADDING + page_size - 1) & ~(uint64_t)(page_size - 1);
+  char* region = (char*)mmap(0, map_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED) {
+    return 0;
+  }
+  if (mmap(region, text_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    munmap(region, map_size);
+    return 0;
+  }
+  return region;
+}
+
+/**
+ * Pipes (/dev/stdin, <(...)) and anything else that can't be mapped are read in chunks
+ * into the storage arena, growing the text in place while nothing else
+ * is allocated behind it.
+ **/
+static char* read_stream(Arena* storage, int fd, int* text_size)
+{
+  uint64_t capacity = 64 * KILOBYTE;
+  uint64_t size = 0;
+  char* text = storage->allocate_uninit<char>(capacity);
+  for (;;) {
+    if (capacity - size <= 1 + SOURCE_PADDING) {
+      uint64_t new_capacity = 2 * capacity;
+      if (!storage->try_extend(text, capacity, new_capacity)) {
+        char* new_text = storage->allocate_uninit<char>(new_capacity);
+        memcpy(new_text, text, size);
+        text = new_text;
+      }
+      capacity = new_capacity;
+    }
+    ssize_t read_size = read(fd, text + size, capacity - size - (1 + SOURCE_PADDING));
+    if (read_size < 0) {
+      return 0;
+    } else if (read_size == 0) {
+      break;
+    }
+    size += read_size;
+  }
+  memset(text + size, 0, 1 + SOURCE_PADDING);
+  *text_size = size;
+  return text;
+}
+
 void SourceText::read_source(Arena* storage, Arena* scratch, char* filename)
 {
-  FILE* f_stream = fopen(filename, "rb");
-  if (!f_stream) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
     error("Could not open file '%s'.", filename);
   }
-  fseek(f_stream, 0, SEEK_END);
-  int text_size = ftell(f_stream);
-  fseek(f_stream, 0, SEEK_SET);
-  char* text = (char*)storage->allocate(sizeof(char), text_size + 1);
-  fread(text, sizeof(char), text_size, f_stream);
-  text[text_size] = '\0';
-  fclose(f_stream);
+  char* text = 0;
+  int text_size = 0;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+    text_size = file_stat.st_size;
+    text = map_source(fd, text_size);
+  }
+  if (!text) {
+    text = read_stream(storage, fd, &text_size);
+    if (!text) {
+      error("Could not read file '%s'.", filename);
+    }
+  }
+  close(fd);
   this->text = text;
   this->text_size = text_size;
   this->filename = filename;
 }
 
-void Lexeme::copy_to(char* dest)
+/**
+ * The last line that starts at or before `offset`. Several entries may share
+ * an offset (a comment or a string that spans lines); the last one is in effect.
+ **/
+SourceLine* SourceText::line_at(uint32_t offset)
 {
+  int low = 0, high = lines->element_count - 1;
+  while (low < high) {
+    int middle = (low + high + 1) / 2;
+    if (lines->get(middle)->offset <= offset) {
+      low = middle;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return lines->get(low);
+}
+
+int SourceText::line_no_at(uint32_t offset)
+{
+  return line_at(offset)->line_no;
+}
+
+int SourceText::column_no_at(uint32_t offset)
+{
+  return offset - line_at(offset)->line_start + 1;
+}
+
+int Lexeme::len()
+{
+  int result = end - start + 1;
+  return result;
+}
+
+char* Lexeme::to_atom()
+{
+  return atom::intern(start, end + 1);
+}
+
+/**
+ * Copies the lexeme to `dest`, decoding the escape sequences of string
+ * literals, and returns the length of the copy.
+ **/
+int Lexeme::copy_to(char* dest)
+{
+  char* dest_start = dest;
   char* src = start;
   do {
     if (*src == '\\') {
@@ -81,21 +377,20 @@ void Lexeme::copy_to(char* dest)
     }
   }
   while (src <= end);
+  return dest - dest_start;
 }
 
-int Lexeme::len()
+/**
+ * The atom for a string literal that has escape sequences, with them decoded.
+ * The decoded copy is only needed until it's interned. A literal without escapes
+ * is interned straight from the source text (see to_atom).
+ **/
+char* Lexeme::to_string_atom(Arena* scratch)
 {
-  int result = end - start + 1;
-  return result;
-}
-
-char* Lexeme::to_cstring(Arena* storage)
-{
-  int len = this->len();
-  char* string = (char*)storage->allocate(sizeof(char), len + 1);  // +1 the NULL terminator
-  copy_to(string);
-  string[len] = '\0';
-  return string;
+  ArenaScope scratch_scope(scratch);
+  char* string = scratch->allocate_uninit<char>(len());
+  int string_len = copy_to(string);
+  return atom::intern(string, string + string_len);
 }
 
 char Lexer::lookahead_char(int pos)
@@ -120,6 +415,14 @@ char Lexer::retract_char()
   return result;
 }
 
+void Lexer::mark_line()
+{
+  SourceLine* line = source_text->lines->append();
+  line->offset = lexeme->start - text;
+  line->line_no = line_no;
+  line->line_start = line_start - text;
+}
+
 void Lexer::advance_lexeme()
 {
   lexeme->start = ++lexeme->end;
@@ -128,22 +431,26 @@ void Lexer::advance_lexeme()
 
 void Lexer::to_integer_token(Token* token, Lexeme* lexeme, int base)
 {
-  char* string = lexeme->to_cstring(storage);
-  if (cstring::is_digit(*string, base) || *string == '_') {
-    token->integer.value = parse_integer(string, base);
+  char c = *lexeme->start;
+  if (cstring::is_digit(c, base) || c == '_') {
+    token->integer.value = parse_integer(lexeme, base);
   } else {
     if (base == 10) {
-      error("%s:%d:%d: error: expected one or more digits, got '%s'.",
-            filename, token->line_no, token->column_no, string);
+      error("%s:%d:%d: error: expected one or more digits, got '%.*s'.",
+            filename, source_text->line_no_at(token_start - text), source_text->column_no_at(token_start - text),
+            lexeme->len(), lexeme->start);
     } else if (base == 16) {
-      error("%s:%d:%d: error: expected one or more hexadecimal digits, got '%s'.",
-            filename, token->line_no, token->column_no, string);
+      error("%s:%d:%d: error: expected one or more hexadecimal digits, got '%.*s'.",
+            filename, source_text->line_no_at(token_start - text), source_text->column_no_at(token_start - text),
+            lexeme->len(), lexeme->start);
     } else if (base == 8) {
-      error("%s:%d:%d: error: expected one or more octal digits, got '%s'.",
-            filename, token->line_no, token->column_no, string);
+      error("%s:%d:%d: error: expected one or more octal digits, got '%.*s'.",
+            filename, source_text->line_no_at(token_start - text), source_text->column_no_at(token_start - text),
+            lexeme->len(), lexeme->start);
     } else if (base == 2) {
-      error("%s:%d:%d: error: expected one or more binary digits, got '%s'.",
-            filename, token->line_no, token->column_no, string);
+      error("%s:%d:%d: error: expected one or more binary digits, got '%.*s'.",
+            filename, source_text->line_no_at(token_start - text), source_text->column_no_at(token_start - text),
+            lexeme->len(), lexeme->start);
     } else assert(0);
   }
 }
@@ -159,75 +466,8 @@ void Lexer::next_token(Token* token)
 
       case 1:
       {
-        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
-          advance_lexeme();
-          if (c == '\n' || c == '\r') {
-            char cc = lookahead_char(0);
-            if (c + cc == '\n' + '\r') {
-              advance_lexeme();
-            }
-            line_no += 1;
-            line_start = lexeme->start;
-          }
-          state = 1;
-        }
-        else if (c == ';') {
-          state = 100;
-        } else if (c == '<') {
-          state = 101;
-        } else if (c == '>') {
-          state = 102;
-        } else if (c == '_') {
-          state = 103;
-        } else if (c == ':') {
-          state = 104;
-        } else if (c == '(') {
-          state = 105;
-        } else if (c == ')') {
-          state = 106;
-        } else if (c == '.') {
-          state = 107;
-        } else if (c == '{') {
-          state = 108;
-        } else if (c == '}') {
-          state = 109;
-        } else if (c == '[') {
-          state = 110;
-        } else if (c == ']') {
-          state = 111;
-        } else if (c == ',') {
-          state = 112;
-        } else if (c == '-') {
-          state = 113;
-        } else if (c == '+') {
-          state = 114;
-        } else if (c == '*') {
-          state = 115;
-        } else if (c == '/') {
-          state = 116;
-        } else if (c == '=') {
-          state = 117;
-        } else if (c == '!') {
-          state = 118;
-        } else if (c == '&') {
-          state = 119;
-        } else if (c == '|') {
-          state = 120;
-        } else if (c == '^') {
-          state = 121;
-        } else if (c == '~') {
-          state = 122;
-        } else if (c == '"') {
-          state = 200;
-        } else if (cstring::is_digit(c, 10)) {
-          state = 400;
-        } else if (cstring::is_letter(c)) {
-          state = 500;
-        } else if (c == '\0') {
-          state = 2;
-        } else {
-          state = 3;
-        }
+        token_start = lexeme->start;
+        state = initial_states[(uint8_t)c];
       } break;
 
       case 2:
@@ -241,7 +481,6 @@ void Lexer::next_token(Token* token)
       {
         token->klass = TokenClass::Unknown;
         token->lexeme = "<unknown>";
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -250,16 +489,32 @@ void Lexer::next_token(Token* token)
       {
         token->klass = TokenClass::LexicalError;
         token->lexeme = "<error>";
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
 
+      case 5:
+      {
+        lexeme->start = lexeme->end = skip_blanks(lexeme->end + 1);
+        state = 1;
+      } break;
+
+      case 6:
+      {
+        advance_lexeme();
+        char cc = lookahead_char(0);
+        if (c + cc == '\n' + '\r') {
+          advance_lexeme();
+        }
+        line_no += 1;
+        line_start = lexeme->start;
+        mark_line();
+        state = 1;
+      } break;
+
       case 100:
       {
         token->klass = TokenClass::Semicolon;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -275,8 +530,6 @@ void Lexer::next_token(Token* token)
         } else {
           token->klass = TokenClass::AngleOpen;
         }
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -292,8 +545,6 @@ void Lexer::next_token(Token* token)
         } else {
           token->klass = TokenClass::AngleClose;
         }
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -301,12 +552,10 @@ void Lexer::next_token(Token* token)
       case 103:
       {
         char cc = lookahead_char(1);
-        if (cstring::is_letter(cc) || cstring::is_digit(cc, 10) || cc == '_') {
+        if (char_classes[(uint8_t)cc] & CHAR_WORD) {
           state = 500;
         } else {
           token->klass = TokenClass::Dontcare;
-          token->lexeme = lexeme->to_cstring(storage);
-          token->column_no = lexeme->start - line_start + 1;
           advance_lexeme();
           state = 0;
         }
@@ -315,8 +564,6 @@ void Lexer::next_token(Token* token)
       case 104:
       {
         token->klass = TokenClass::Colon;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -324,8 +571,6 @@ void Lexer::next_token(Token* token)
       case 105:
       {
         token->klass = TokenClass::ParenthOpen;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       }
@@ -334,8 +579,6 @@ void Lexer::next_token(Token* token)
       case 106:
       {
         token->klass = TokenClass::ParenthClose;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -343,8 +586,6 @@ void Lexer::next_token(Token* token)
       case 107:
       {
         token->klass = TokenClass::Dot;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -352,8 +593,6 @@ void Lexer::next_token(Token* token)
       case 108:
       {
         token->klass = TokenClass::BraceOpen;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -361,8 +600,6 @@ void Lexer::next_token(Token* token)
       case 109:
       {
         token->klass = TokenClass::BraceClose;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -370,8 +607,6 @@ void Lexer::next_token(Token* token)
       case 110:
       {
         token->klass = TokenClass::BracketOpen;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -379,8 +614,6 @@ void Lexer::next_token(Token* token)
       case 111:
       {
         token->klass = TokenClass::BracketClose;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -388,22 +621,17 @@ void Lexer::next_token(Token* token)
       case 112:
       {
         token->klass = TokenClass::Comma;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
 
       case 113:
       {
-        Token* prev_token = (Token*)tokens->get(tokens->element_count - 1);
-        if (prev_token->klass == TokenClass::ParenthOpen) {
+        if (tokens->klass_at(tokens->count() - 1) == TokenClass::ParenthOpen) {
           token->klass = TokenClass::UnaryMinus;
         } else {
           token->klass = TokenClass::Minus;
         }
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -411,8 +639,6 @@ void Lexer::next_token(Token* token)
       case 114:
       {
         token->klass = TokenClass::Plus;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -420,8 +646,6 @@ void Lexer::next_token(Token* token)
       case 115:
       {
         token->klass = TokenClass::Star;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -435,8 +659,6 @@ void Lexer::next_token(Token* token)
           state = 311;
         } else {
           token->klass = TokenClass::Slash;
-          token->lexeme = lexeme->to_cstring(storage);
-          token->column_no = lexeme->start - line_start + 1;
           advance_lexeme();
           state = 0;
         }
@@ -450,8 +672,6 @@ void Lexer::next_token(Token* token)
         } else {
           token->klass = TokenClass::Equal;
         }
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -464,8 +684,6 @@ void Lexer::next_token(Token* token)
         } else {
           token->klass = TokenClass::Exclamation;
         }
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -483,8 +701,6 @@ void Lexer::next_token(Token* token)
         } else {
           token->klass = TokenClass::Ampersand;
         }
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -497,8 +713,6 @@ void Lexer::next_token(Token* token)
         } else {
           token->klass = TokenClass::Pipe;
         }
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -506,8 +720,6 @@ void Lexer::next_token(Token* token)
       case 121:
       {
         token->klass = TokenClass::Circumflex;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -515,8 +727,6 @@ void Lexer::next_token(Token* token)
       case 122:
       {
         token->klass = TokenClass::Tilda;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
         advance_lexeme();
         state = 0;
       } break;
@@ -532,22 +742,31 @@ void Lexer::next_token(Token* token)
             state = 4;
           }
         } while (c != '"');
+        if (state == 201) {
+          break;
+        }
 
         token->klass = TokenClass::StringLiteral;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        if (string_escaped) {
+          token->lexeme = lexeme->to_string_atom(scratch);
+          string_escaped = false;
+        } else {
+          token->lexeme = lexeme->to_atom();
+        }
         advance_lexeme();
         state = 0;
       } break;
 
       case 201:
       {
+        string_escaped = true;
         c = advance_char(1);
         if (c == '\n' || c == '\r') {
           line_no += 1;
           line_start = lexeme->start;
+          mark_line();
           state = 200;
-        } else if (c == '\\' || c =='"' || c == 'n' || c == 'r') {
+        } else if (c == '\\' || c =='"' || c == 'n' || c == 'r' || c == 't') {
           state = 200; // ok
         } else {
           state = 4;
@@ -557,22 +776,24 @@ void Lexer::next_token(Token* token)
       case 310:
       {
         do {
-          c = advance_char(1);
+          c = advance_char(skip_block_comment(lexeme->end + 1) - lexeme->end);
           if (c == '\n' || c == '\r') {
             char cc = lookahead_char(1);
             if (c + cc == '\n' + '\r') {
               c = advance_char(1);
             }
             line_no += 1;
+            mark_line();
           }
         } while (c != '*');
 
         if (lookahead_char(1) == '/') {
           advance_char(1);
           token->klass = TokenClass::Comment;
-          token->lexeme = lexeme->to_cstring(storage);
+          token->lexeme = "<comment>";
           advance_lexeme();
           line_start = lexeme->start;
+          mark_line();
           state = 0;
         } else {
           state = 310;
@@ -582,14 +803,15 @@ void Lexer::next_token(Token* token)
       case 311:
       {
         do {
-          c = advance_char(1);
+          c = advance_char(skip_line_comment(lexeme->end + 1) - lexeme->end);
         } while (c != '\n' && c != '\r');
 
         line_no += 1;
         token->klass = TokenClass::Comment;
-        token->lexeme = lexeme->to_cstring(storage);
+        token->lexeme = "<comment>";
         advance_lexeme();
         line_start = lexeme->start;
+        mark_line();
         state = 0;
       } break;
 
@@ -619,16 +841,14 @@ void Lexer::next_token(Token* token)
         // 99
         // ^^
         lexeme[1].start = lexeme[1].end = lexeme->end;
-        do {
-          c = advance_char(1);
-        } while (cstring::is_digit(c, 10));
+        c = advance_char(skip_digits(lexeme->end + 1) - lexeme->end);
         if (c == 'w' || c == 's') {
           token->klass = TokenClass::IntegerLiteral;
           if (c == 's') {
             token->integer.is_signed = 1;
           }
           lexeme[1].end = lexeme->end - 1;  // omit w|s
-          token->integer.width = parse_integer(lexeme[1].to_cstring(storage), 10);
+          token->integer.width = parse_integer(&lexeme[1], 10);
           advance_char(1);
           state = 405;
         } else {
@@ -637,8 +857,7 @@ void Lexer::next_token(Token* token)
           token->klass = TokenClass::IntegerLiteral;
           token->integer.is_signed = 1;
           to_integer_token(token, &lexeme[1], 10);
-          token->lexeme = lexeme->to_cstring(storage);
-          token->column_no = lexeme->start - line_start + 1;
+          token->lexeme = lexeme->to_atom();
           advance_lexeme();
           state = 0;
         }
@@ -657,8 +876,7 @@ void Lexer::next_token(Token* token)
         token->klass = TokenClass::IntegerLiteral;
         token->integer.is_signed = 1;
         to_integer_token(token, &lexeme[1], 16);
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
@@ -676,8 +894,7 @@ void Lexer::next_token(Token* token)
         token->klass = TokenClass::IntegerLiteral;
         token->integer.is_signed = 1;
         to_integer_token(token, &lexeme[1], 8);
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
@@ -695,8 +912,7 @@ void Lexer::next_token(Token* token)
         token->klass = TokenClass::IntegerLiteral;
         token->integer.is_signed = 1;
         to_integer_token(token, &lexeme[1], 2);
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
@@ -733,8 +949,7 @@ void Lexer::next_token(Token* token)
         retract_char();
         lexeme[1].end = lexeme->end;
         to_integer_token(token, &lexeme[1], 16);
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
@@ -750,8 +965,7 @@ void Lexer::next_token(Token* token)
         retract_char();
         lexeme[1].end = lexeme->end;
         to_integer_token(token, &lexeme[1], 8);
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
@@ -767,8 +981,7 @@ void Lexer::next_token(Token* token)
         retract_char();
         lexeme[1].end = lexeme->end;
         to_integer_token(token, &lexeme[1], 2);
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
@@ -778,39 +991,33 @@ void Lexer::next_token(Token* token)
         // ..(w|s)99
         //        ^^
         lexeme[1].start = lexeme[1].end = lexeme->end;
-        do {
-          c = advance_char(1);
-        } while (cstring::is_digit(c, 10));
+        c = advance_char(skip_digits(lexeme->end + 1) - lexeme->end);
         retract_char();
         lexeme[1].end = lexeme->end;
         to_integer_token(token, &lexeme[1], 10);
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
 
       case 500:
       {
-        do {
-          c = advance_char(1);
-        } while (cstring::is_letter(c) || cstring::is_digit(c, 10) || c == '_');
+        advance_char(skip_word(lexeme->end + 1) - lexeme->end);
         retract_char();
         token->klass = TokenClass::Identifier;
-        token->lexeme = lexeme->to_cstring(storage);
-        token->column_no = lexeme->start - line_start + 1;
+        token->lexeme = lexeme->to_atom();
         advance_lexeme();
         state = 0;
       } break;
     }
   }
-  token->line_no = line_no;
 }
 
 void Lexer::tokenize(SourceText* source_text)
 {
   Token token = {};
 
+  this->source_text = source_text;
   filename = source_text->filename;
   text = source_text->text;
   text_size = source_text->text_size;
@@ -819,18 +1026,25 @@ void Lexer::tokenize(SourceText* source_text)
   line_no = 1;
 
   token.klass = TokenClass::StartOfInput;
-  tokens = Array::allocate(storage, sizeof(Token), 7);
-  *(Token*)tokens->append() = token;
+  /* The tokens are only needed until the parser is done, and they're the only thing
+   * allocated in the scratch arena meanwhile. The line table stays with the source text,
+   * for the diagnostics of the later passes. */
+  tokens = TokenStream::allocate(scratch, text_size);
+  source_text->lines = FlatArray<SourceLine>::allocate(storage, text_size / 16 + 16);
+  tokens->append(&token, 0);
+  mark_line();
 
   next_token(&token);
-  *(Token*)tokens->append() = token;
+  tokens->append(&token, token_start - text);
   while (token.klass != TokenClass::EndOfInput) {
     if (token.klass == TokenClass::Unknown) {
-      error("%s:%d:%d: error: unknown token.", filename, token.line_no, token.column_no);
+      error("%s:%d:%d: error: unknown token.", filename,
+            source_text->line_no_at(token_start - text), source_text->column_no_at(token_start - text));
     } else if (token.klass == TokenClass::LexicalError) {
-      error("%s:%d:%d: error: lexical error.", filename, token.line_no, token.column_no);
+      error("%s:%d:%d: error: lexical error.", filename,
+            source_text->line_no_at(token_start - text), source_text->column_no_at(token_start - text));
     }
     next_token(&token);
-    *(Token*)tokens->append() = token;
+    tokens->append(&token, token_start - text);
   }
 }
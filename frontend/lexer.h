@@ -4,39 +4,71 @@
 #include "adt/array.h"
 #include "frontend/token.h"
 
+/**
+ * The source text is followed by the '\0' terminator and SOURCE_PADDING more
+ * zero bytes, so that the lexer can load 16 bytes at a time from any position
+ * up to and including the terminator.
+ **/
+#define SOURCE_PADDING  16
+
+/**
+ * The line number and the start of the line that are in effect
+ * for the tokens starting at `offset` and after.
+ **/
+struct SourceLine {
+  uint32_t offset;
+  int line_no;
+  uint32_t line_start;
+};
+
+/**
+ * Tokens and AST nodes keep only their offset in the text. The line and
+ * column are looked up in `lines`, which the lexer fills in, when they are
+ * printed.
+ **/
 struct SourceText {
   char* text;
   int text_size;
   char* filename;
+  FlatArray<SourceLine>* lines;
 
   void read_source(Arena* storage, Arena* scratch, char* filename);
+  SourceLine* line_at(uint32_t offset);
+  int line_no_at(uint32_t offset);
+  int column_no_at(uint32_t offset);
 };
 
 struct Lexeme {
   char* start;
   char* end;
 
-  void copy_to(char* dest);
   int len();
-  char* to_cstring(Arena* storage);
+  char* to_atom();
+  int copy_to(char* dest);
+  char* to_string_atom(Arena* scratch);
 };
 
 struct Lexer {
   Arena* storage;
+  Arena* scratch;
+  SourceText* source_text;
   char* text;
   int text_size;
   char* filename;
   int line_no;
   char* line_start;
+  char* token_start;
+  bool string_escaped;
   int state;
   Token token;
   Lexeme lexeme[2];
-  Array* tokens;
+  TokenStream* tokens;
 
   char lookahead_char(int pos);
   char advance_char(int pos);
   char retract_char();
   void advance_lexeme();
+  void mark_line();
   void to_integer_token(Token* token, Lexeme* lexeme, int base);
   void next_token(Token* token);
   void tokenize(SourceText* source_text);
@@ -16,7 +16,7 @@ char* NameSpace_to_string(enum NameSpace ns)
 
 NameDeclaration* NameDeclaration::allocate(Arena* storage)
 {
-  NameDeclaration* name_decl = (NameDeclaration*)storage->allocate(sizeof(NameDeclaration), 1);
+  NameDeclaration* name_decl = storage->allocate<NameDeclaration>();
   return name_decl;
 }
 
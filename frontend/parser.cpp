@@ -1,4 +1,5 @@
 #include "adt/basic.h"
+#include "adt/atom.h"
 #include "frontend/parser.h"
 
 struct Keyword {
@@ -51,21 +52,25 @@ void Parser::define_keywords(Scope* scope)
   };
 
   for (int i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
-    NameDeclaration* name_decl = scope->bind_name(storage, keywords[i].strname, NameSpace::Keyword);
+    NameDeclaration* name_decl = scope->bind_name(storage, atom::intern(keywords[i].strname), NameSpace::Keyword);
     name_decl->token_class = keywords[i].token_class;
   }
 }
 
+/**
+ * The current token is decoded into one of two slots, so that the other
+ * one still holds the token before it.
+ **/
 Token* Parser::next_token()
 {
-  assert(token_at < tokens->element_count);
+  assert(token_at.token_at < tokens->count());
 
-  prev_token = token;
-  prev_token_at = token_at;
-  token = (Token*)tokens->get(++token_at);
-  while (token->klass == TokenClass::Comment) {
-    token = (Token*)tokens->get(++token_at);
+  tokens->advance(&token_at);
+  while (tokens->klass_at(token_at.token_at) == TokenClass::Comment) {
+    tokens->advance(&token_at);
   }
+  token = (token == &token_slots[0]) ? &token_slots[1] : &token_slots[0];
+  tokens->read(&token_at, token);
   if (token->klass == TokenClass::Identifier) {
     NameEntry* name_entry = current_scope->lookup(token->lexeme, NameSpace::Keyword | NameSpace::Type);
     NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Keyword);
@@ -84,11 +89,11 @@ Token* Parser::next_token()
 
 Token* Parser::peek_token()
 {
-  prev_token = token;
-  prev_token_at = token_at;
+  Token* current_token = token;
+  TokenCursor current_at = token_at;
   Token* peek_token = next_token();
-  token = prev_token;
-  token_at = prev_token_at;
+  token = current_token;
+  token_at = current_at;
   return peek_token;
 }
 
@@ -167,12 +172,13 @@ enum AstOperator token_to_binop(Token* token)
 
 Ast* Parser::parse()
 {
-  root_scope = Scope::allocate(storage, 5);
+  root_scope = Scope::allocate(storage);
   current_scope = root_scope;
 
   define_keywords(root_scope);
-  token_at = 0;
-  token = (Token*)tokens->get(token_at);
+  token_at = {};
+  token = &token_slots[0];
+  tokens->read(&token_at, token);
   next_token();
   p4program = parse_p4program();
   assert(current_scope == root_scope);
@@ -183,28 +189,27 @@ Ast* Parser::parse()
 
 Ast* Parser::parse_p4program()
 {
-  Ast* p4program = Ast_p4program::allocate(storage);
-  p4program->line_no = token->line_no;
-  p4program->column_no = token->column_no;
+  Ast* p4program = Ast_p4program::allocate(ast_storage);
+  p4program->offset = token->offset;
   while (token->klass == TokenClass::Semicolon) {
     next_token(); /* empty declaration */
   }
-  Scope* scope = Scope::allocate(storage, 6);
+  Scope* scope = Scope::allocate(storage);
   current_scope = scope->push(current_scope);
   p4program->p4program.decl_list = parse_declarationList();
   current_scope = current_scope->pop();
   if (token->klass != TokenClass::EndOfInput) {
     error("%s:%d:%d: error: unexpected token `%s`.",
-          source_file, token->line_no, token->column_no, token->lexeme);
+          source_text->filename, source_text->line_no_at(token->offset),
+          source_text->column_no_at(token->offset), token->lexeme);
   }
   return p4program;
 }
 
 Ast* Parser::parse_declarationList()
 {
-  Ast* decls = Ast_declarationList::allocate(storage);
-  decls->line_no = token->line_no;
-  decls->column_no = token->column_no;
+  Ast* decls = Ast_declarationList::allocate(ast_storage);
+  decls->offset = token->offset;
   if (token->is_declaration()) {
     Ast* ast = parse_declaration();
     TreeConstructor tree_ctor = {};
@@ -224,9 +229,8 @@ Ast* Parser::parse_declarationList()
 Ast* Parser::parse_declaration()
 {
   if (token->is_declaration()) {
-    Ast* decl = Ast_declaration::allocate(storage);
-    decl->line_no = token->line_no;
-    decl->column_no = token->column_no;
+    Ast* decl = Ast_declaration::allocate(ast_storage);
+    decl->offset = token->offset;
     if (token->klass == TokenClass::Const) {
       decl->declaration.decl = parse_variableDeclaration(0);
       return decl;
@@ -270,14 +274,16 @@ Ast* Parser::parse_declaration()
         decl->declaration.decl = parse_functionDeclaration(type_ref);
         return decl;
       } else error("%s:%d:%d: error: unexpected token `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       assert(0);
     } else if (token->is_typeOrVoid()) {
       decl->declaration.decl = parse_functionDeclaration(parse_typeRef());
       return decl;
     } else assert(0);
   } else error("%s:%d:%d: error: top-level declaration was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -285,14 +291,14 @@ Ast* Parser::parse_declaration()
 Ast* Parser::parse_nonTypeName()
 {
   if (token->is_nonTypeName()) {
-    Ast* name = Ast_name::allocate(storage);
-    name->line_no = token->line_no;
-    name->column_no = token->column_no;
+    Ast* name = Ast_name::allocate(ast_storage);
+    name->offset = token->offset;
     name->name.strname = token->lexeme;
     next_token();
     return name;
   } else error("%s:%d:%d: error: non-type name was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -303,24 +309,23 @@ Ast* Parser::parse_name()
     if (token->is_nonTypeName()) {
       return parse_nonTypeName();
     } else if (token->klass == TokenClass::TypeIdentifier) {
-      Ast* type_name = Ast_name::allocate(storage);
-      type_name->line_no = token->line_no;
-      type_name->column_no = token->column_no;
+      Ast* type_name = Ast_name::allocate(ast_storage);
+      type_name->offset = token->offset;
       type_name->name.strname = token->lexeme;
       next_token();
       return type_name;
     } else assert(0);
   } else error("%s:%d:%d: error: name was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_parameterList()
 {
-  Ast* params = Ast_parameterList::allocate(storage);
-  params->line_no = token->line_no;
-  params->column_no = token->column_no;
+  Ast* params = Ast_parameterList::allocate(ast_storage);
+  params->offset = token->offset;
   if (token->is_parameter()) {
     Ast* ast = parse_parameter();
     TreeConstructor tree_ctor = {};
@@ -337,9 +342,8 @@ Ast* Parser::parse_parameterList()
 Ast* Parser::parse_parameter()
 {
   if (token->is_parameter()) {
-    Ast* param = Ast_parameter::allocate(storage);
-    param->line_no = token->line_no;
-    param->column_no = token->column_no;
+    Ast* param = Ast_parameter::allocate(ast_storage);
+    param->offset = token->offset;
     param->parameter.direction = parse_direction();
     param->parameter.type = parse_typeRef();
     if (token->is_name()) {
@@ -349,13 +353,16 @@ Ast* Parser::parse_parameter()
         if (token->is_expression()) {
           param->parameter.init_expr = parse_expression(1);
         } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       }
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return param;
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -381,9 +388,8 @@ Ast* Parser::parse_packageTypeDeclaration()
 {
   if (token->klass == TokenClass::Package) {
     next_token();
-    Ast* package_decl = Ast_packageTypeDeclaration::allocate(storage);
-    package_decl->line_no = token->line_no;
-    package_decl->column_no = token->column_no;
+    Ast* package_decl = Ast_packageTypeDeclaration::allocate(ast_storage);
+    package_decl->offset = token->offset;
     if (token->is_name()) {
       Ast* name = parse_name();
       current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
@@ -394,14 +400,18 @@ Ast* Parser::parse_packageTypeDeclaration()
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return package_decl;
   } else error("%s:%d:%d: error: `package` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -409,9 +419,8 @@ Ast* Parser::parse_packageTypeDeclaration()
 Ast* Parser::parse_instantiation(Ast* type_ref)
 {
   if (token->is_typeRef() || type_ref) {
-    Ast* inst_stmt = Ast_instantiation::allocate(storage);
-    inst_stmt->line_no = token->line_no;
-    inst_stmt->column_no = token->column_no;
+    Ast* inst_stmt = Ast_instantiation::allocate(ast_storage);
+    inst_stmt->offset = token->offset;
     inst_stmt->instantiation.type = type_ref ? type_ref : parse_typeRef();
     if (token->klass == TokenClass::ParenthOpen) {
       next_token();
@@ -423,16 +432,21 @@ Ast* Parser::parse_instantiation(Ast* type_ref)
           if (token->klass == TokenClass::Semicolon) {
             next_token();
           } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: instance name was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return inst_stmt;
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -447,19 +461,20 @@ Ast* Parser::parse_constructorParameters()
     if (token->klass == TokenClass::ParenthClose) {
       next_token();
     } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return params;
   } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   return 0;
 }
 
 Ast* Parser::parse_parserDeclaration(Ast* parser_proto)
 {
   if (token->klass == TokenClass::ParenthOpen || token->klass == TokenClass::BraceOpen) {
-    Ast* parser_decl = Ast_parserDeclaration::allocate(storage);
-    parser_decl->line_no = token->line_no;
-    parser_decl->column_no = token->column_no;
+    Ast* parser_decl = Ast_parserDeclaration::allocate(ast_storage);
+    parser_decl->offset = token->offset;
     parser_decl->parserDeclaration.proto = parser_proto;
     parser_decl->parserDeclaration.ctor_params = parse_constructorParameters();
     if (token->klass == TokenClass::BraceOpen) {
@@ -468,25 +483,28 @@ Ast* Parser::parse_parserDeclaration(Ast* parser_proto)
       if (token->klass == TokenClass::State) {
         parser_decl->parserDeclaration.states = parse_parserStates();
       } else error("%s:%d:%d: error: `state` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       if (token->klass == TokenClass::BraceClose) {
         next_token();
       } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return parser_decl;
   } else error("%s:%d:%d: error: `parser` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_parserLocalElements()
 {
-  Ast* elems = Ast_parserLocalElements::allocate(storage);
-  elems->line_no = token->line_no;
-  elems->column_no = token->column_no;
+  Ast* elems = Ast_parserLocalElements::allocate(ast_storage);
+  elems->offset = token->offset;
   if (token->is_parserLocalElement()) {
     Ast* ast = parse_parserLocalElement();
     TreeConstructor tree_ctor = {};
@@ -502,9 +520,8 @@ Ast* Parser::parse_parserLocalElements()
 Ast* Parser::parse_parserLocalElement()
 {
   if (token->is_parserLocalElement()) {
-    Ast* local_element = Ast_parserLocalElement::allocate(storage);
-    local_element->line_no = token->line_no;
-    local_element->column_no = token->column_no;
+    Ast* local_element = Ast_parserLocalElement::allocate(ast_storage);
+    local_element->offset = token->offset;
     if (token->klass == TokenClass::Const) {
       local_element->parserLocalElement.element = parse_variableDeclaration(0);
       return local_element;
@@ -517,10 +534,12 @@ Ast* Parser::parse_parserLocalElement()
         local_element->parserLocalElement.element = parse_variableDeclaration(type_ref);
         return local_element;
       } else error("%s:%d:%d: error: unexpected token `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else assert(0);
   } else error("%s:%d:%d: error: local declaration was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -529,12 +548,10 @@ Ast* Parser::parse_parserTypeDeclaration()
 {
   if (token->klass == TokenClass::Parser) {
     next_token();
-    Ast* parser_proto = Ast_parserTypeDeclaration::allocate(storage);
-    parser_proto->line_no = token->line_no;
-    parser_proto->column_no = token->column_no;
-    Ast* method_protos = Ast_methodPrototypes::allocate(storage);
-    method_protos->line_no = parser_proto->line_no;
-    method_protos->column_no = parser_proto->column_no;
+    Ast* parser_proto = Ast_parserTypeDeclaration::allocate(ast_storage);
+    parser_proto->offset = token->offset;
+    Ast* method_protos = Ast_methodPrototypes::allocate(ast_storage);
+    method_protos->offset = parser_proto->offset;
     parser_proto->parserTypeDeclaration.method_protos = method_protos;
     if (token->is_name()) {
       Ast* name = parse_name();
@@ -546,23 +563,26 @@ Ast* Parser::parse_parserTypeDeclaration()
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return parser_proto;
   } else error("%s:%d:%d: error: `parser` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_parserStates()
 {
-  Ast* states = Ast_parserStates::allocate(storage);
-  states->line_no = token->line_no;
-  states->column_no = token->column_no;
+  Ast* states = Ast_parserStates::allocate(ast_storage);
+  states->offset = token->offset;
   if (token->klass == TokenClass::State) {
     Ast* ast = parse_parserState();
     TreeConstructor tree_ctor = {};
@@ -579,9 +599,8 @@ Ast* Parser::parse_parserState()
 {
   if (token->klass == TokenClass::State) {
     next_token();
-    Ast* state = Ast_parserState::allocate(storage);
-    state->line_no = token->line_no;
-    state->column_no = token->column_no;
+    Ast* state = Ast_parserState::allocate(ast_storage);
+    state->offset = token->offset;
     state->parserState.name = parse_name();
     if (token->klass == TokenClass::BraceOpen) {
       next_token();
@@ -590,21 +609,23 @@ Ast* Parser::parse_parserState()
       if (token->klass == TokenClass::BraceClose) {
         next_token();
       } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return state;
   } else error("%s:%d:%d: error: `state` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_parserStatements()
 {
-  Ast* stmts = Ast_parserStatements::allocate(storage);
-  stmts->line_no = token->line_no;
-  stmts->column_no = token->column_no;
+  Ast* stmts = Ast_parserStatements::allocate(ast_storage);
+  stmts->offset = token->offset;
   if (token->is_parserStatement()) {
     Ast* ast = parse_parserStatement();
     TreeConstructor tree_ctor = {};
@@ -620,9 +641,8 @@ Ast* Parser::parse_parserStatements()
 Ast* Parser::parse_parserStatement()
 {
   if (token->is_parserStatement()) {
-    Ast* parser_stmt = Ast_parserStatement::allocate(storage);
-    parser_stmt->line_no = token->line_no;
-    parser_stmt->column_no = token->column_no;
+    Ast* parser_stmt = Ast_parserStatement::allocate(ast_storage);
+    parser_stmt->offset = token->offset;
     if (token->is_typeRef()) {
       Ast* type_ref = parse_typeRef();
       if (token->is_name()) {
@@ -642,15 +662,15 @@ Ast* Parser::parse_parserStatement()
       parser_stmt->parserStatement.stmt = parse_variableDeclaration(0);
       return parser_stmt;
     } else if (token->klass == TokenClass::Semicolon) {
-      Ast* stmt = Ast_emptyStatement::allocate(storage);
-      stmt->line_no = token->line_no;
-      stmt->column_no = token->column_no;
+      Ast* stmt = Ast_emptyStatement::allocate(ast_storage);
+      stmt->offset = token->offset;
       parser_stmt->parserStatement.stmt = stmt;
       next_token();
       return parser_stmt;
     } else assert(0);
   } else error("%s:%d:%d: error: statement was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -659,17 +679,18 @@ Ast* Parser::parse_parserBlockStatement()
 {
   if (token->klass == TokenClass::BraceOpen) {
     next_token();
-    Ast* stmt = Ast_parserBlockStatement::allocate(storage);
-    stmt->line_no = token->line_no;
-    stmt->column_no = token->column_no;
+    Ast* stmt = Ast_parserBlockStatement::allocate(ast_storage);
+    stmt->offset = token->offset;
     stmt->parserBlockStatement.stmt_list = parse_parserStatements();
     if (token->klass == TokenClass::BraceClose) {
       next_token();
     } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return stmt;
   } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -678,13 +699,13 @@ Ast* Parser::parse_transitionStatement()
 {
   if (token->klass == TokenClass::Transition) {
     next_token();
-    Ast* transition = Ast_transitionStatement::allocate(storage);
-    transition->line_no = token->line_no;
-    transition->column_no = token->column_no;
+    Ast* transition = Ast_transitionStatement::allocate(ast_storage);
+    transition->offset = token->offset;
     transition->transitionStatement.stmt = parse_stateExpression();
     return transition;
   } else error("%s:%d:%d: error: `transition` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -692,22 +713,23 @@ Ast* Parser::parse_transitionStatement()
 Ast* Parser::parse_stateExpression()
 {
   if (token->is_name() || token->klass == TokenClass::Select) {
-    Ast* state_expr = Ast_stateExpression::allocate(storage);
-    state_expr->line_no = token->line_no;
-    state_expr->column_no = token->column_no;
+    Ast* state_expr = Ast_stateExpression::allocate(ast_storage);
+    state_expr->offset = token->offset;
     if (token->is_name()) {
       state_expr->stateExpression.expr = parse_name();
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                  source_file, token->line_no, token->column_no, token->lexeme);
+                  source_text->filename, source_text->line_no_at(token->offset),
+                  source_text->column_no_at(token->offset), token->lexeme);
       return state_expr;
     } else if (token->klass == TokenClass::Select) {
       state_expr->stateExpression.expr = parse_selectExpression();
       return state_expr;
     } else assert(0);
   } else error("%s:%d:%d: error: state expression was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -716,9 +738,8 @@ Ast* Parser::parse_selectExpression()
 {
   if (token->klass == TokenClass::Select) {
     next_token();
-    Ast* select_expr = Ast_selectExpression::allocate(storage);
-    select_expr->line_no = token->line_no;
-    select_expr->column_no = token->column_no;
+    Ast* select_expr = Ast_selectExpression::allocate(ast_storage);
+    select_expr->offset = token->offset;
     if (token->klass == TokenClass::ParenthOpen) {
       next_token();
       select_expr->selectExpression.expr_list = parse_expressionList();
@@ -730,25 +751,29 @@ Ast* Parser::parse_selectExpression()
           if (token->klass == TokenClass::BraceClose) {
             next_token();
           } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return select_expr;
   } else error("%s:%d:%d: error: `select` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_selectCaseList()
 {
-  Ast* cases = Ast_selectCaseList::allocate(storage);
-  cases->line_no = token->line_no;
-  cases->column_no = token->column_no;
+  Ast* cases = Ast_selectCaseList::allocate(ast_storage);
+  cases->offset = token->offset;
   if (token->is_selectCase()) {
     Ast* ast = parse_selectCase();
     TreeConstructor tree_ctor = {};
@@ -764,9 +789,8 @@ Ast* Parser::parse_selectCaseList()
 Ast* Parser::parse_selectCase()
 {
   if (token->is_keysetExpression()) {
-    Ast* select_case = Ast_selectCase::allocate(storage);
-    select_case->line_no = token->line_no;
-    select_case->column_no = token->column_no;
+    Ast* select_case = Ast_selectCase::allocate(ast_storage);
+    select_case->offset = token->offset;
     select_case->selectCase.keyset_expr = parse_keysetExpression();
     if (token->klass == TokenClass::Colon) {
       next_token();
@@ -775,14 +799,18 @@ Ast* Parser::parse_selectCase()
         if (token->klass == TokenClass::Semicolon) {
           next_token();
         } else error("%s:%d:%d: error: `;` expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `:` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return select_case;
   } else error("%s:%d:%d: error: keyset expression was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -790,9 +818,8 @@ Ast* Parser::parse_selectCase()
 Ast* Parser::parse_keysetExpression()
 {
   if (token->klass == TokenClass::ParenthOpen || token->is_simpleKeysetExpression()) {
-    Ast* keyset_expr = Ast_keysetExpression::allocate(storage);
-    keyset_expr->line_no = token->line_no;
-    keyset_expr->column_no = token->column_no;
+    Ast* keyset_expr = Ast_keysetExpression::allocate(ast_storage);
+    keyset_expr->offset = token->offset;
     if (token->klass == TokenClass::ParenthOpen) {
       keyset_expr->keysetExpression.expr = parse_tupleKeysetExpression();
       return keyset_expr;
@@ -801,7 +828,8 @@ Ast* Parser::parse_keysetExpression()
       return keyset_expr;
     } else assert(0);
   } else error("%s:%d:%d: error: keyset expression was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -810,26 +838,26 @@ Ast* Parser::parse_tupleKeysetExpression()
 {
   if (token->klass == TokenClass::ParenthOpen) {
     next_token();
-    Ast* tuple_keyset = Ast_tupleKeysetExpression::allocate(storage);
-    tuple_keyset->line_no = token->line_no;
-    tuple_keyset->column_no = token->column_no;
+    Ast* tuple_keyset = Ast_tupleKeysetExpression::allocate(ast_storage);
+    tuple_keyset->offset = token->offset;
     tuple_keyset->tupleKeysetExpression.expr_list = parse_simpleExpressionList();
     if (token->klass == TokenClass::ParenthClose) {
       next_token();
     } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return tuple_keyset;
   } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_simpleExpressionList()
 {
-  Ast* exprs = Ast_simpleExpressionList::allocate(storage);
-  exprs->line_no = token->line_no;
-  exprs->column_no = token->column_no;
+  Ast* exprs = Ast_simpleExpressionList::allocate(ast_storage);
+  exprs->offset = token->offset;
   if (token->is_expression()) {
     Ast* ast = parse_simpleKeysetExpression();
     TreeConstructor tree_ctor = {};
@@ -846,29 +874,27 @@ Ast* Parser::parse_simpleExpressionList()
 Ast* Parser::parse_simpleKeysetExpression()
 {
   if (token->is_simpleKeysetExpression()) {
-    Ast* simple_keyset = Ast_simpleKeysetExpression::allocate(storage);
-    simple_keyset->line_no = token->line_no;
-    simple_keyset->column_no = token->column_no;
+    Ast* simple_keyset = Ast_simpleKeysetExpression::allocate(ast_storage);
+    simple_keyset->offset = token->offset;
     if (token->is_expression()) {
       simple_keyset->simpleKeysetExpression.expr = parse_expression(1);
       return simple_keyset;
     } else if (token->klass == TokenClass::Default) {
       next_token();
-      Ast* default_keyset = Ast_default::allocate(storage);
-      default_keyset->line_no = token->line_no;
-      default_keyset->column_no = token->column_no;
+      Ast* default_keyset = Ast_default::allocate(ast_storage);
+      default_keyset->offset = token->offset;
       simple_keyset->simpleKeysetExpression.expr = default_keyset;
       return simple_keyset;
     } else if (token->klass == TokenClass::Dontcare) {
       next_token();
-      Ast* dontcare_keyset = Ast_dontcare::allocate(storage);
-      dontcare_keyset->line_no = token->line_no;
-      dontcare_keyset->column_no = token->column_no;
+      Ast* dontcare_keyset = Ast_dontcare::allocate(ast_storage);
+      dontcare_keyset->offset = token->offset;
       simple_keyset->simpleKeysetExpression.expr = dontcare_keyset;
       return simple_keyset;
     }
   } else error("%s:%d:%d: error: keyset expression was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -878,9 +904,8 @@ Ast* Parser::parse_simpleKeysetExpression()
 Ast* Parser::parse_controlDeclaration(Ast* control_proto)
 {
   if (token->klass == TokenClass::ParenthOpen || token->klass == TokenClass::BraceOpen) {
-    Ast* control_decl = Ast_controlDeclaration::allocate(storage);
-    control_decl->line_no = token->line_no;
-    control_decl->column_no = token->column_no;
+    Ast* control_decl = Ast_controlDeclaration::allocate(ast_storage);
+    control_decl->offset = token->offset;
     control_decl->controlDeclaration.proto = control_proto;
     control_decl->controlDeclaration.ctor_params = parse_constructorParameters();
     if (token->klass == TokenClass::BraceOpen) {
@@ -892,14 +917,18 @@ Ast* Parser::parse_controlDeclaration(Ast* control_proto)
         if (token->klass == TokenClass::BraceClose) {
           next_token();
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `apply` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return control_decl;
   } else error("%s:%d:%d: error: `control` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -908,12 +937,10 @@ Ast* Parser::parse_controlTypeDeclaration()
 {
   if (token->klass == TokenClass::Control) {
     next_token();
-    Ast* control_proto = Ast_controlTypeDeclaration::allocate(storage);
-    control_proto->line_no = token->line_no;
-    control_proto->column_no = token->column_no;
-    Ast* method_protos = Ast_methodPrototypes::allocate(storage);
-    method_protos->line_no = control_proto->line_no;
-    method_protos->column_no = control_proto->column_no;
+    Ast* control_proto = Ast_controlTypeDeclaration::allocate(ast_storage);
+    control_proto->offset = token->offset;
+    Ast* method_protos = Ast_methodPrototypes::allocate(ast_storage);
+    method_protos->offset = control_proto->offset;
     control_proto->controlTypeDeclaration.method_protos = method_protos;
     if (token->is_name()) {
       Ast* name = parse_name();
@@ -925,14 +952,18 @@ Ast* Parser::parse_controlTypeDeclaration()
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return control_proto;
   } else error("%s:%d:%d: error: `control` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -940,9 +971,8 @@ Ast* Parser::parse_controlTypeDeclaration()
 Ast* Parser::parse_controlLocalDeclaration()
 {
   if (token->is_controlLocalDeclaration()) {
-    Ast* local_decl = Ast_controlLocalDeclaration::allocate(storage);
-    local_decl->line_no = token->line_no;
-    local_decl->column_no = token->column_no;
+    Ast* local_decl = Ast_controlLocalDeclaration::allocate(ast_storage);
+    local_decl->offset = token->offset;
     if (token->klass == TokenClass::Const) {
       local_decl->controlLocalDeclaration.decl = parse_variableDeclaration(0);
       return local_decl;
@@ -961,19 +991,20 @@ Ast* Parser::parse_controlLocalDeclaration()
         local_decl->controlLocalDeclaration.decl = parse_variableDeclaration(type_ref);
         return local_decl;
       } else error("%s:%d:%d: error: unexpected token `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else assert(0);
   } else error("%s:%d:%d: error: local declaration was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_controlLocalDeclarations()
 {
-  Ast* decls = Ast_controlLocalDeclarations::allocate(storage);
-  decls->line_no = token->line_no;
-  decls->column_no = token->column_no;
+  Ast* decls = Ast_controlLocalDeclarations::allocate(ast_storage);
+  decls->offset = token->offset;
   if (token->is_controlLocalDeclaration()) {
     Ast* ast = parse_controlLocalDeclaration();
     TreeConstructor tree_ctor = {};
@@ -1001,22 +1032,22 @@ Ast* Parser::parse_externDeclaration()
     } else if (token->is_nonTypeName()) {
       is_function_type = 0;
     } else error("%s:%d:%d: error: extern declaration was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
 
-    Ast* extern_decl = Ast_externDeclaration::allocate(storage);
-    extern_decl->line_no = token->line_no;
-    extern_decl->column_no = token->column_no;
+    Ast* extern_decl = Ast_externDeclaration::allocate(ast_storage);
+    extern_decl->offset = token->offset;
     if (is_function_type) {
       extern_decl->externDeclaration.decl = parse_functionPrototype(0);
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return extern_decl;
     } else {
-      Ast* extern_type = Ast_externTypeDeclaration::allocate(storage);
-      extern_type->line_no = token->line_no;
-      extern_type->column_no = token->column_no;
+      Ast* extern_type = Ast_externTypeDeclaration::allocate(ast_storage);
+      extern_type->offset = token->offset;
       extern_type->externTypeDeclaration.name = parse_nonTypeName();
       Ast* name = extern_type->externTypeDeclaration.name;
       current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
@@ -1026,23 +1057,25 @@ Ast* Parser::parse_externDeclaration()
         if (token->klass == TokenClass::BraceClose) {
           next_token();
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       extern_decl->externDeclaration.decl = extern_type;
       return extern_decl;
     }
   } else error("%s:%d:%d: error: `extern` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_methodPrototypes()
 {
-  Ast* protos = Ast_methodPrototypes::allocate(storage);
-  protos->line_no = token->line_no;
-  protos->column_no = token->column_no;
+  Ast* protos = Ast_methodPrototypes::allocate(ast_storage);
+  protos->offset = token->offset;
   if (token->is_methodPrototype()) {
     Ast* ast = parse_methodPrototype();
     TreeConstructor tree_ctor = {};
@@ -1058,9 +1091,8 @@ Ast* Parser::parse_methodPrototypes()
 Ast* Parser::parse_functionPrototype(Ast* return_type)
 {
   if (token->is_typeOrVoid() || return_type) {
-    Ast* func_proto = Ast_functionPrototype::allocate(storage);
-    func_proto->line_no = token->line_no;
-    func_proto->column_no = token->column_no;
+    Ast* func_proto = Ast_functionPrototype::allocate(ast_storage);
+    func_proto->offset = token->offset;
     if (return_type) {
       func_proto->functionPrototype.return_type = return_type;
     } else {
@@ -1068,9 +1100,8 @@ Ast* Parser::parse_functionPrototype(Ast* return_type)
       if (return_type->kind == AstEnum::name) {
         Ast* name = return_type;
         current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
-        Ast* type_ref = Ast_typeRef::allocate(storage);
-        type_ref->line_no = token->line_no;
-        type_ref->column_no = token->column_no;
+        Ast* type_ref = Ast_typeRef::allocate(ast_storage);
+        type_ref->offset = token->offset;
         type_ref->typeRef.type = name;
         return_type = type_ref;
       }
@@ -1084,14 +1115,18 @@ Ast* Parser::parse_functionPrototype(Ast* return_type)
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: function name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return func_proto;
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1101,9 +1136,8 @@ Ast* Parser::parse_methodPrototype()
   if (token->is_methodPrototype()) {
     if (token->klass == TokenClass::TypeIdentifier && peek_token()->klass == TokenClass::ParenthOpen) {
       /* Constructor */
-      Ast* func_proto = Ast_functionPrototype::allocate(storage);
-      func_proto->line_no = token->line_no;
-      func_proto->column_no = token->column_no;
+      Ast* func_proto = Ast_functionPrototype::allocate(ast_storage);
+      func_proto->offset = token->offset;
       func_proto->functionPrototype.name = parse_name();
       if (token->klass == TokenClass::ParenthOpen) {
         next_token();
@@ -1111,25 +1145,31 @@ Ast* Parser::parse_methodPrototype()
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return func_proto;
     } else if (token->is_typeOrVoid()) {
       Ast* func_proto = parse_functionPrototype(0);
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return func_proto;
     } else error("%s:%d:%d: error: type was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1139,9 +1179,8 @@ Ast* Parser::parse_methodPrototype()
 Ast* Parser::parse_typeRef()
 {
   if (token->is_typeRef()) {
-    Ast* type_ref = Ast_typeRef::allocate(storage);
-    type_ref->line_no = token->line_no;
-    type_ref->column_no = token->column_no;
+    Ast* type_ref = Ast_typeRef::allocate(ast_storage);
+    type_ref->offset = token->offset;
     if (token->is_baseType()) {
       type_ref->typeRef.type = parse_baseType();
       return type_ref;
@@ -1153,7 +1192,8 @@ Ast* Parser::parse_typeRef()
       return type_ref;
     } else assert(0);
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1168,7 +1208,8 @@ Ast* Parser::parse_namedType()
     }
     return named_type;
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1178,14 +1219,14 @@ Ast* Parser::parse_typeName()
   Ast* type_name;
 
   if (token->klass == TokenClass::TypeIdentifier) {
-    type_name = Ast_name::allocate(storage);
-    type_name->line_no = token->line_no;
-    type_name->column_no = token->column_no;
+    type_name = Ast_name::allocate(ast_storage);
+    type_name->offset = token->offset;
     type_name->name.strname = token->lexeme;
     next_token();
     return type_name;
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1193,9 +1234,8 @@ Ast* Parser::parse_typeName()
 Ast* Parser::parse_tupleType()
 {
   if (token->klass == TokenClass::Tuple) {
-    Ast* tuple = Ast_tupleType::allocate(storage);
-    tuple->line_no = token->line_no;
-    tuple->column_no = token->column_no;
+    Ast* tuple = Ast_tupleType::allocate(ast_storage);
+    tuple->offset = token->offset;
     next_token();
     if (token->klass == TokenClass::AngleOpen) {
       next_token();
@@ -1203,12 +1243,15 @@ Ast* Parser::parse_tupleType()
       if (token->klass == TokenClass::AngleClose) {
         next_token();
       } else error("%s:%d:%d: error: `>` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `<` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return tuple;
   } else error("%s:%d:%d: error: `tuple` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1217,25 +1260,26 @@ Ast* Parser::parse_headerStackType(Ast* named_type)
 {
   if (token->klass == TokenClass::BracketOpen) {
     next_token();
-    Ast* type_ref = Ast_typeRef::allocate(storage);
-    type_ref->line_no = named_type->line_no;
-    type_ref->column_no = named_type->column_no;
+    Ast* type_ref = Ast_typeRef::allocate(ast_storage);
+    type_ref->offset = named_type->offset;
     type_ref->typeRef.type = named_type;
-    Ast* type = Ast_headerStackType::allocate(storage);
-    type->line_no = named_type->line_no;
-    type->column_no = named_type->column_no;
+    Ast* type = Ast_headerStackType::allocate(ast_storage);
+    type->offset = named_type->offset;
     type->headerStackType.type = type_ref;
     if (token->is_expression()) {
       type->headerStackType.stack_expr = parse_expression(1);
       if (token->klass == TokenClass::BracketClose) {
         next_token();
       } else error("%s:%d:%d: error: `]` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: expression expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return type;
   } else error("%s:%d:%d: error: `[` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1243,21 +1287,18 @@ Ast* Parser::parse_headerStackType(Ast* named_type)
 Ast* Parser::parse_baseType()
 {
   if (token->is_baseType()) {
-    Ast* type_name = Ast_name::allocate(storage);
-    type_name->line_no = token->line_no;
-    type_name->column_no = token->column_no;
+    Ast* type_name = Ast_name::allocate(ast_storage);
+    type_name->offset = token->offset;
     if (token->klass == TokenClass::Bool) {
-      Ast* type = Ast_baseTypeBoolean::allocate(storage);
-      type->line_no = token->line_no;
-      type->column_no = token->column_no;
+      Ast* type = Ast_baseTypeBoolean::allocate(ast_storage);
+      type->offset = token->offset;
       type_name->name.strname = token->lexeme;
       type->baseTypeBoolean.name = type_name;
       next_token();
       return type;
     } else if (token->klass == TokenClass::Int) {
-      Ast* type = Ast_baseTypeInteger::allocate(storage);
-      type->line_no = token->line_no;
-      type->column_no = token->column_no;
+      Ast* type = Ast_baseTypeInteger::allocate(ast_storage);
+      type->offset = token->offset;
       type_name->name.strname = token->lexeme;
       type->baseTypeInteger.name = type_name;
       next_token();
@@ -1267,13 +1308,13 @@ Ast* Parser::parse_baseType()
         if (token->klass == TokenClass::AngleClose) {
           next_token();
         } else error("%s:%d:%d: error: `>` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       }
       return type;
     } else if (token->klass == TokenClass::Bit) {
-      Ast* type = Ast_baseTypeBit::allocate(storage);
-      type->line_no = token->line_no;
-      type->column_no = token->column_no;
+      Ast* type = Ast_baseTypeBit::allocate(ast_storage);
+      type->offset = token->offset;
       type_name->name.strname = token->lexeme;
       type->baseTypeBit.name = type_name;
       next_token();
@@ -1283,13 +1324,13 @@ Ast* Parser::parse_baseType()
         if (token->klass == TokenClass::AngleClose) {
           next_token();
         } else error("%s:%d:%d: error: `>` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       }
       return type;
     } else if (token->klass == TokenClass::Varbit) {
-      Ast* type = Ast_baseTypeVarbit::allocate(storage);
-      type->line_no = token->line_no;
-      type->column_no = token->column_no;
+      Ast* type = Ast_baseTypeVarbit::allocate(ast_storage);
+      type->offset = token->offset;
       type_name->name.strname = token->lexeme;
       type->baseTypeVarbit.name = type_name;
       next_token();
@@ -1299,46 +1340,45 @@ Ast* Parser::parse_baseType()
         if (token->klass == TokenClass::AngleClose) {
           next_token();
         } else error("%s:%d:%d: error: `>` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: '<' was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return type;
     } else if (token->klass == TokenClass::String) {
-      Ast* type = Ast_baseTypeString::allocate(storage);
-      type->line_no = token->line_no;
-      type->column_no = token->column_no;
+      Ast* type = Ast_baseTypeString::allocate(ast_storage);
+      type->offset = token->offset;
       type_name->name.strname = token->lexeme;
       type->baseTypeString.name = type_name;
       next_token();
       return type;
     } else if (token->klass == TokenClass::Void) {
-      Ast* type = Ast_baseTypeVoid::allocate(storage);
-      type->line_no = token->line_no;
-      type->column_no = token->column_no;
+      Ast* type = Ast_baseTypeVoid::allocate(ast_storage);
+      type->offset = token->offset;
       type_name->name.strname = token->lexeme;
       type->baseTypeVoid.name = type_name;
       next_token();
       return type;
     } else if (token->klass == TokenClass::Error) {
-      Ast* type = Ast_baseTypeError::allocate(storage);
-      type->line_no = token->line_no;
-      type->column_no = token->column_no;
+      Ast* type = Ast_baseTypeError::allocate(ast_storage);
+      type->offset = token->offset;
       type_name->name.strname = token->lexeme;
       type->baseTypeError.name = type_name;
       next_token();
       return type;
     } else assert(0);
   } else error("%s:%d:%d: error: base type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_integerTypeSize()
 {
-  Ast* type_size = Ast_integerTypeSize::allocate(storage);
-  type_size->line_no = token->line_no;
-  type_size->column_no = token->column_no;
+  Ast* type_size = Ast_integerTypeSize::allocate(ast_storage);
+  type_size->offset = token->offset;
   if (token->klass == TokenClass::IntegerLiteral) {
     type_size->integerTypeSize.size = parse_integer();
   } else if (token->klass == TokenClass::ParenthOpen) {
@@ -1346,9 +1386,11 @@ Ast* Parser::parse_integerTypeSize()
     type_size->size = parse_expression(1);
 #endif
     error("%s:%d:%d: error: integer was expected, got `%s`.",
-          source_file, token->line_no, token->column_no, token->lexeme);
+          source_text->filename, source_text->line_no_at(token->offset),
+          source_text->column_no_at(token->offset), token->lexeme);
   } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   return type_size;
 }
 
@@ -1361,15 +1403,15 @@ Ast* Parser::parse_typeOrVoid()
     } else if (token->klass == TokenClass::Void) {
       return parse_baseType();
     } else if (token->klass == TokenClass::Identifier) {
-      Ast* name = Ast_name::allocate(storage);
-      name->line_no = token->line_no;
-      name->column_no = token->column_no;
+      Ast* name = Ast_name::allocate(ast_storage);
+      name->offset = token->offset;
       name->name.strname = token->lexeme;
       next_token();
       return name;
     } else assert(0);
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1377,14 +1419,12 @@ Ast* Parser::parse_typeOrVoid()
 Ast* Parser::parse_realTypeArg()
 {
   if (token->is_realTypeArg()) {
-    Ast* type_arg = Ast_realTypeArg::allocate(storage);
-    type_arg->line_no = token->line_no;
-    type_arg->column_no = token->column_no;
+    Ast* type_arg = Ast_realTypeArg::allocate(ast_storage);
+    type_arg->offset = token->offset;
     if (token->klass == TokenClass::Dontcare) {
       next_token();
-      Ast* dontcare_arg = Ast_dontcare::allocate(storage);
-      dontcare_arg->line_no = token->line_no;
-      dontcare_arg->column_no = token->column_no;
+      Ast* dontcare_arg = Ast_dontcare::allocate(ast_storage);
+      dontcare_arg->offset = token->offset;
       type_arg->realTypeArg.arg = dontcare_arg;
       return type_arg;
     } else if (token->is_typeRef()) {
@@ -1392,7 +1432,8 @@ Ast* Parser::parse_realTypeArg()
       return type_arg;
     } else assert(0);
   } else error("%s:%d:%d: error: type argument was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1400,14 +1441,12 @@ Ast* Parser::parse_realTypeArg()
 Ast* Parser::parse_typeArg()
 {
   if (token->is_typeArg()) {
-    Ast* type_arg = Ast_typeArg::allocate(storage);
-    type_arg->line_no = token->line_no;
-    type_arg->column_no = token->column_no;
+    Ast* type_arg = Ast_typeArg::allocate(ast_storage);
+    type_arg->offset = token->offset;
     if (token->klass == TokenClass::Dontcare) {
       next_token();
-      Ast* dontcare_arg = Ast_dontcare::allocate(storage);
-      dontcare_arg->line_no = token->line_no;
-      dontcare_arg->column_no = token->column_no;
+      Ast* dontcare_arg = Ast_dontcare::allocate(ast_storage);
+      dontcare_arg->offset = token->offset;
       type_arg->typeArg.arg = dontcare_arg;
       return type_arg;
     } else if (token->is_typeRef()) {
@@ -1418,16 +1457,16 @@ Ast* Parser::parse_typeArg()
       return type_arg;
     } else assert(0);
   } else error("%s:%d:%d: error: type argument was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_typeArgumentList()
 {
-  Ast* args = Ast_typeArgumentList::allocate(storage);
-  args->line_no = token->line_no;
-  args->column_no = token->column_no;
+  Ast* args = Ast_typeArgumentList::allocate(ast_storage);
+  args->offset = token->offset;
   if (token->is_typeArg()) {
     Ast* ast = parse_typeArg();
     TreeConstructor tree_ctor = {};
@@ -1444,9 +1483,8 @@ Ast* Parser::parse_typeArgumentList()
 Ast* Parser::parse_typeDeclaration()
 {
   if (token->is_typeDeclaration()) {
-    Ast* type_decl = Ast_typeDeclaration::allocate(storage);
-    type_decl->line_no = token->line_no;
-    type_decl->column_no = token->column_no;
+    Ast* type_decl = Ast_typeDeclaration::allocate(ast_storage);
+    type_decl->offset = token->offset;
     if (token->is_derivedTypeDeclaration()) {
       type_decl->typeDeclaration.decl = parse_derivedTypeDeclaration();
       return type_decl;
@@ -1464,11 +1502,13 @@ Ast* Parser::parse_typeDeclaration()
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return type_decl;
     } else assert(0);
   } else error("%s:%d:%d: error: type declaration was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1476,9 +1516,8 @@ Ast* Parser::parse_typeDeclaration()
 Ast* Parser::parse_derivedTypeDeclaration()
 {
   if (token->is_derivedTypeDeclaration()) {
-    Ast* type_decl = Ast_derivedTypeDeclaration::allocate(storage);
-    type_decl->line_no = token->line_no;
-    type_decl->column_no = token->column_no;
+    Ast* type_decl = Ast_derivedTypeDeclaration::allocate(ast_storage);
+    type_decl->offset = token->offset;
     if (token->klass == TokenClass::Header) {
       type_decl->derivedTypeDeclaration.decl = parse_headerTypeDeclaration();
       return type_decl;
@@ -1493,7 +1532,8 @@ Ast* Parser::parse_derivedTypeDeclaration()
       return type_decl;
     } else assert(0);
   } else error("%s:%d:%d: error: structure declaration was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1502,9 +1542,8 @@ Ast* Parser::parse_headerTypeDeclaration()
 {
   if (token->klass == TokenClass::Header) {
     next_token();
-    Ast* header_decl = Ast_headerTypeDeclaration::allocate(storage);
-    header_decl->line_no = token->line_no;
-    header_decl->column_no = token->column_no;
+    Ast* header_decl = Ast_headerTypeDeclaration::allocate(ast_storage);
+    header_decl->offset = token->offset;
     if (token->is_name()) {
       Ast* name = parse_name();
       current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
@@ -1515,14 +1554,18 @@ Ast* Parser::parse_headerTypeDeclaration()
         if (token->klass == TokenClass::BraceClose) {
           next_token();
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return header_decl;
   } else error("%s:%d:%d: error: `header` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1531,9 +1574,8 @@ Ast* Parser::parse_headerUnionDeclaration()
 {
   if (token->klass == TokenClass::Union) {
     next_token();
-    Ast* union_decl = Ast_headerUnionDeclaration::allocate(storage);
-    union_decl->line_no = token->line_no;
-    union_decl->column_no = token->column_no;
+    Ast* union_decl = Ast_headerUnionDeclaration::allocate(ast_storage);
+    union_decl->offset = token->offset;
     if (token->is_name()) {
       Ast* name = parse_name();
       current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
@@ -1544,14 +1586,18 @@ Ast* Parser::parse_headerUnionDeclaration()
         if (token->klass == TokenClass::BraceClose) {
           next_token();
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return union_decl;
   } else error("%s:%d:%d: error: `header_union` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1560,9 +1606,8 @@ Ast* Parser::parse_structTypeDeclaration()
 {
   if (token->klass == TokenClass::Struct) {
     next_token();
-    Ast* struct_decl = Ast_structTypeDeclaration::allocate(storage);
-    struct_decl->line_no = token->line_no;
-    struct_decl->column_no = token->column_no;
+    Ast* struct_decl = Ast_structTypeDeclaration::allocate(ast_storage);
+    struct_decl->offset = token->offset;
     if (token->is_name()) {
       Ast* name = parse_name();
       current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
@@ -1573,23 +1618,26 @@ Ast* Parser::parse_structTypeDeclaration()
         if (token->klass == TokenClass::BraceClose) {
           next_token();
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return struct_decl;
   } else error("%s:%d:%d: error: `struct` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_structFieldList()
 {
-  Ast* fields = Ast_structFieldList::allocate(storage);
-  fields->line_no = token->line_no;
-  fields->column_no = token->column_no;
+  Ast* fields = Ast_structFieldList::allocate(ast_storage);
+  fields->offset = token->offset;
   if (token->is_structField()) {
     Ast* ast = parse_structField();
     TreeConstructor tree_ctor = {};
@@ -1605,21 +1653,23 @@ Ast* Parser::parse_structFieldList()
 Ast* Parser::parse_structField()
 {
   if (token->is_structField()) {
-    Ast* field = Ast_structField::allocate(storage);
-    field->line_no = token->line_no;
-    field->column_no = token->column_no;
+    Ast* field = Ast_structField::allocate(ast_storage);
+    field->offset = token->offset;
     field->structField.type = parse_typeRef();
     if (token->is_name()) {
       field->structField.name = parse_name();
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return field;
   } else error("%s:%d:%d: error: struct field was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1628,9 +1678,8 @@ Ast* Parser::parse_enumDeclaration()
 {
   if (token->klass == TokenClass::Enum) {
     next_token();
-    Ast* enum_decl = Ast_enumDeclaration::allocate(storage);
-    enum_decl->line_no = token->line_no;
-    enum_decl->column_no = token->column_no;
+    Ast* enum_decl = Ast_enumDeclaration::allocate(ast_storage);
+    enum_decl->offset = token->offset;
     if (token->klass == TokenClass::Bit) {
       next_token();
       if (token->klass == TokenClass::AngleOpen) {
@@ -1640,11 +1689,14 @@ Ast* Parser::parse_enumDeclaration()
           if (token->klass == TokenClass::AngleClose) {
             next_token();
           } else error("%s:%d:%d: error: `>` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: an integer was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `<` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     }
     if (token->is_name()) {
       Ast* name = parse_name();
@@ -1657,16 +1709,21 @@ Ast* Parser::parse_enumDeclaration()
           if (token->klass == TokenClass::BraceClose) {
             next_token();
           } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return enum_decl;
   } else error("%s:%d:%d: error: `enum` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1675,27 +1732,31 @@ Ast* Parser::parse_errorDeclaration()
 {
   if (token->klass == TokenClass::Error) {
     next_token();
-    Ast* error_decl = Ast_errorDeclaration::allocate(storage);
-    error_decl->line_no = token->line_no;
-    error_decl->column_no = token->column_no;
+    Ast* error_decl = Ast_errorDeclaration::allocate(ast_storage);
+    error_decl->offset = token->offset;
     if (token->klass == TokenClass::BraceOpen) {
       next_token();
       if (token->is_name()) {
         if (token->is_name()) {
           error_decl->errorDeclaration.fields = parse_identifierList();
         } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
         if (token->klass == TokenClass::BraceClose) {
           next_token();
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return error_decl;
   } else error("%s:%d:%d: error: `error` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1704,9 +1765,8 @@ Ast* Parser::parse_matchKindDeclaration()
 {
   if (token->klass == TokenClass::MatchKind) {
     next_token();
-    Ast* match_decl = Ast_matchKindDeclaration::allocate(storage);
-    match_decl->line_no = token->line_no;
-    match_decl->column_no = token->column_no;
+    Ast* match_decl = Ast_matchKindDeclaration::allocate(ast_storage);
+    match_decl->offset = token->offset;
     if (token->klass == TokenClass::BraceOpen) {
       next_token();
       if (token->is_name()) {
@@ -1714,23 +1774,26 @@ Ast* Parser::parse_matchKindDeclaration()
         if (token->klass == TokenClass::BraceClose) {
           next_token();
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return match_decl;
   } else error("%s:%d:%d: error: `match_kind` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_identifierList()
 {
-  Ast* ids = Ast_identifierList::allocate(storage);
-  ids->line_no = token->line_no;
-  ids->column_no = token->column_no;
+  Ast* ids = Ast_identifierList::allocate(ast_storage);
+  ids->offset = token->offset;
   if (token->is_name()) {
     Ast* ast = parse_name();
     TreeConstructor tree_ctor = {};
@@ -1746,9 +1809,8 @@ Ast* Parser::parse_identifierList()
 
 Ast* Parser::parse_specifiedIdentifierList()
 {
-  Ast* ids = Ast_specifiedIdentifierList::allocate(storage);
-  ids->line_no = token->line_no;
-  ids->column_no = token->column_no;
+  Ast* ids = Ast_specifiedIdentifierList::allocate(ast_storage);
+  ids->offset = token->offset;
   if (token->is_specifiedIdentifier()) {
     Ast* ast = parse_specifiedIdentifier();
     TreeConstructor tree_ctor = {};
@@ -1765,20 +1827,21 @@ Ast* Parser::parse_specifiedIdentifierList()
 Ast* Parser::parse_specifiedIdentifier()
 {
   if (token->is_specifiedIdentifier()) {
-    Ast* id = Ast_specifiedIdentifier::allocate(storage);
-    id->line_no = token->line_no;
-    id->column_no= token->column_no;
+    Ast* id = Ast_specifiedIdentifier::allocate(ast_storage);
+    id->offset = token->offset;
     id->specifiedIdentifier.name = parse_name();
     if (token->klass == TokenClass::Equal) {
       next_token();
       if (token->is_expression()) {
         id->specifiedIdentifier.init_expr = parse_expression(1);
       } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     }
     return id;
   } else error("%s:%d:%d: error: name was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1788,9 +1851,8 @@ Ast* Parser::parse_typedefDeclaration()
   if (token->klass == TokenClass::Typedef) {
     next_token();
     if (token->is_typeRef() || token->is_derivedTypeDeclaration()) {
-      Ast* type_decl = Ast_typedefDeclaration::allocate(storage);
-      type_decl->line_no = token->line_no;
-      type_decl->column_no = token->column_no;
+      Ast* type_decl = Ast_typedefDeclaration::allocate(ast_storage);
+      type_decl->offset = token->offset;
       if (token->is_typeRef()) {
         type_decl->typedefDeclaration.type_ref = parse_typeRef();
       } else if (token->is_derivedTypeDeclaration()) {
@@ -1803,14 +1865,18 @@ Ast* Parser::parse_typedefDeclaration()
         if (token->klass == TokenClass::Semicolon) {
           next_token();
         } else error("%s:%d:%d: error: `;` expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return type_decl;
     } else error("%s:%d:%d: error: type was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
   } else error("%s:%d:%d: error: type definition was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1823,36 +1889,39 @@ Ast* Parser::parse_assignmentOrMethodCallStatement()
     Ast* lvalue = parse_lvalue();
     if (token->klass == TokenClass::ParenthOpen) {
       next_token();
-      Ast* stmt = Ast_functionCall::allocate(storage);
-      stmt->line_no = token->line_no;
-      stmt->column_no = token->column_no;
+      Ast* stmt = Ast_functionCall::allocate(ast_storage);
+      stmt->offset = token->offset;
       stmt->functionCall.lhs_expr = lvalue;
       stmt->functionCall.args = parse_argumentList();
       if (token->klass == TokenClass::ParenthClose) {
         next_token();
       } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return stmt;
     } else if (token->klass == TokenClass::Equal) {
       next_token();
-      Ast* stmt = Ast_assignmentStatement::allocate(storage);
-      stmt->line_no = token->line_no;
-      stmt->column_no = token->column_no;
+      Ast* stmt = Ast_assignmentStatement::allocate(ast_storage);
+      stmt->offset = token->offset;
       stmt->assignmentStatement.lhs_expr = lvalue;
       stmt->assignmentStatement.rhs_expr = parse_expression(1);
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return stmt;
     } else error("%s:%d:%d: error: assignment or function call was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
   } else error("%s:%d:%d: error: lvalue was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1861,18 +1930,19 @@ Ast* Parser::parse_returnStatement()
 {
   if (token->klass == TokenClass::Return) {
     next_token();
-    Ast* return_stmt = Ast_returnStatement::allocate(storage);
-    return_stmt->line_no = token->line_no;
-    return_stmt->column_no = token->column_no;
+    Ast* return_stmt = Ast_returnStatement::allocate(ast_storage);
+    return_stmt->offset = token->offset;
     if (token->is_expression())
       return_stmt->returnStatement.expr = parse_expression(1);
     if (token->klass == TokenClass::Semicolon) {
       next_token();
     } else error("%s:%d:%d: error: `;` expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return return_stmt;
   } else error("%s:%d:%d: error: `return` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1881,16 +1951,17 @@ Ast* Parser::parse_exitStatement()
 {
   if (token->klass == TokenClass::Exit) {
     next_token();
-    Ast* exit_stmt = Ast_exitStatement::allocate(storage);
-    exit_stmt->line_no = token->line_no;
-    exit_stmt->column_no = token->column_no;
+    Ast* exit_stmt = Ast_exitStatement::allocate(ast_storage);
+    exit_stmt->offset = token->offset;
     if (token->klass == TokenClass::Semicolon) {
       next_token();
     } else error("%s:%d:%d: error: `;` expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return exit_stmt;
   } else error("%s:%d:%d: error: `exit` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1899,9 +1970,8 @@ Ast* Parser::parse_conditionalStatement()
 {
   if (token->klass == TokenClass::If) {
     next_token();
-    Ast* if_stmt = Ast_conditionalStatement::allocate(storage);
-    if_stmt->line_no = token->line_no;
-    if_stmt->column_no = token->column_no;
+    Ast* if_stmt = Ast_conditionalStatement::allocate(ast_storage);
+    if_stmt->offset = token->offset;
     if (token->klass == TokenClass::ParenthOpen) {
       next_token();
       if (token->is_expression()) {
@@ -1915,19 +1985,25 @@ Ast* Parser::parse_conditionalStatement()
               if (token->is_statement()) {
                 if_stmt->conditionalStatement.else_stmt = parse_statement(0);
               } else error("%s:%d:%d: error: statement was expected, got `%s`.",
-                           source_file, token->line_no, token->column_no, token->lexeme);
+                           source_text->filename, source_text->line_no_at(token->offset),
+                           source_text->column_no_at(token->offset), token->lexeme);
             }
           } else error("%s:%d:%d: error: statement was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return if_stmt;
   } else error("%s:%d:%d: error: `if` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1935,9 +2011,8 @@ Ast* Parser::parse_conditionalStatement()
 Ast* Parser::parse_directApplication(Ast* type_name)
 {
   if (token->is_typeName() || type_name) {
-    Ast* apply_stmt = Ast_directApplication::allocate(storage);
-    apply_stmt->line_no = token->line_no;
-    apply_stmt->column_no = token->column_no;
+    Ast* apply_stmt = Ast_directApplication::allocate(ast_storage);
+    apply_stmt->offset = token->offset;
     apply_stmt->directApplication.name = type_name ? type_name : parse_typeName();
     if (token->klass == TokenClass::Dot) {
       next_token();
@@ -1951,18 +2026,24 @@ Ast* Parser::parse_directApplication(Ast* type_name)
             if (token->klass == TokenClass::Semicolon) {
               next_token();
             } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                         source_file, token->line_no, token->column_no, token->lexeme);
+                         source_text->filename, source_text->line_no_at(token->offset),
+                         source_text->column_no_at(token->offset), token->lexeme);
           } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `apply` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `.` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return apply_stmt;
   } else error("%s:%d:%d: error: type name was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -1970,9 +2051,8 @@ Ast* Parser::parse_directApplication(Ast* type_name)
 Ast* Parser::parse_statement(Ast* type_name)
 {
   if (token->is_statement()) {
-    Ast* stmt = Ast_statement::allocate(storage);
-    stmt->line_no = token->line_no;
-    stmt->column_no = token->column_no;
+    Ast* stmt = Ast_statement::allocate(ast_storage);
+    stmt->offset = token->offset;
     if (token->is_typeName() || type_name) {
       stmt->statement.stmt = parse_directApplication(type_name);
       return stmt;
@@ -1983,9 +2063,8 @@ Ast* Parser::parse_statement(Ast* type_name)
       stmt->statement.stmt = parse_conditionalStatement();
       return stmt;
     } else if (token->klass == TokenClass::Semicolon) {
-      Ast* empty_stmt = Ast_emptyStatement::allocate(storage);
-      empty_stmt->line_no = token->line_no;
-      empty_stmt->column_no = token->column_no;
+      Ast* empty_stmt = Ast_emptyStatement::allocate(ast_storage);
+      empty_stmt->offset = token->offset;
       stmt->statement.stmt = empty_stmt;
       next_token();
       return stmt;
@@ -2003,7 +2082,8 @@ Ast* Parser::parse_statement(Ast* type_name)
       return stmt;
     }
   } else error("%s:%d:%d: error: statement was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2012,26 +2092,26 @@ Ast* Parser::parse_blockStatement()
 {
   if (token->klass == TokenClass::BraceOpen) {
     next_token();
-    Ast* block_stmt = Ast_blockStatement::allocate(storage);
-    block_stmt->line_no = token->line_no;
-    block_stmt->column_no = token->column_no;
+    Ast* block_stmt = Ast_blockStatement::allocate(ast_storage);
+    block_stmt->offset = token->offset;
     block_stmt->blockStatement.stmt_list = parse_statementOrDeclList();
     if (token->klass == TokenClass::BraceClose) {
       next_token();
     } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return block_stmt;
   } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_statementOrDeclList()
 {
-  Ast* stmts = Ast_statementOrDeclList::allocate(storage);
-  stmts->line_no = token->line_no;
-  stmts->column_no = token->column_no;
+  Ast* stmts = Ast_statementOrDeclList::allocate(ast_storage);
+  stmts->offset = token->offset;
   if (token->is_statementOrDeclaration()) {
     Ast* ast = parse_statementOrDeclaration();
     TreeConstructor tree_ctor = {};
@@ -2048,9 +2128,8 @@ Ast* Parser::parse_switchStatement()
 {
   if (token->klass == TokenClass::Switch) {
     next_token();
-    Ast* stmt = Ast_switchStatement::allocate(storage);
-    stmt->line_no = token->line_no;
-    stmt->column_no = token->column_no;
+    Ast* stmt = Ast_switchStatement::allocate(ast_storage);
+    stmt->offset = token->offset;
     if (token->klass == TokenClass::ParenthOpen) {
       next_token();
       stmt->switchStatement.expr = parse_expression(1);
@@ -2062,25 +2141,29 @@ Ast* Parser::parse_switchStatement()
           if (token->klass == TokenClass::BraceClose) {
             next_token();
           } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return stmt;
   } else error("%s:%d:%d: error: `switch` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_switchCases()
 {
-  Ast* cases = Ast_switchCases::allocate(storage);
-  cases->line_no = token->line_no;
-  cases->column_no = token->column_no;
+  Ast* cases = Ast_switchCases::allocate(ast_storage);
+  cases->offset = token->offset;
   if (token->is_switchLabel()) {
     Ast* ast = parse_switchCase();
     TreeConstructor tree_ctor = {};
@@ -2096,9 +2179,8 @@ Ast* Parser::parse_switchCases()
 Ast* Parser::parse_switchCase()
 {
   if (token->is_switchLabel()) {
-    Ast* switch_case = Ast_switchCase::allocate(storage);
-    switch_case->line_no = token->line_no;
-    switch_case->column_no = token->column_no;
+    Ast* switch_case = Ast_switchCase::allocate(ast_storage);
+    switch_case->offset = token->offset;
     switch_case->switchCase.label = parse_switchLabel();
     if (token->klass == TokenClass::Colon) {
       next_token();
@@ -2106,10 +2188,12 @@ Ast* Parser::parse_switchCase()
         switch_case->switchCase.stmt = parse_blockStatement();
       }
     } else error("%s:%d:%d: error: `:` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return switch_case;
   } else error("%s:%d:%d: error: switch label was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2117,22 +2201,21 @@ Ast* Parser::parse_switchCase()
 Ast* Parser::parse_switchLabel()
 {
   if (token->is_switchLabel()) {
-    Ast* switch_label = Ast_switchLabel::allocate(storage);
-    switch_label->line_no = token->line_no;
-    switch_label->column_no = token->column_no;
+    Ast* switch_label = Ast_switchLabel::allocate(ast_storage);
+    switch_label->offset = token->offset;
     if (token->is_name()) {
       switch_label->switchLabel.label = parse_name();
       return switch_label;
     } else if (token->klass == TokenClass::Default) {
       next_token();
-      Ast* default_label = Ast_default::allocate(storage);
-      default_label->line_no = token->line_no;
-      default_label->column_no = token->column_no;
+      Ast* default_label = Ast_default::allocate(ast_storage);
+      default_label->offset = token->offset;
       switch_label->switchLabel.label = default_label;
       return switch_label;
     } else assert(0);
   } else error("%s:%d:%d: error: switch label was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2140,9 +2223,8 @@ Ast* Parser::parse_switchLabel()
 Ast* Parser::parse_statementOrDeclaration()
 {
   if (token->is_statementOrDeclaration()) {
-    Ast* stmt = Ast_statementOrDeclaration::allocate(storage);
-    stmt->line_no = token->line_no;
-    stmt->column_no = token->column_no;
+    Ast* stmt = Ast_statementOrDeclaration::allocate(ast_storage);
+    stmt->offset = token->offset;
     if (token->is_typeRef()) {
       Ast* type_ref = parse_typeRef();
       if (token->klass == TokenClass::ParenthOpen) {
@@ -2174,38 +2256,39 @@ Ast* Parser::parse_tableDeclaration()
 {
   if (token->klass == TokenClass::Table) {
     next_token();
-    Ast* table = Ast_tableDeclaration::allocate(storage);
-    table->line_no = token->line_no;
-    table->column_no = token->column_no;
+    Ast* table = Ast_tableDeclaration::allocate(ast_storage);
+    table->offset = token->offset;
     table->tableDeclaration.name = parse_name();
-    Ast* method_protos = Ast_methodPrototypes::allocate(storage);
-    method_protos->line_no = table->line_no;
-    method_protos->column_no = table->column_no;
+    Ast* method_protos = Ast_methodPrototypes::allocate(ast_storage);
+    method_protos->offset = table->offset;
     table->tableDeclaration.method_protos = method_protos;
     if (token->klass == TokenClass::BraceOpen) {
       next_token();
       if (token->is_tableProperty()) {
         table->tableDeclaration.prop_list = parse_tablePropertyList();
       } else error("%s:%d:%d: error: table property was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       if (token->klass == TokenClass::BraceClose) {
         next_token();
       } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return table;
   } else error("%s:%d:%d: error: `table` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_tablePropertyList()
 {
-  Ast* props = Ast_tablePropertyList::allocate(storage);
-  props->line_no = token->line_no;
-  props->column_no = token->column_no;
+  Ast* props = Ast_tablePropertyList::allocate(ast_storage);
+  props->offset = token->offset;
   if (token->is_tableProperty()) {
     Ast* ast = parse_tableProperty();
     TreeConstructor tree_ctor = {};
@@ -2230,14 +2313,12 @@ Ast* Parser::parse_tableProperty()
       is_const = 1;
     }
 #endif
-    Ast* table_prop = Ast_tableProperty::allocate(storage);
-    table_prop->line_no = token->line_no;
-    table_prop->column_no = token->column_no;
+    Ast* table_prop = Ast_tableProperty::allocate(ast_storage);
+    table_prop->offset = token->offset;
     if (token->klass == TokenClass::Key) {
       next_token();
-      Ast* prop = Ast_keyProperty::allocate(storage);
-      prop->line_no = token->line_no;
-      prop->column_no = token->column_no;
+      Ast* prop = Ast_keyProperty::allocate(ast_storage);
+      prop->offset = token->offset;
       if (token->klass == TokenClass::Equal) {
         next_token();
         if (token->klass == TokenClass::BraceOpen) {
@@ -2246,18 +2327,20 @@ Ast* Parser::parse_tableProperty()
           if (token->klass == TokenClass::BraceClose) {
             next_token();
           } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `=` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       table_prop->tableProperty.prop = prop;
       return table_prop;
     } else if (token->klass == TokenClass::Actions) {
       next_token();
-      Ast* prop = Ast_actionsProperty::allocate(storage);
-      prop->line_no = token->line_no;
-      prop->column_no = token->column_no;
+      Ast* prop = Ast_actionsProperty::allocate(ast_storage);
+      prop->offset = token->offset;
       if (token->klass == TokenClass::Equal) {
         next_token();
         if (token->klass == TokenClass::BraceOpen) {
@@ -2266,11 +2349,14 @@ Ast* Parser::parse_tableProperty()
           if (token->klass == TokenClass::BraceClose) {
             next_token();
           } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `=` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       table_prop->tableProperty.prop = prop;
       return table_prop;
     }
@@ -2279,8 +2365,7 @@ Ast* Parser::parse_tableProperty()
       next_token();
       prop = (Ast*)storage->malloc(sizeof(Ast));
       prop->kind = AstEnum::entriesProperty;
-      prop->line_no = token->line_no;
-      prop->column_no = token->column_no;
+      prop->offset = token->offset;
       if (token->klass == TokenClass::EQUAL) {
         next_token();
         if (token->klass == TokenClass::BRACE_OPEN) {
@@ -2288,23 +2373,26 @@ Ast* Parser::parse_tableProperty()
           if (token_is_keysetExpression(token)) {
             prop->entriesProperty.entries_list = parse_entriesList();
           } else error("%s:%d:%d: error: keyset expression was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
           if (token->klass == TokenClass::BRACE_CLOSE) {
             next_token();
           } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `=` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       table_prop->tableProperty.prop = prop;
       return table_prop;
     }
     else if (token_is_nonTableKwName(token)) {
       prop = (Ast*)storage->malloc(sizeof(Ast));
       prop->kind = AstEnum::simpleProperty;
-      prop->line_no = token->line_no;
-      prop->column_no = token->column_no;
+      prop->offset = token->offset;
       prop->simpleProperty.is_const = is_const;
       prop->simpleProperty.name = parse_name();
       if (token->klass == TokenClass::EQUAL) {
@@ -2313,27 +2401,30 @@ Ast* Parser::parse_tableProperty()
         if (token->klass == TokenClass::SEMICOLON) {
           next_token();
         } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `=` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       table_prop->tableProperty.prop = prop;
       return table_prop;
     } else assert(0);
 #endif
     else error("%s:%d:%d: error: table property was expected, got `%s`.",
-                source_file, token->line_no, token->column_no, token->lexeme);
+                source_text->filename, source_text->line_no_at(token->offset),
+                source_text->column_no_at(token->offset), token->lexeme);
   }
   else error("%s:%d:%d: error: table property was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_keyElementList()
 {
-  Ast* elems = Ast_keyElementList::allocate(storage);
-  elems->line_no = token->line_no;
-  elems->column_no = token->column_no;
+  Ast* elems = Ast_keyElementList::allocate(ast_storage);
+  elems->offset = token->offset;
   if (token->is_expression()) {
     Ast* ast = parse_keyElement();
     TreeConstructor tree_ctor = {};
@@ -2349,9 +2440,8 @@ Ast* Parser::parse_keyElementList()
 Ast* Parser::parse_keyElement()
 {
   if (token->is_expression()) {
-    Ast* key_elem = Ast_keyElement::allocate(storage);
-    key_elem->line_no = token->line_no;
-    key_elem->column_no = token->column_no;
+    Ast* key_elem = Ast_keyElement::allocate(ast_storage);
+    key_elem->offset = token->offset;
     key_elem->keyElement.expr = parse_expression(1);
     if (token->klass == TokenClass::Colon) {
       next_token();
@@ -2359,21 +2449,23 @@ Ast* Parser::parse_keyElement()
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `:` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return key_elem;
   } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_actionList()
 {
-  Ast* actions = Ast_actionList::allocate(storage);
-  actions->line_no = token->line_no;
-  actions->column_no = token->column_no;
+  Ast* actions = Ast_actionList::allocate(ast_storage);
+  actions->offset = token->offset;
   if (token->is_actionRef()) {
     Ast* ast = parse_actionRef();
     TreeConstructor tree_ctor = {};
@@ -2381,14 +2473,16 @@ Ast* Parser::parse_actionList()
     if (token->klass == TokenClass::Semicolon) {
       next_token();
     } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     while (token->is_actionRef()) {
       ast = parse_actionRef();
       tree_ctor.append_node(&actions->tree, &ast->tree);
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     }
   }
   return actions;
@@ -2397,9 +2491,8 @@ Ast* Parser::parse_actionList()
 Ast* Parser::parse_actionRef()
 {
   if (token->is_nonTypeName()) {
-    Ast* action_ref = Ast_actionRef::allocate(storage);
-    action_ref->line_no = token->line_no;
-    action_ref->column_no = token->column_no;
+    Ast* action_ref = Ast_actionRef::allocate(ast_storage);
+    action_ref->offset = token->offset;
     action_ref->actionRef.name = parse_nonTypeName();
     if (token->klass == TokenClass::ParenthOpen) {
       next_token();
@@ -2408,15 +2501,18 @@ Ast* Parser::parse_actionRef()
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else if (token->klass == TokenClass::ParenthClose) {
         next_token();
       } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     }
     return action_ref;
   } else error("%s:%d:%d: error: non-type name was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2429,8 +2525,7 @@ Ast* Parser::parse_entriesList()
 
   entries = (Ast*)storage->malloc(sizeof(Ast));
   entries->kind = AstEnum::entriesList;
-  entries->line_no = token->line_no;
-  entries->column_no = token->column_no;
+  entries->offset = token->offset;
   if (token_is_keysetExpression(token)) {
     ast = parse_entry();
     tree_ctor.append_node(&entries->tree, &ast->tree);
@@ -2449,8 +2544,7 @@ Ast* Parser::parse_entry()
   if (token_is_keysetExpression(token)) {
     entry = (Ast*)storage->malloc(sizeof(Ast));
     entry->kind = AstEnum::entry;
-    entry->line_no = token->line_no;
-    entry->column_no = token->column_no;
+    entry->offset = token->offset;
     entry->entry.keyset = parse_keysetExpression();
     if (token->klass == TokenClass::COLON) {
       next_token();
@@ -2458,12 +2552,15 @@ Ast* Parser::parse_entry()
       if (token->klass == TokenClass::SEMICOLON) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: `:` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return entry;
   } else error("%s:%d:%d: error: keyset was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2473,9 +2570,8 @@ Ast* Parser::parse_actionDeclaration()
 {
   if (token->klass == TokenClass::Action) {
     next_token();
-    Ast* action_decl = Ast_actionDeclaration::allocate(storage);
-    action_decl->line_no = token->line_no;
-    action_decl->column_no = token->column_no;
+    Ast* action_decl = Ast_actionDeclaration::allocate(ast_storage);
+    action_decl->offset = token->offset;
     if (token->is_name()) {
       action_decl->actionDeclaration.name = parse_name();
       if (token->klass == TokenClass::ParenthOpen) {
@@ -2486,16 +2582,21 @@ Ast* Parser::parse_actionDeclaration()
           if (token->klass == TokenClass::BraceOpen) {
             action_decl->actionDeclaration.stmt = parse_blockStatement();
           } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                       source_file, token->line_no, token->column_no, token->lexeme);
+                       source_text->filename, source_text->line_no_at(token->offset),
+                       source_text->column_no_at(token->offset), token->lexeme);
         } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
       } else error("%s:%d:%d: error: `(` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return action_decl;
   } else error("%s:%d:%d: error: `action` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2510,9 +2611,8 @@ Ast* Parser::parse_variableDeclaration(Ast* type_ref)
     is_const = 1;
   }
   if (token->is_typeRef() || type_ref) {
-    Ast* var_decl = Ast_variableDeclaration::allocate(storage);
-    var_decl->line_no = token->line_no;
-    var_decl->column_no = token->column_no;
+    Ast* var_decl = Ast_variableDeclaration::allocate(ast_storage);
+    var_decl->offset = token->offset;
     var_decl->variableDeclaration.type = type_ref ? type_ref : parse_typeRef();
     if (token->is_name()) {
       var_decl->variableDeclaration.name = parse_name();
@@ -2523,13 +2623,16 @@ Ast* Parser::parse_variableDeclaration(Ast* type_ref)
       if (token->klass == TokenClass::Semicolon) {
         next_token();
       } else error("%s:%d:%d: error: `;` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     var_decl->variableDeclaration.is_const = is_const;
     return var_decl;
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2541,26 +2644,26 @@ Ast* Parser::parse_functionDeclaration(Ast* type_ref)
   Ast* func_decl;
 
   if (token->is_typeOrVoid()) {
-    func_decl = Ast_functionDeclaration::allocate(storage);
-    func_decl->line_no = token->line_no;
-    func_decl->column_no = token->column_no;
+    func_decl = Ast_functionDeclaration::allocate(ast_storage);
+    func_decl->offset = token->offset;
     func_decl->functionDeclaration.proto = parse_functionPrototype(type_ref);
     if (token->klass == TokenClass::BraceOpen) {
       func_decl->functionDeclaration.stmt = parse_blockStatement();
     } else error("%s:%d:%d: error: `{` was expected, got `%s`.",
-                 source_file, token->line_no, token->column_no, token->lexeme);
+                 source_text->filename, source_text->line_no_at(token->offset),
+                 source_text->column_no_at(token->offset), token->lexeme);
     return func_decl;
   } else error("%s:%d:%d: error: type was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_argumentList()
 {
-  Ast* args = Ast_argumentList::allocate(storage);
-  args->line_no = token->line_no;
-  args->column_no = token->column_no;
+  Ast* args = Ast_argumentList::allocate(ast_storage);
+  args->offset = token->offset;
   if (token->is_argument()) {
     Ast* ast = parse_argument();
     TreeConstructor tree_ctor = {};
@@ -2577,31 +2680,29 @@ Ast* Parser::parse_argumentList()
 Ast* Parser::parse_argument()
 {
   if (token->is_argument()) {
-    Ast* arg = Ast_argument::allocate(storage);
-    arg->line_no = token->line_no;
-    arg->column_no = token->column_no;
+    Ast* arg = Ast_argument::allocate(ast_storage);
+    arg->offset = token->offset;
     if (token->is_expression()) {
       arg->argument.arg = parse_expression(1);
       return arg;
     } else if (token->klass == TokenClass::Dontcare) {
       next_token();
-      Ast* dontcare_arg = Ast_dontcare::allocate(storage);
-      dontcare_arg->line_no = token->line_no;
-      dontcare_arg->column_no = token->column_no;
+      Ast* dontcare_arg = Ast_dontcare::allocate(ast_storage);
+      dontcare_arg->offset = token->offset;
       arg->argument.arg = dontcare_arg;
       return arg;
     } else assert(0);
   } else error("%s:%d:%d: error: an argument was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
 
 Ast* Parser::parse_expressionList()
 {
-  Ast* exprs = Ast_expressionList::allocate(storage);
-  exprs->line_no = token->line_no;
-  exprs->column_no = token->column_no;
+  Ast* exprs = Ast_expressionList::allocate(ast_storage);
+  exprs->offset = token->offset;
   if (token->is_expression()) {
     Ast* ast = parse_expression(1);
     TreeConstructor tree_ctor = {};
@@ -2618,46 +2719,44 @@ Ast* Parser::parse_expressionList()
 Ast* Parser::parse_lvalue()
 {
   if (token->is_lvalue()) {
-    Ast* lvalue = Ast_lvalueExpression::allocate(storage);
-    lvalue->line_no = token->line_no;
-    lvalue->column_no = token->column_no;
+    Ast* lvalue = Ast_lvalueExpression::allocate(ast_storage);
+    lvalue->offset = token->offset;
     lvalue->lvalueExpression.expr = parse_nonTypeName();
     while(token->klass == TokenClass::Dot || token->klass == TokenClass::BracketOpen) {
       if (token->klass == TokenClass::Dot) {
         next_token();
-        Ast* expr = Ast_memberSelector::allocate(storage);
-        expr->line_no = token->line_no;
-        expr->column_no = token->column_no;
+        Ast* expr = Ast_memberSelector::allocate(ast_storage);
+        expr->offset = token->offset;
         expr->memberSelector.lhs_expr = lvalue;
         if (token->is_name()) {
           expr->memberSelector.name = parse_name();
         } else error("%s:%d:%d: error: name was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
-        lvalue = Ast_lvalueExpression::allocate(storage);
-        lvalue->line_no = token->line_no;
-        lvalue->column_no = token->column_no;
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
+        lvalue = Ast_lvalueExpression::allocate(ast_storage);
+        lvalue->offset = token->offset;
         lvalue->lvalueExpression.expr = expr;
       }
       else if (token->klass == TokenClass::BracketOpen) {
         next_token();
-        Ast* expr = Ast_arraySubscript::allocate(storage);
-        expr->line_no = token->line_no;
-        expr->column_no = token->column_no;
+        Ast* expr = Ast_arraySubscript::allocate(ast_storage);
+        expr->offset = token->offset;
         expr->arraySubscript.lhs_expr = lvalue;
         expr->arraySubscript.index_expr = parse_indexExpression();
         if (token->klass == TokenClass::BracketClose) {
           next_token();
         } else error("%s:%d:%d: error: `]` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
-        lvalue = Ast_lvalueExpression::allocate(storage);
-        lvalue->line_no = token->line_no;
-        lvalue->column_no = token->column_no;
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
+        lvalue = Ast_lvalueExpression::allocate(ast_storage);
+        lvalue->offset = token->offset;
         lvalue->lvalueExpression.expr = expr;
       }
     }
     return lvalue;
   } else error("%s:%d:%d: error: lvalue was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2670,80 +2769,74 @@ Ast* Parser::parse_expression(int priority_threshold)
       if (token->klass == TokenClass::Dot) {
         next_token();
         Ast* expr;
-        expr = Ast_memberSelector::allocate(storage);
-        expr->line_no = token->line_no;
-        expr->column_no = token->column_no;
+        expr = Ast_memberSelector::allocate(ast_storage);
+        expr->offset = token->offset;
         expr->memberSelector.lhs_expr = primary;
         if (token->is_nonTypeName()) {
           expr->memberSelector.name = parse_nonTypeName();
         } else error("%s:%d:%d: error: non-type name was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
-        primary = Ast_expression::allocate(storage);
-        primary->line_no = expr->line_no;
-        primary->column_no = expr->column_no;
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
+        primary = Ast_expression::allocate(ast_storage);
+        primary->offset = expr->offset;
         primary->expression.expr = expr;
       } else if (token->klass == TokenClass::BracketOpen) {
         next_token();
-        Ast* expr = Ast_arraySubscript::allocate(storage);
-        expr->line_no = token->line_no;
-        expr->column_no = token->column_no;
+        Ast* expr = Ast_arraySubscript::allocate(ast_storage);
+        expr->offset = token->offset;
         expr->arraySubscript.lhs_expr = primary;
         expr->arraySubscript.index_expr = parse_indexExpression();
         if (token->klass == TokenClass::BracketClose) {
           next_token();
         } else error("%s:%d:%d: error: `]` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
-        primary = Ast_expression::allocate(storage);
-        primary->line_no = expr->line_no;
-        primary->column_no = expr->column_no;
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
+        primary = Ast_expression::allocate(ast_storage);
+        primary->offset = expr->offset;
         primary->expression.expr = expr;
       } else if (token->klass == TokenClass::ParenthOpen) {
         next_token();
-        Ast* expr = Ast_functionCall::allocate(storage);
-        expr->line_no = token->line_no;
-        expr->column_no = token->column_no;
+        Ast* expr = Ast_functionCall::allocate(ast_storage);
+        expr->offset = token->offset;
         expr->functionCall.lhs_expr = primary;
         expr->functionCall.args = parse_argumentList();
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
-        primary = Ast_expression::allocate(storage);
-        primary->line_no = expr->line_no;
-        primary->column_no = expr->column_no;
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
+        primary = Ast_expression::allocate(ast_storage);
+        primary->offset = expr->offset;
         primary->expression.expr = expr;
       } else if (token->klass == TokenClass::Equal) {
         next_token();
-        Ast* expr = Ast_assignmentStatement::allocate(storage);
-        expr->line_no = token->line_no;
-        expr->column_no = token->column_no;
+        Ast* expr = Ast_assignmentStatement::allocate(ast_storage);
+        expr->offset = token->offset;
         expr->assignmentStatement.lhs_expr = primary;
         expr->assignmentStatement.rhs_expr = parse_expression(1);
-        primary = Ast_expression::allocate(storage);
-        primary->line_no = expr->line_no;
-        primary->column_no = expr->column_no;
+        primary = Ast_expression::allocate(ast_storage);
+        primary->offset = expr->offset;
         primary->expression.expr = expr;
       } else if (token->is_binaryOperator()){
         int priority = operator_priority(token);
         if (priority >= priority_threshold) {
-          Ast* expr = Ast_binaryExpression::allocate(storage);
-          expr->line_no = token->line_no;
-          expr->column_no = token->column_no;
+          Ast* expr = Ast_binaryExpression::allocate(ast_storage);
+          expr->offset = token->offset;
           expr->binaryExpression.left_operand = primary;
           expr->binaryExpression.op = token_to_binop(token);
           expr->binaryExpression.strname = token->lexeme;
           next_token();
           expr->binaryExpression.right_operand = parse_expression(priority + 1);
-          primary = Ast_expression::allocate(storage);
-          primary->line_no = expr->line_no;
-          primary->column_no = expr->column_no;
+          primary = Ast_expression::allocate(ast_storage);
+          primary->offset = expr->offset;
           primary->expression.expr = expr;
         } else break;
       } else assert(0);
     }
     return primary;
   } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2751,9 +2844,8 @@ Ast* Parser::parse_expression(int priority_threshold)
 Ast* Parser::parse_expressionPrimary()
 {
   if (token->is_expression()) {
-    Ast* primary = Ast_expression::allocate(storage);
-    primary->line_no = token->line_no;
-    primary->column_no = token->column_no;
+    Ast* primary = Ast_expression::allocate(ast_storage);
+    primary->offset = token->offset;
     if (token->klass == TokenClass::IntegerLiteral) {
       primary->expression.expr = parse_integer();
       return primary;
@@ -2772,7 +2864,8 @@ Ast* Parser::parse_expressionPrimary()
         primary->expression.expr = parse_typeName();
         return primary;
       } else error("%s:%d:%d: error: unexpected token `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       assert(0);
     } else if (token->is_nonTypeName()) {
       primary->expression.expr = parse_nonTypeName();
@@ -2783,7 +2876,8 @@ Ast* Parser::parse_expressionPrimary()
       if (token->klass == TokenClass::BraceClose) {
         next_token();
       } else error("%s:%d:%d: error: `}` was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       return primary;
     } else if (token->klass == TokenClass::ParenthOpen) {
       next_token();
@@ -2793,18 +2887,19 @@ Ast* Parser::parse_expressionPrimary()
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
         return primary;
       } else if (token->is_typeRef()) {
-        Ast* expr = Ast_castExpression::allocate(storage);
-        expr->line_no = token->line_no;
-        expr->column_no = token->column_no;
+        Ast* expr = Ast_castExpression::allocate(ast_storage);
+        expr->offset = token->offset;
         expr->castExpression.type = parse_typeRef();
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
           expr->castExpression.expr = parse_expression(10);
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
         primary->expression.expr = expr;
         return primary;
       } else if (token->is_expression()) {
@@ -2812,16 +2907,17 @@ Ast* Parser::parse_expressionPrimary()
         if (token->klass == TokenClass::ParenthClose) {
           next_token();
         } else error("%s:%d:%d: error: `)` was expected, got `%s`.",
-                     source_file, token->line_no, token->column_no, token->lexeme);
+                     source_text->filename, source_text->line_no_at(token->offset),
+                     source_text->column_no_at(token->offset), token->lexeme);
         return primary;
       } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
       assert(0);
     } else if (token->klass == TokenClass::Exclamation) {
       next_token();
-      Ast* expr = Ast_unaryExpression::allocate(storage);
-      expr->line_no = token->line_no;
-      expr->column_no = token->column_no;
+      Ast* expr = Ast_unaryExpression::allocate(ast_storage);
+      expr->offset = token->offset;
       expr->unaryExpression.op = AstOperator::Not;
       expr->unaryExpression.strname = token->lexeme;
       expr->unaryExpression.operand = parse_expression(1);
@@ -2829,9 +2925,8 @@ Ast* Parser::parse_expressionPrimary()
       return primary;
     } else if (token->klass == TokenClass::Tilda) {
       next_token();
-      Ast* expr = Ast_unaryExpression::allocate(storage);
-      expr->line_no = token->line_no;
-      expr->column_no = token->column_no;
+      Ast* expr = Ast_unaryExpression::allocate(ast_storage);
+      expr->offset = token->offset;
       expr->unaryExpression.op = AstOperator::BitwNot;
       expr->unaryExpression.strname = token->lexeme;
       expr->unaryExpression.operand = parse_expression(1);
@@ -2839,9 +2934,8 @@ Ast* Parser::parse_expressionPrimary()
       return primary;
     } else if (token->klass == TokenClass::UnaryMinus) {
       next_token();
-      Ast* expr = Ast_unaryExpression::allocate(storage);
-      expr->line_no = token->line_no;
-      expr->column_no = token->column_no;
+      Ast* expr = Ast_unaryExpression::allocate(ast_storage);
+      expr->offset = token->offset;
       expr->unaryExpression.op = AstOperator::Neg;
       expr->unaryExpression.strname = token->lexeme;
       expr->unaryExpression.operand = parse_expression(1);
@@ -2852,16 +2946,16 @@ Ast* Parser::parse_expressionPrimary()
       return primary;
     } else if (token->klass == TokenClass::Error) {
       next_token();
-      Ast* expr = Ast_name::allocate(storage);
-      expr->line_no = token->line_no;
-      expr->column_no = token->column_no;
-      expr->name.strname = "error";
+      Ast* expr = Ast_name::allocate(ast_storage);
+      expr->offset = token->offset;
+      expr->name.strname = atom::intern("error");
       primary->expression.expr = expr;
       return primary;
     } else assert(0);
     assert(0);
   } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2869,20 +2963,21 @@ Ast* Parser::parse_expressionPrimary()
 Ast* Parser::parse_indexExpression()
 {
   if (token->is_expression()) {
-    Ast* index_expr = Ast_indexExpression::allocate(storage);
-    index_expr->line_no = token->line_no;
-    index_expr->column_no = token->column_no;
+    Ast* index_expr = Ast_indexExpression::allocate(ast_storage);
+    index_expr->offset = token->offset;
     index_expr->indexExpression.start_index = parse_expression(1);
     if (token->klass == TokenClass::Colon) {
       next_token();
       if (token->is_expression()) {
         index_expr->indexExpression.end_index = parse_expression(1);
       } else error("%s:%d:%d: error: expression was expected, got `%s`.",
-                   source_file, token->line_no, token->column_no, token->lexeme);
+                   source_text->filename, source_text->line_no_at(token->offset),
+                   source_text->column_no_at(token->offset), token->lexeme);
     }
     return index_expr;
   } else error("%s:%d:%d: expression or `:` was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2890,16 +2985,16 @@ Ast* Parser::parse_indexExpression()
 Ast* Parser::parse_integer()
 {
   if (token->klass == TokenClass::IntegerLiteral) {
-    Ast* int_literal = Ast_integerLiteral::allocate(storage);
-    int_literal->line_no = token->line_no;
-    int_literal->column_no = token->column_no;
+    Ast* int_literal = Ast_integerLiteral::allocate(ast_storage);
+    int_literal->offset = token->offset;
     int_literal->integerLiteral.is_signed = token->integer.is_signed;
     int_literal->integerLiteral.width = token->integer.width;
     int_literal->integerLiteral.value = token->integer.value;
     next_token();
     return int_literal;
   } else error("%s:%d:%d: error: integer was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2907,14 +3002,14 @@ Ast* Parser::parse_integer()
 Ast* Parser::parse_boolean()
 {
   if (token->klass == TokenClass::True || token->klass == TokenClass::False) {
-    Ast* bool_literal = Ast_booleanLiteral::allocate(storage);
-    bool_literal->line_no = token->line_no;
-    bool_literal->column_no = token->column_no;
+    Ast* bool_literal = Ast_booleanLiteral::allocate(ast_storage);
+    bool_literal->offset = token->offset;
     bool_literal->booleanLiteral.value = (token->klass == TokenClass::True);
     next_token();
     return bool_literal;
   } else error("%s:%d:%d: error: boolean was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -2922,14 +3017,14 @@ Ast* Parser::parse_boolean()
 Ast* Parser::parse_string()
 {
   if (token->klass == TokenClass::StringLiteral) {
-    Ast* string_literal = Ast_stringLiteral::allocate(storage);
-    string_literal->line_no = token->line_no;
-    string_literal->column_no = token->column_no;
+    Ast* string_literal = Ast_stringLiteral::allocate(ast_storage);
+    string_literal->offset = token->offset;
     string_literal->stringLiteral.value = token->lexeme;
     next_token();
     return string_literal;
   } else error("%s:%d:%d: error: string was expected, got `%s`.",
-               source_file, token->line_no, token->column_no, token->lexeme);
+               source_text->filename, source_text->line_no_at(token->offset),
+               source_text->column_no_at(token->offset), token->lexeme);
   assert(0);
   return 0;
 }
@@ -7,15 +7,15 @@
 
 struct Parser {
   Arena* storage;
-  char* source_file;
-  Array* tokens;
+  Arena* ast_storage;
+  SourceText* source_text;
+  TokenStream* tokens;
 
   Ast* p4program;
 
-  int token_at;
-  int prev_token_at;
+  TokenCursor token_at;
+  Token token_slots[2];
   Token* token;
-  Token* prev_token;
   Scope* current_scope;
   Scope* root_scope;
 
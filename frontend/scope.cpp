@@ -1,13 +1,12 @@
+#include "adt/atom.h"
 #include "frontend/scope.h"
 
 NameEntry Scope::NULL_ENTRY = {};
 
-Scope* Scope::allocate(Arena* storage, int segment_count)
+Scope* Scope::allocate(Arena* storage)
 {
-  assert(segment_count >= 1 && segment_count <= 16);
-
-  Scope* scope = (Scope*)storage->allocate(sizeof(Scope), 1);
-  scope->name_table = Strmap::allocate(storage, segment_count);
+  Scope* scope = storage->allocate<Scope>();
+  scope->name_table = Strmap::allocate(storage, STRMAP_GROUP_SIZE);
   return scope;
 }
 
@@ -45,7 +44,7 @@ NameEntry* Scope::lookup(char* strname, enum NameSpace ns)
 NameDeclaration* Scope::lookup_builtin(char* strname, enum NameSpace ns)
 {
   assert (ns == NameSpace::Var || ns == NameSpace::Type);
-  NameEntry* name_entry = lookup(strname, ns);
+  NameEntry* name_entry = lookup(atom::intern(strname), ns);
   return name_entry->get_declarations(ns);
 }
 
@@ -57,7 +56,7 @@ NameDeclaration* Scope::bind_name(Arena* storage, char* strname, enum NameSpace
   name_decl->strname = strname;
   StrmapEntry* he = name_table->insert(strname, (NameEntry*)0, 1);
   if (he->value == 0) {
-    he->value = (NameEntry*)storage->allocate(sizeof(NameEntry), 1);
+    he->value = storage->allocate<NameEntry>();
   }
   NameEntry* name_entry = (NameEntry*)he->value;
   name_entry->new_declaration(name_decl, ns);
@@ -1,3 +1,6 @@
+#include <memory.h>
+#include "adt/basic.h"
+#include "adt/atom.h"
 #include "frontend/token.h"
 
 bool Token::is_nonTypeName()
@@ -238,3 +241,132 @@ bool Token::is_exprOperator()
                 || klass == TokenClass::AngleOpen;
   return result;
 }
+
+static bool has_lexeme(enum TokenClass klass)
+{
+  return klass == TokenClass::Identifier || klass == TokenClass::StringLiteral
+         || klass == TokenClass::IntegerLiteral;
+}
+
+/**
+ * The lexeme of a token that doesn't have one stored.
+ **/
+static char* TokenClass_spelling(enum TokenClass klass)
+{
+  switch (klass) {
+    case TokenClass::Semicolon: return ";";
+    case TokenClass::AngleOpen: return "<";
+    case TokenClass::AngleClose: return ">";
+    case TokenClass::AngleOpenEqual: return "<=";
+    case TokenClass::AngleCloseEqual: return ">=";
+    case TokenClass::DoubleAngleOpen: return "<<";
+    case TokenClass::DoubleAngleClose: return ">>";
+    case TokenClass::Dontcare: return "_";
+    case TokenClass::Colon: return ":";
+    case TokenClass::ParenthOpen: return "(";
+    case TokenClass::ParenthClose: return ")";
+    case TokenClass::Dot: return ".";
+    case TokenClass::BraceOpen: return "{";
+    case TokenClass::BraceClose: return "}";
+    case TokenClass::BracketOpen: return "[";
+    case TokenClass::BracketClose: return "]";
+    case TokenClass::Comma: return ",";
+    case TokenClass::Minus: return "-";
+    case TokenClass::UnaryMinus: return "-";
+    case TokenClass::Plus: return "+";
+    case TokenClass::Star: return "*";
+    case TokenClass::Slash: return "/";
+    case TokenClass::Equal: return "=";
+    case TokenClass::DoubleEqual: return "==";
+    case TokenClass::Exclamation: return "!";
+    case TokenClass::ExclamationEqual: return "!=";
+    case TokenClass::Ampersand: return "&";
+    case TokenClass::DoubleAmpersand: return "&&";
+    case TokenClass::TripleAmpersand: return "&&&";
+    case TokenClass::Pipe: return "|";
+    case TokenClass::DoublePipe: return "||";
+    case TokenClass::Circumflex: return "^";
+    case TokenClass::Tilda: return "~";
+    case TokenClass::Comment: return "<comment>";
+    case TokenClass::EndOfInput: return "<end-of-input>";
+    case TokenClass::Unknown: return "<unknown>";
+    case TokenClass::LexicalError: return "<error>";
+    default: return 0;
+  }
+}
+
+/* Atoms of the spellings, by token class. */
+static char* token_spellings[256];
+
+TokenStream* TokenStream::allocate(Arena* storage, int text_size)
+{
+  /* The arrays are sized for the usual density of tokens and literals
+   * in P4 source, and move to twice their size when it's exceeded. */
+  TokenStream* stream = storage->allocate<TokenStream>();
+  stream->klasses = FlatArray<uint8_t>::allocate(storage, text_size / 4 + 16);
+  stream->offsets = FlatArray<uint32_t>::allocate(storage, text_size / 4 + 16);
+  stream->lexemes = FlatArray<char*>::allocate(storage, text_size / 8 + 16);
+  stream->integers = FlatArray<TokenInteger>::allocate(storage, text_size / 32 + 16);
+  if (!token_spellings[(int)TokenClass::Semicolon]) {
+    for (int i = 0; i < 256; i++) {
+      char* spelling = TokenClass_spelling((enum TokenClass)i);
+      token_spellings[i] = spelling ? atom::intern(spelling) : 0;
+    }
+  }
+  return stream;
+}
+
+int TokenStream::count()
+{
+  return klasses->element_count;
+}
+
+enum TokenClass TokenStream::klass_at(int i)
+{
+  return (enum TokenClass)*klasses->get(i);
+}
+
+void TokenStream::append(Token* token, uint32_t offset)
+{
+  *klasses->append() = (uint8_t)token->klass;
+  *offsets->append() = offset;
+  if (has_lexeme(token->klass)) {
+    *lexemes->append() = token->lexeme;
+  }
+  if (token->klass == TokenClass::IntegerLiteral) {
+    *integers->append() = token->integer;
+  }
+}
+
+/**
+ * Decodes the token under the cursor.
+ **/
+void TokenStream::read(TokenCursor* at, Token* token)
+{
+  memset(token, 0, sizeof(Token));
+  token->klass = klass_at(at->token_at);
+  token->offset = *offsets->get(at->token_at);
+  if (token->klass == TokenClass::StartOfInput) {
+    return;
+  }
+  if (has_lexeme(token->klass)) {
+    token->lexeme = *lexemes->get(at->lexeme_at);
+  } else {
+    token->lexeme = token_spellings[(int)token->klass];
+  }
+  if (token->klass == TokenClass::IntegerLiteral) {
+    token->integer = *integers->get(at->integer_at);
+  }
+}
+
+void TokenStream::advance(TokenCursor* at)
+{
+  enum TokenClass klass = klass_at(at->token_at);
+  if (has_lexeme(klass)) {
+    at->lexeme_at += 1;
+  }
+  if (klass == TokenClass::IntegerLiteral) {
+    at->integer_at += 1;
+  }
+  at->token_at += 1;
+}
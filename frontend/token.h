@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdint.h>
+#include "memory/arena.h"
+#include "adt/array.h"
 
 enum class TokenClass {
   NONE = 0,
@@ -96,18 +98,19 @@ enum class TokenClass {
   LexicalError,
 };
 
+struct TokenInteger {
+  bool is_signed;
+  int width;
+  int64_t value;
+};
+
 struct Token {
   enum TokenClass klass;
   char* lexeme;
-  int line_no;
-  int column_no;
+  uint32_t offset;
 
   union {
-    struct {
-      bool is_signed;
-      int width;
-      int64_t value;
-    } integer;
+    TokenInteger integer;
     char* str;
   };
 
@@ -147,3 +150,39 @@ struct Token {
   bool is_binaryOperator();
   bool is_exprOperator();
 };
+
+/**
+ * Where a reader is in the token stream, and in each of its side tables.
+ * Indices only, so the cursor stays valid while the columns grow.
+ **/
+struct TokenCursor {
+  int token_at;
+  int lexeme_at;
+  int integer_at;
+};
+
+/**
+ * The lexer's output, stored column-wise. Every token has its class (one byte)
+ * and its offset in the source text. The side tables have an entry only for
+ * the tokens that need one, in token order:
+ *
+ *   lexemes   ...  identifiers, string and integer literals: the atom of the text
+ *   integers  ...  integer literals: width, signedness and value
+ *
+ * The lexeme of any other token follows from its class. A Token is decoded
+ * from the columns as it is read. Its line and column are not: they are
+ * looked up from the offset when needed (see SourceText).
+ **/
+struct TokenStream {
+  FlatArray<uint8_t>* klasses;
+  FlatArray<uint32_t>* offsets;
+  FlatArray<char*>* lexemes;
+  FlatArray<TokenInteger>* integers;
+
+  static TokenStream* allocate(Arena* storage, int text_size);
+  int count();
+  enum TokenClass klass_at(int i);
+  void append(Token* token, uint32_t offset);
+  void read(TokenCursor* at, Token* token);
+  void advance(TokenCursor* at);
+};
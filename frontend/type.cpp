@@ -62,125 +62,125 @@ Type* Type::effective_type()
   return applied_ty;
 }
 
-Type* Type_Basic::append(Array* array, enum TypeEnum basic_type)
+Type* Type_Basic::append(SegmentedArray<Type>* array, enum TypeEnum basic_type)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = basic_type;
   return ty;
 }
 
-Type* Type_Typedef::append(Array* array)
+Type* Type_Typedef::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Typedef;
   return ty;
 }
 
-Type* Type_Struct::append(Array* array)
+Type* Type_Struct::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Struct;
   return ty;
 }
 
-Type* Type_Enum::append(Array* array)
+Type* Type_Enum::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Enum;
   return ty;
 }
 
-Type* Type_Function::append(Array* array)
+Type* Type_Function::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Function;
   return ty;
 }
 
-Type* Type_Extern::append(Array* array)
+Type* Type_Extern::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Extern;
   return ty;
 }
 
-Type* Type_Parser::append(Array* array)
+Type* Type_Parser::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Parser;
   return ty;
 }
 
-Type* Type_Control::append(Array* array)
+Type* Type_Control::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Control;
   return ty;
 }
 
-Type* Type_Table::append(Array* array)
+Type* Type_Table::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Table;
   return ty;
 }
 
-Type* Type_Package::append(Array* array)
+Type* Type_Package::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Package;
   return ty;
 }
 
-Type* Type_HeaderStack::append(Array* array)
+Type* Type_HeaderStack::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Header;
   return ty;
 }
 
-Type* Type_Field::append(Array* array)
+Type* Type_Field::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Field;
   return ty;
 }
 
-Type* Type_State::append(Array* array)
+Type* Type_State::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::State;
   return ty;
 }
 
-Type* Type_Nameref::append(Array* array)
+Type* Type_Nameref::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Nameref;
   return ty;
 }
 
-Type* Type_Type::append(Array* array)
+Type* Type_Type::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Type;
   return ty;
 }
 
-Type* Type_Tuple::append(Array* array)
+Type* Type_Tuple::append(SegmentedArray<Type>* array)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Tuple;
   return ty;
 }
 
-Type* Type_Product::append(Array* array, Arena* storage, int count)
+Type* Type_Product::append(SegmentedArray<Type>* array, Arena* storage, int count)
 {
-  Type* ty = (Type*)array->append();
+  Type* ty = array->append();
   ty->kind = TypeEnum::Product;
   ty->product.count = count;
   if (count > 0) {
-    ty->product.members = (Type**)storage->allocate(sizeof(Type*), count);
+    ty->product.members = storage->allocate<Type*>(count);
   }
   return ty;
 }
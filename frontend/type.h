@@ -41,13 +41,13 @@ struct Type_Basic {
   int size;
   enum TypeEnum basic_type;
 
-  static Type* append(Array* array, enum TypeEnum basic_type);
+  static Type* append(SegmentedArray<Type>* array, enum TypeEnum basic_type);
 };
 
 struct Type_Typedef {
   Type* ref;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Struct {
@@ -55,7 +55,7 @@ struct Type_Struct {
   int field_count;
   int i;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Enum {
@@ -63,21 +63,21 @@ struct Type_Enum {
   int field_count;
   int i;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Function {
   Type* params;
   Type* return_;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Extern {
   Type* methods;
   Type* ctors;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Parser {
@@ -85,7 +85,7 @@ struct Type_Parser {
   Type* ctor_params;
   Type* methods;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Control {
@@ -93,63 +93,63 @@ struct Type_Control {
   Type* ctor_params;
   Type* methods;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Table {
   Type* methods;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Package {
   Type* params;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_HeaderStack {
   Type* element;
   int size;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Field {
   Type* type;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_State {
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Nameref {
   Ast* name;
   struct Scope* scope;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Type {
   Type* type;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 };
 
 struct Type_Tuple {
   Type* left;
   Type* right;
 
-  static Type* append(Array* array);
+  static Type* append(SegmentedArray<Type>* array);
 }; /* 2-tuple */
 
 struct Type_Product {
   Type** members;
   int count;
 
-  static Type* append(Array* array, Arena* storage, int count);
+  static Type* append(SegmentedArray<Type>* array, Arena* storage, int count);
   void set(int i, Type* ty);
   Type* get(int i);
 };
@@ -1,24 +1,182 @@
 #include <unistd.h>
+#include <pthread.h>
 #include <sys/mman.h>
 #include <stdio.h>
-#include <math.h>
+#include <stdlib.h>
 #include <memory.h>
 #include "memory/arena.h"
 
 static Memory memory = {};
 
-PageBlock* PageBlock::find_first_fit(int size)
+/**
+ * Every access to the page pool goes through the pool lock. The lock is
+ * recursive, because growing the descriptor storage re-enters the pool.
+ **/
+struct PoolLock {
+  PoolLock() { pthread_mutex_lock(&memory.pool_mutex); }
+  ~PoolLock() { pthread_mutex_unlock(&memory.pool_mutex); }
+};
+
+/**
+ * Each thread carves its arena pages out of a private chunk, and only
+ * takes the pool lock to refill the chunk.
+ **/
+struct PageCache {
+  uint8_t* memory_begin;
+  uint8_t* memory_end;
+  bool dirty;
+
+  void flush();
+  ~PageCache() { flush(); }
+};
+
+static thread_local PageCache page_cache = {};
+
+static void update_peaks()
 {
-  PageBlock* result = 0;
-  PageBlock* b = memory.block_freelist;
-  while (b) {
-    if ((b->memory_end - b->memory_begin) >= size) {
-      result = b;
+  if (memory.reserved_size > memory.peak_reserved_size) {
+    memory.peak_reserved_size = memory.reserved_size;
+  }
+  if (memory.committed_size > memory.peak_committed_size) {
+    memory.peak_committed_size = memory.committed_size;
+  }
+}
+
+#define PHASE_COUNT_MAX  32
+
+struct PhaseStats {
+  const char* name;
+  uint64_t peak_reserved_size;
+  uint64_t peak_committed_size;
+};
+
+static PhaseStats phases[PHASE_COUNT_MAX];
+static int phase_count = 0;
+
+#if ARENA_PROFILE
+#define PROFILE_COUNTER_MAX  1024
+
+/**
+ * A counter is identified by its category and key, compared by content:
+ * the same __FILE__ or __FUNCTION__ string may have several copies.
+ **/
+struct ProfileCounter {
+  const char* category;
+  const char* key;
+  const char* subkey;
+  uint64_t size;
+  uint64_t count;
+};
+
+static ProfileCounter profile_counters[PROFILE_COUNTER_MAX];
+static int profile_counter_count = 0;
+static Arena* profiled_arenas[PROFILE_COUNTER_MAX];
+static const char* arena_names[PROFILE_COUNTER_MAX];
+static int profiled_arena_count = 0;
+
+static bool match_key(const char* a, const char* b)
+{
+  return (a == b) || (a && b && strcmp(a, b) == 0);
+}
+
+static void count_in(const char* category, const char* key, const char* subkey, uint64_t size)
+{
+  ProfileCounter* counter = 0;
+  for (int i = 0; i < profile_counter_count; i++) {
+    ProfileCounter* c = &profile_counters[i];
+    if (match_key(c->category, category) && match_key(c->key, key) && match_key(c->subkey, subkey)) {
+      counter = c;
       break;
     }
-    b = PageBlock::owner_of(b->link.next);
   }
-  return result;
+  if (!counter) {
+    if (profile_counter_count >= PROFILE_COUNTER_MAX) {
+      return;
+    }
+    counter = &profile_counters[profile_counter_count++];
+    counter->category = category;
+    counter->key = key;
+    counter->subkey = subkey;
+  }
+  counter->size += size;
+  counter->count += 1;
+}
+
+static const char* arena_name(Arena* arena)
+{
+  int i = 0;
+  for (; i < profiled_arena_count; i++) {
+    if (profiled_arenas[i] == arena) {
+      return arena_names[i];
+    }
+  }
+  if (i >= PROFILE_COUNTER_MAX) {
+    return "?";
+  }
+  profiled_arenas[i] = arena;
+  arena_names[i] = "(unnamed)";
+  profiled_arena_count += 1;
+  return arena_names[i];
+}
+
+static void count_allocation(Arena* arena, uint64_t size, const char* site_file, const char* site_function)
+{
+  PoolLock pool_lock;
+  count_in("arena", arena_name(arena), 0, size);
+  count_in("site", site_file, site_function, size);
+}
+
+static int compare_counters(const void* a, const void* b)
+{
+  const ProfileCounter* counter_a = (const ProfileCounter*)a, *counter_b = (const ProfileCounter*)b;
+  if (counter_a->category != counter_b->category) {
+    return strcmp(counter_a->category, counter_b->category);
+  }
+  if (counter_a->size != counter_b->size) {
+    return (counter_a->size > counter_b->size) ? -1 : 1;
+  }
+  return 0;
+}
+#endif
+
+static int floor_log2(uint64_t x)
+{
+  assert(x > 0);
+  return 63 - __builtin_clzll(x);
+}
+
+static int ceil_log2(uint64_t x)
+{
+  assert(x > 0);
+  return (x == 1) ? 0 : 64 - __builtin_clzll(x - 1);
+}
+
+PageBlock* PageBlock::find_first_fit(uint64_t size)
+{
+  uint64_t page_count = (size + memory.page_size - 1) / memory.page_size;
+  if (page_count == 0) {
+    page_count = 1;
+  }
+
+  /* Every block in bin `ceil_log2(page_count)` or higher is large enough. */
+  int k = ceil_log2(page_count);
+  if (k < PAGE_BIN_COUNT) {
+    uint64_t bins = memory.nonempty_bins >> k;
+    if (bins) {
+      return memory.block_bins[k + __builtin_ctzll(bins)];
+    }
+  }
+
+  /* Only the blocks in the bin below may still fit. */
+  int j = floor_log2(page_count);
+  if (j != k) {
+    for (PageBlock* b = memory.block_bins[j]; b != 0; b = PageBlock::owner_of(b->link.next)) {
+      if (b->page_count() >= page_count) {
+        return b;
+      }
+    }
+  }
+  return 0;
 }
 
 void PageBlock::recycle()
@@ -34,89 +192,244 @@ PageBlock* PageBlock::new_block()
   if (block) {
     memory.recycled_blocks = PageBlock::owner_of(block->link.next);
   } else {
-    block = (PageBlock*)memory.block_storage.allocate(sizeof(PageBlock), 1);
+    block = memory.block_storage.allocate<PageBlock>();
   }
   memset(block, 0, sizeof(PageBlock));
   return block;
 }
 
-enum class BlockStitch : int {
-  None  = 0,
-  Left  = 1 << 1,
-  Right = 1 << 2,
-};
-inline BlockStitch operator | (BlockStitch lhs, BlockStitch rhs) {
-  return (BlockStitch)((int)lhs | (int)rhs);
+uint64_t PageBlock::page_count()
+{
+  return (memory_end - memory_begin) / memory.page_size;
+}
+
+int PageBlock::bin_index()
+{
+  return floor_log2(page_count());
 }
-inline BlockStitch operator & (BlockStitch lhs, BlockStitch rhs) {
-  return (BlockStitch)((int)lhs & (int)rhs);
+
+void PageBlock::bin_insert()
+{
+  int k = bin_index();
+  PageBlock* first_block = memory.block_bins[k];
+  link.insert_between(0, first_block ? &first_block->link : 0);
+  memory.block_bins[k] = this;
+  memory.nonempty_bins |= (1ull << k);
 }
 
-PageBlock* PageBlock::insert_and_coalesce(PageBlock* block)
+void PageBlock::bin_remove()
 {
-  if (!this) {
-    return block;
+  int k = bin_index();
+  if (link.prev) {
+    link.prev->next = link.next;
+  } else {
+    memory.block_bins[k] = PageBlock::owner_of(link.next);
+  }
+  if (link.next) {
+    link.next->prev = link.prev;
   }
+  link.next = link.prev = 0;
+  if (!memory.block_bins[k]) {
+    memory.nonempty_bins &= ~(1ull << k);
+  }
+}
 
-  PageBlock* left_neighbour = 0, *right_neighbour = 0;
-  PageBlock* merged_list = this;
-  PageBlock* p = this;
+static PageBlock* rotate_right(PageBlock* root)
+{
+  PageBlock* pivot = root->left_branch;
+  root->left_branch = pivot->right_branch;
+  pivot->right_branch = root;
+  return pivot;
+}
 
-  while (p) {
-    /* Find the left neighbour of block in the ordered list of blocks. */
-    if (p->memory_begin <= block->memory_begin) {
-      left_neighbour = p;
-      break;
+static PageBlock* rotate_left(PageBlock* root)
+{
+  PageBlock* pivot = root->right_branch;
+  root->right_branch = pivot->left_branch;
+  pivot->left_branch = root;
+  return pivot;
+}
+
+PageBlock* PageBlock::tree_insert(PageBlock* root, PageBlock* block)
+{
+  if (!root) {
+    return block;
+  } else if (block->memory_begin < root->memory_begin) {
+    root->left_branch = tree_insert(root->left_branch, block);
+    if (root->left_branch->priority > root->priority) {
+      root = rotate_right(root);
+    }
+  } else {
+    root->right_branch = tree_insert(root->right_branch, block);
+    if (root->right_branch->priority > root->priority) {
+      root = rotate_left(root);
     }
-    p = PageBlock::owner_of(p->link.next);
   }
+  return root;
+}
 
-  /* Insert the block into the list. */
-  if (left_neighbour) {
-    right_neighbour = PageBlock::owner_of(left_neighbour->link.next);
-    left_neighbour->link.next = &block->link;
-    this->link.insert_between(&left_neighbour->link, &right_neighbour->link);
+PageBlock* PageBlock::tree_remove(PageBlock* root, PageBlock* block)
+{
+  assert(root);
+  if (root == block) {
+    if (!root->left_branch) {
+      return root->right_branch;
+    } else if (!root->right_branch) {
+      return root->left_branch;
+    } else if (root->left_branch->priority > root->right_branch->priority) {
+      root = rotate_right(root);
+      root->right_branch = tree_remove(root->right_branch, block);
+    } else {
+      root = rotate_left(root);
+      root->left_branch = tree_remove(root->left_branch, block);
+    }
+  } else if (block->memory_begin < root->memory_begin) {
+    root->left_branch = tree_remove(root->left_branch, block);
   } else {
-    block->link.insert_before(&this->link);
-    right_neighbour = PageBlock::owner_of(block->link.next);
-    merged_list = block;
+    root->right_branch = tree_remove(root->right_branch, block);
   }
+  return root;
+}
+
+void PageBlock::tree_neighbours(uint8_t* address, PageBlock** left/*out*/, PageBlock** right/*out*/)
+{
+  *left = *right = 0;
+  PageBlock* p = memory.block_tree;
+  while (p) {
+    if (p->memory_begin < address) {
+      *left = p;
+      p = p->right_branch;
+    } else {
+      *right = p;
+      p = p->left_branch;
+    }
+  }
+}
+
+void PageBlock::insert_and_coalesce(PageBlock* block)
+{
+  PageBlock* left_neighbour, *right_neighbour;
+  tree_neighbours(block->memory_begin, &left_neighbour, &right_neighbour);
 
-  /* Coalesce adjacent blocks. */
-  enum BlockStitch stitch_op = BlockStitch::None;
   if (left_neighbour && (left_neighbour->memory_end == block->memory_begin)) {
-    stitch_op = (stitch_op | BlockStitch::Left);
+    /* The left neighbour keeps its position in the tree. */
+    left_neighbour->bin_remove();
+    left_neighbour->memory_end = block->memory_end;
+    left_neighbour->dirty |= block->dirty;
+    left_neighbour->retained_size += block->retained_size;
+    block->recycle();
+    block = left_neighbour;
+  } else {
+    block->priority = memory.priority_seed = memory.priority_seed * 1664525 + 1013904223;
+    block->left_branch = block->right_branch = 0;
+    memory.block_tree = tree_insert(memory.block_tree, block);
   }
   if (right_neighbour && (right_neighbour->memory_begin == block->memory_end)) {
-    stitch_op = (stitch_op | BlockStitch::Right);
+    right_neighbour->bin_remove();
+    memory.block_tree = tree_remove(memory.block_tree, right_neighbour);
+    block->memory_end = right_neighbour->memory_end;
+    block->dirty |= right_neighbour->dirty;
+    block->retained_size += right_neighbour->retained_size;
+    right_neighbour->recycle();
   }
+  if (block->retained_size > 0 && block->retained_size >= memory.release_threshold &&
+      memory.release_policy != PageRelease::Keep) {
+    block->return_pages();
+  }
+  block->bin_insert();
+}
 
-  if (stitch_op == (BlockStitch::Left | BlockStitch::Right)) {
-    left_neighbour->memory_end = right_neighbour->memory_end;
-    left_neighbour->link.next= right_neighbour->link.next;
-    if (right_neighbour->link.next) {
-      right_neighbour->link.next->prev = &left_neighbour->link;
-    }
-    right_neighbour->recycle();
-  } else if (stitch_op == BlockStitch::Left) {
-    left_neighbour->memory_end = block->memory_end;
-    left_neighbour->link.next= &right_neighbour->link;
-    if (right_neighbour) {
-      right_neighbour->link.prev = &left_neighbour->link;
-    }
-  } else if (stitch_op == BlockStitch::Right) {
-    right_neighbour->memory_begin = block->memory_begin;
-    right_neighbour->link.prev= &left_neighbour->link;
-    if (left_neighbour) {
-      left_neighbour->link.next = &right_neighbour->link;
-    } else {
-      merged_list = right_neighbour;
+void PageBlock::take_pages(uint64_t size)
+{
+  assert(size <= (uint64_t)(memory_end - memory_begin));
+
+  /* Taking pages from the front doesn't change the block's position in the tree. */
+  bin_remove();
+  memory_begin += size;
+  /* We can't tell where in the block the retained pages are; assume they're taken first. */
+  uint64_t retained_taken = (retained_size < size) ? retained_size : size;
+  retained_size -= retained_taken;
+  memory.retained_size -= retained_taken;
+  memory.committed_size += size;
+  update_peaks();
+  if (memory_begin < memory_end) {
+    bin_insert();
+  } else {
+    memory.block_tree = tree_remove(memory.block_tree, this);
+    recycle();
+  }
+}
+
+/**
+ * The descriptor of the upper part is passed in, taken before the block was
+ * looked up: taking one may grow the descriptor storage, which goes to the pool.
+ **/
+PageBlock* PageBlock::split(uint8_t* address, PageBlock* upper_block)
+{
+  assert(address > memory_begin && address < memory_end);
+  assert(((uintptr_t)address & (memory.page_size - 1)) == 0);
+
+  /* The lower part keeps the descriptor, and with it the position in the tree. */
+  bin_remove();
+  upper_block->memory_begin = address;
+  upper_block->memory_end = memory_end;
+  upper_block->dirty = dirty;
+  memory_end = address;
+  /* As in take_pages, the retained pages are assumed to come first. */
+  uint64_t lower_size = memory_end - memory_begin;
+  uint64_t upper_size = upper_block->memory_end - upper_block->memory_begin;
+  uint64_t lower_retained = (retained_size < lower_size) ? retained_size : lower_size;
+  upper_block->retained_size = retained_size - lower_retained;
+  if (upper_block->retained_size > upper_size) {
+    memory.retained_size -= upper_block->retained_size - upper_size;
+    upper_block->retained_size = upper_size;
+  }
+  retained_size = lower_retained;
+  bin_insert();
+  upper_block->priority = memory.priority_seed = memory.priority_seed * 1664525 + 1013904223;
+  memory.block_tree = tree_insert(memory.block_tree, upper_block);
+  upper_block->bin_insert();
+  return upper_block;
+}
+
+void PageBlock::release(bool dirty)
+{
+  uint64_t size = memory_end - memory_begin;
+  if (ZMEM_ON_FREE && dirty) {
+    memset(memory_begin, 0, size);
+  }
+  if (mprotect(memory_begin, size, PROT_NONE) != 0) {
+    perror("mprotect");
+    exit(1);
+  }
+  this->dirty = dirty;
+  retained_size = dirty ? size : 0;
+  memory.committed_size -= size;
+  memory.retained_size += retained_size;
+  PageBlock::insert_and_coalesce(this);
+}
+
+void PageBlock::return_pages()
+{
+  int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+  if (memory.release_policy == PageRelease::Free) {
+    advice = MADV_FREE;
+  }
+#endif
+  if (madvise(memory_begin, memory_end - memory_begin, advice) != 0) {
+    if (advice == MADV_DONTNEED || madvise(memory_begin, memory_end - memory_begin, MADV_DONTNEED) != 0) {
+      perror("madvise");
+      exit(1);
     }
+    advice = MADV_DONTNEED;  /* MADV_FREE isn't supported by the kernel */
   }
-  if (stitch_op != BlockStitch::None) {
-    block->recycle();
+  if (advice == MADV_DONTNEED) {
+    /* Dropped pages read back as zero. */
+    dirty = false;
   }
-  return merged_list;
+  memory.retained_size -= retained_size;
+  retained_size = 0;
 }
 
 PageBlock* PageBlock::owner_of(List* list)
@@ -124,98 +437,509 @@ PageBlock* PageBlock::owner_of(List* list)
   return ::owner_of(list, &PageBlock::link);
 }
 
-void Arena::grow(uint32_t size)
+/**
+ * The block descriptors grow a page at a time, whatever the granularity of
+ * the pool. Their pages never need aligning, so growing them never splits
+ * a free block, and never needs another descriptor.
+ **/
+static uint64_t grow_granularity(Arena* arena)
 {
-  uint8_t* alloc_memory_begin = 0, *alloc_memory_end = 0;
+  return (arena == &memory.block_storage) ? memory.page_size : memory.grow_granularity;
+}
+
+/**
+ * Takes `size` bytes of committed pages from the pool, starting on a
+ * `granularity` boundary. The pool lock must be held.
+ **/
+static uint8_t* take_free_pages(uint64_t size, uint64_t granularity, bool* dirty/*out*/)
+{
+  /* Aligning the start may split the block. */
+  PageBlock* upper_block = (granularity > memory.page_size) ? PageBlock::new_block() : 0;
 
-  PageBlock* free_block = PageBlock::find_first_fit(size);
+  /* Leave room to align the start of the block to the granularity. */
+  uint64_t fit_size = size + (granularity - memory.page_size);
+  PageBlock* free_block = PageBlock::find_first_fit(fit_size);
   if (!free_block) {
-    printf("\nOut of memory.\n");
-    exit(1);
+    Memory::map_region(fit_size);
+    free_block = PageBlock::find_first_fit(fit_size);
+    assert(free_block);
   }
-  int size_in_page_multiples = (size + memory.page_size - 1) & ~(memory.page_size - 1);
-  if (size_in_page_multiples < (free_block->memory_end - free_block->memory_begin)) {
-    alloc_memory_begin = free_block->memory_begin;
-    alloc_memory_end = alloc_memory_begin + size_in_page_multiples;
-    free_block->memory_begin = alloc_memory_end;
-  } else if (size_in_page_multiples == (free_block->memory_end - free_block->memory_begin)) {
-    alloc_memory_begin = free_block->memory_begin;
-    alloc_memory_end = free_block->memory_end;
-    free_block->memory_begin = alloc_memory_end;
-  } else assert(0);
-
-  if (mprotect(alloc_memory_begin, alloc_memory_end - alloc_memory_begin, PROT_READ|PROT_WRITE) != 0) {
+  uint8_t* aligned_begin = (uint8_t*)(((uintptr_t)free_block->memory_begin + granularity - 1) & ~(uintptr_t)(granularity - 1));
+  if (aligned_begin != free_block->memory_begin) {
+    free_block = free_block->split(aligned_begin, upper_block);
+  } else if (upper_block) {
+    upper_block->recycle();
+  }
+  uint8_t* alloc_memory_begin = free_block->memory_begin;
+  *dirty = free_block->dirty;
+  free_block->take_pages(size);
+
+  if (mprotect(alloc_memory_begin, size, PROT_READ|PROT_WRITE) != 0) {
     perror("mprotect");
     exit(1);
   }
+  return alloc_memory_begin;
+}
+
+void PageCache::flush()
+{
+  if (memory_begin < memory_end) {
+    PoolLock pool_lock;
+    PageBlock* block = PageBlock::new_block();
+    block->memory_begin = memory_begin;
+    block->memory_end = memory_end;
+    block->release(dirty);
+  }
+  memory_begin = memory_end = 0;
+}
+
+void Arena::grow(uint64_t size)
+{
+  uint8_t* alloc_memory_begin = 0, *alloc_memory_end = 0;
+  uint64_t granularity = grow_granularity(this);
+  bool dirty = false;
+
+  uint64_t size_in_page_multiples = (size + granularity - 1) & ~(granularity - 1);
+  if (this == &memory.block_storage || size_in_page_multiples >= PAGE_CACHE_SIZE) {
+    PoolLock pool_lock;
+    alloc_memory_begin = take_free_pages(size_in_page_multiples, granularity, &dirty);
+  } else {
+    PageCache* cache = &page_cache;
+    if ((uint64_t)(cache->memory_end - cache->memory_begin) < size_in_page_multiples) {
+      cache->flush();
+      uint64_t cache_size = (PAGE_CACHE_SIZE + granularity - 1) & ~(granularity - 1);
+      PoolLock pool_lock;
+      cache->memory_begin = take_free_pages(cache_size, granularity, &cache->dirty);
+      cache->memory_end = cache->memory_begin + cache_size;
+    }
+    alloc_memory_begin = cache->memory_begin;
+    cache->memory_begin += size_in_page_multiples;
+    dirty = cache->dirty;
+  }
+  alloc_memory_end = alloc_memory_begin + size_in_page_multiples;
+
   memory_avail = alloc_memory_begin;
   memory_limit = alloc_memory_end;
+  /* Pages that were kept resident still hold what the previous owner left in them. */
+  memory_zero = dirty ? alloc_memory_end : alloc_memory_begin;
 
-  PageBlock* alloc_block = PageBlock::new_block();
-  alloc_block->memory_begin = alloc_memory_begin;
-  alloc_block->memory_end = alloc_memory_end;
-  owned_pages = owned_pages->insert_and_coalesce(alloc_block);
+  if (owned_pages && (owned_pages->memory_end == alloc_memory_begin)) {
+    owned_pages->memory_end = alloc_memory_end;
+  } else {
+    PoolLock pool_lock;
+    PageBlock* alloc_block = PageBlock::new_block();
+    alloc_block->memory_begin = alloc_memory_begin;
+    alloc_block->memory_end = alloc_memory_end;
+    alloc_block->link.next = owned_pages ? &owned_pages->link : 0;
+    owned_pages = alloc_block;
+  }
 }
 
 void Arena::free()
 {
+  PoolLock pool_lock;
   PageBlock* p = owned_pages;
   while (p) {
-    if (ZMEM_ON_FREE) {
-      memset(p->memory_begin, 0, p->memory_end - p->memory_begin);
-    }
-    if (mprotect(p->memory_begin, p->memory_end - p->memory_begin, PROT_NONE) != 0) {
-      perror("mprotect");
-      exit(1);
-    }
     PageBlock* next_block = PageBlock::owner_of(p->link.next);
-    memory.block_freelist = memory.block_freelist->insert_and_coalesce(p);
+    p->release();
     p = next_block;
   }
   memset(this, 0, sizeof(Arena));
 }
 
-void* Arena::allocate(int size, int count)
+ArenaMark Arena::mark()
+{
+  ArenaMark mark = {};
+  mark.owned_pages = owned_pages;
+  mark.memory_avail = memory_avail;
+  mark.memory_limit = memory_limit;
+  return mark;
+}
+
+void Arena::rewind(ArenaMark mark)
+{
+  PoolLock pool_lock;
+
+  /* Release the blocks acquired after the mark. */
+  PageBlock* p = owned_pages;
+  while (p != mark.owned_pages) {
+    assert(p);
+    PageBlock* next_block = PageBlock::owner_of(p->link.next);
+    p->release();
+    p = next_block;
+  }
+  owned_pages = p;
+
+  /* The marked block may have been extended in place since; release the extension. */
+  if (p && (p->memory_end > mark.memory_limit)) {
+    PageBlock* tail_block = PageBlock::new_block();
+    tail_block->memory_begin = mark.memory_limit;
+    tail_block->memory_end = p->memory_end;
+    p->memory_end = mark.memory_limit;
+    tail_block->release();
+  }
+  if (memory_limit != mark.memory_limit) {
+    /* We left the marked block, which may have been used up to its end. */
+    memory_zero = mark.memory_limit;
+  }
+  memory_avail = mark.memory_avail;
+  memory_limit = mark.memory_limit;
+}
+
+ArenaScope::ArenaScope(Arena* arena)
+{
+  this->arena = arena;
+  mark = arena->mark();
+}
+
+ArenaScope::~ArenaScope()
+{
+  arena->rewind(mark);
+}
+
+void* Arena::bump(uint64_t size, uint64_t count, uint64_t alignment)
 {
   assert(count > 0);
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= memory.page_size);
 
-  uint8_t* user_memory = memory_avail;
-  int total_size = size * count;
+  uint8_t* user_memory = (uint8_t*)(((uintptr_t)memory_avail + alignment - 1) & ~(uintptr_t)(alignment - 1));
+  uint64_t total_size = size * count;
   if (user_memory + total_size >= memory_limit) {
     grow(total_size);
-    user_memory = memory_avail;
+    user_memory = memory_avail;  /* page aligned */
   }
   memory_avail = user_memory + total_size;
+  return user_memory;
+}
+
+/**
+ * Commits at least `size` more bytes of pages right after `memory_limit`,
+ * if they are still free. Nothing moves.
+ **/
+bool Arena::extend_pages(uint64_t size)
+{
+  uint64_t granularity = grow_granularity(this);
+  uint8_t* alloc_memory_begin = memory_limit;
+  bool dirty = false;
+
+  if (!owned_pages) {
+    return false;
+  }
+  assert(owned_pages->memory_end == memory_limit);
+  uint64_t size_in_page_multiples = (size + granularity - 1) & ~(granularity - 1);
+  PageCache* cache = &page_cache;
+  if (this != &memory.block_storage && cache->memory_begin == alloc_memory_begin &&
+      (uint64_t)(cache->memory_end - cache->memory_begin) >= size_in_page_multiples) {
+    cache->memory_begin += size_in_page_multiples;
+    dirty = cache->dirty;
+  } else {
+    if (cache->memory_begin == alloc_memory_begin) {
+      /* Too short; back to the pool, where it coalesces with whatever follows. */
+      cache->flush();
+    }
+    PoolLock pool_lock;
+    PageBlock* left_neighbour, *right_neighbour;
+    PageBlock::tree_neighbours(alloc_memory_begin, &left_neighbour, &right_neighbour);
+    if (!right_neighbour || right_neighbour->memory_begin != alloc_memory_begin ||
+        (uint64_t)(right_neighbour->memory_end - right_neighbour->memory_begin) < size_in_page_multiples) {
+      return false;
+    }
+    dirty = right_neighbour->dirty;
+    right_neighbour->take_pages(size_in_page_multiples);
+    if (mprotect(alloc_memory_begin, size_in_page_multiples, PROT_READ|PROT_WRITE) != 0) {
+      perror("mprotect");
+      exit(1);
+    }
+  }
+  memory_limit = alloc_memory_begin + size_in_page_multiples;
+  owned_pages->memory_end = memory_limit;
+  if (dirty) {
+    memory_zero = memory_limit;
+  }
+  return true;
+}
+
+/**
+ * Grows `allocation` from `old_size` to `new_size` bytes,
+ * provided it is the last one made in the arena. The new bytes are zeroed.
+ **/
+bool Arena::try_extend(void* allocation, uint64_t old_size, uint64_t new_size)
+{
+  assert(new_size >= old_size);
+
+  uint8_t* user_memory = (uint8_t*)allocation;
+  if (user_memory + old_size != memory_avail) {
+    return false;
+  }
+  uint8_t* new_avail = user_memory + new_size;
+  if (new_avail >= memory_limit && !extend_pages(new_avail - memory_limit + 1)) {
+    return false;
+  }
+  if (memory_avail < memory_zero) {
+    uint64_t dirty_size = memory_zero - memory_avail;
+    if (dirty_size > new_size - old_size) {
+      dirty_size = new_size - old_size;
+    }
+    memset(memory_avail, 0, dirty_size);
+  }
+  memory_avail = new_avail;
+  if (memory_avail > memory_zero) {
+    memory_zero = memory_avail;
+  }
+  return true;
+}
+
+void* Arena::allocate_uninit(uint64_t size, uint64_t count, uint64_t alignment ARENA_SITE_DECL)
+{
+#if ARENA_PROFILE
+  count_allocation(this, size * count, site_file, site_function);
+#endif
+  uint8_t* user_memory = (uint8_t*)bump(size, count, alignment);
+  if (memory_avail > memory_zero) {
+    memory_zero = memory_avail;
+  }
+  return user_memory;
+}
+
+void* Arena::allocate(uint64_t size, uint64_t count, uint64_t alignment ARENA_SITE_DECL)
+{
+#if ARENA_PROFILE
+  count_allocation(this, size * count, site_file, site_function);
+#endif
+  uint8_t* user_memory = (uint8_t*)bump(size, count, alignment);
   if (ZMEM_ON_ALLOC) {
-    memset(user_memory, 0, total_size);
+    memset(user_memory, 0, size * count);
+  } else if (user_memory < memory_zero) {
+    /* Recycled memory: below the high-water mark of a rewound arena, or in kept pages. */
+    uint64_t dirty_size = memory_zero - user_memory;
+    if (dirty_size > size * count) {
+      dirty_size = size * count;
+    }
+    memset(user_memory, 0, dirty_size);
+  }
+  if (memory_avail > memory_zero) {
+    memory_zero = memory_avail;
   }
   return user_memory;
 }
 
-void Memory::reserve(int amount)
+/**
+ * Maps `size` bytes of address space, aligned to the huge page size
+ * so that the pool can switch to huge pages later on.
+ **/
+static uint8_t* map_aligned(uint64_t size)
 {
+  uint8_t* region = (uint8_t*)mmap(0, size + HUGE_PAGE_SIZE, PROT_NONE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (region == MAP_FAILED) {
+    return 0;
+  }
+  uint8_t* aligned_region = (uint8_t*)(((uintptr_t)region + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+  if (aligned_region > region) {
+    munmap(region, aligned_region - region);
+  }
+  munmap(aligned_region + size, (region + size + HUGE_PAGE_SIZE) - (aligned_region + size));
+  if (memory.huge_pages) {
+    madvise(aligned_region, size, MADV_HUGEPAGE);
+  }
+  return aligned_region;
+}
+
+void Memory::reserve(uint64_t amount)
+{
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&memory.pool_mutex, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+  Memory::name_arena(&memory.block_storage, "block_storage");
+
   memory.page_size = getpagesize();
-  memory.page_count = ceil(amount / memory.page_size);
-  memory.page_memory = (uint8_t*)mmap(0, memory.page_count * memory.page_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-  if (memory.page_memory == MAP_FAILED) {
+  memory.grow_granularity = memory.page_size;
+  memory.region_size = (amount + memory.page_size - 1) & ~(uint64_t)(memory.page_size - 1);
+  memory.page_memory = map_aligned(memory.region_size);
+  if (!memory.page_memory) {
     perror("mmap");
     exit(1);
   }
+  memory.reserved_size = memory.region_size;
+  memory.committed_size = memory.page_size;
+  memory.priority_seed = 1;
+  if (memory.release_threshold == 0) {
+    memory.release_policy = PageRelease::DontNeed;
+    memory.release_threshold = PAGE_RELEASE_THRESHOLD;
+  }
+
+  /* The first page holds the block descriptors. */
   if (mprotect(memory.page_memory, 1 * memory.page_size, PROT_READ | PROT_WRITE) != 0) {
     perror("mprotect");
     exit(1);
   }
-  memory.first_block = (PageBlock*)memory.page_memory;
-  memset(memory.first_block, 0, sizeof(PageBlock));
-  memory.first_block->memory_begin = (uint8_t*)memory.page_memory;
-  memory.first_block->memory_end = memory.first_block->memory_begin + (1 * memory.page_size);
+  memory.block_storage.memory_avail = memory.page_memory;
+  memory.block_storage.memory_limit = memory.page_memory + memory.page_size;
+  PageBlock* first_block = PageBlock::new_block();
+  first_block->memory_begin = memory.page_memory;
+  first_block->memory_end = memory.page_memory + memory.page_size;
+  memory.block_storage.owned_pages = first_block;
+
+  PageBlock* free_block = PageBlock::new_block();
+  free_block->memory_begin = first_block->memory_end;
+  free_block->memory_end = memory.page_memory + memory.region_size;
+  PageBlock::insert_and_coalesce(free_block);
+}
 
-  memory.block_freelist = memory.first_block + 1;
-  memset(memory.block_freelist, 0, sizeof(PageBlock));
-  memory.block_freelist->memory_begin = memory.first_block->memory_end;
-  memory.block_freelist->memory_end = memory.block_freelist->memory_begin + ((memory.page_count - 1) * memory.page_size);
+void Memory::map_region(uint64_t amount)
+{
+  /* Chain another reservation of at least `region_size` bytes onto the page pool.
+   * The extra page leaves room for the block descriptors, in case their storage is full. */
+  uint64_t region_size = (amount + memory.page_size + memory.page_size - 1) & ~(uint64_t)(memory.page_size - 1);
+  if (region_size < memory.region_size) {
+    region_size = memory.region_size;
+  }
+  uint8_t* region = map_aligned(region_size);
+  if (!region) {
+    printf("\nOut of memory.\n");
+    exit(1);
+  }
+  memory.reserved_size += region_size;
+  update_peaks();
+
+  uint8_t* region_begin = region;
+  if (!memory.recycled_blocks &&
+      (memory.block_storage.memory_avail + sizeof(PageBlock) >= memory.block_storage.memory_limit)) {
+    if (mprotect(region, memory.page_size, PROT_READ | PROT_WRITE) != 0) {
+      perror("mprotect");
+      exit(1);
+    }
+    memory.block_storage.memory_avail = region;
+    memory.block_storage.memory_limit = region + memory.page_size;
+    memory.committed_size += memory.page_size;
+    update_peaks();
+    region_begin += memory.page_size;
+  }
+  PageBlock* block = PageBlock::new_block();
+  block->memory_begin = region_begin;
+  block->memory_end = region + region_size;
+  PageBlock::insert_and_coalesce(block);
+}
+
+void Memory::use_huge_pages()
+{
+  PoolLock pool_lock;
+  if (memory.huge_pages) {
+    return;
+  }
+  /* Pages cached at the old granularity would break the alignment. */
+  page_cache.flush();
+  /* The free blocks are advised along with the rest, since they are part of the reservation. */
+  if (madvise(memory.page_memory, memory.region_size, MADV_HUGEPAGE) != 0) {
+    printf("Transparent huge pages are not available, using %d byte pages.\n", memory.page_size);
+    return;
+  }
+  memory.huge_pages = true;
+  memory.grow_granularity = HUGE_PAGE_SIZE;
+}
 
-  memory.block_storage.owned_pages = memory.first_block;
-  memory.block_storage.memory_avail = memory.first_block->memory_begin + 2 * sizeof(PageBlock);
-  memory.block_storage.memory_limit = memory.first_block->memory_end;
-}
\ No newline at end of file
+void Memory::set_release_policy(PageRelease policy, uint64_t threshold)
+{
+  PoolLock pool_lock;
+  memory.release_policy = policy;
+  memory.release_threshold = (threshold > 0) ? threshold : 1;
+}
+
+void Memory::begin_phase(const char* name)
+{
+  PoolLock pool_lock;
+  if (phase_count > 0) {
+    phases[phase_count - 1].peak_reserved_size = memory.peak_reserved_size;
+    phases[phase_count - 1].peak_committed_size = memory.peak_committed_size;
+  }
+  if (phase_count >= PHASE_COUNT_MAX) {
+    return;
+  }
+  phases[phase_count++].name = name;
+  memory.peak_reserved_size = memory.reserved_size;
+  memory.peak_committed_size = memory.committed_size;
+}
+
+void Memory::name_arena(Arena* arena, const char* name)
+{
+#if ARENA_PROFILE
+  PoolLock pool_lock;
+  arena_name(arena);
+  for (int i = 0; i < profiled_arena_count; i++) {
+    if (profiled_arenas[i] == arena) {
+      arena_names[i] = name;
+    }
+  }
+#endif
+}
+
+void Memory::profile_count(const char* category, const char* key, uint64_t size)
+{
+#if ARENA_PROFILE
+  PoolLock pool_lock;
+  count_in(category, key, 0, size);
+#endif
+}
+
+static uint64_t retained_in_tree(PageBlock* block, bool* capped/*out*/)
+{
+  if (!block) {
+    return 0;
+  }
+  if (block->retained_size > (uint64_t)(block->memory_end - block->memory_begin)) {
+    *capped = false;
+  }
+  return block->retained_size + retained_in_tree(block->left_branch, capped) +
+         retained_in_tree(block->right_branch, capped);
+}
+
+/**
+ * Whether the retained memory of the free blocks adds up to the pool's count,
+ * with no block retaining more than its own size. For tests.
+ **/
+bool Memory::check_retained()
+{
+  PoolLock pool_lock;
+  bool capped = true;
+  uint64_t retained_size = retained_in_tree(memory.block_tree, &capped);
+  return capped && retained_size == memory.retained_size;
+}
+
+void Memory::print_report()
+{
+  PoolLock pool_lock;
+  if (phase_count > 0) {
+    phases[phase_count - 1].peak_reserved_size = memory.peak_reserved_size;
+    phases[phase_count - 1].peak_committed_size = memory.peak_committed_size;
+  }
+  printf("\n%-32s %14s %14s\n", "phase", "peak reserved", "peak committed");
+  for (int i = 0; i < phase_count; i++) {
+    printf("%-32s %11lu KB %11lu KB\n", phases[i].name,
+           phases[i].peak_reserved_size / KILOBYTE, phases[i].peak_committed_size / KILOBYTE);
+  }
+  printf("\nreserved:  %lu KB\n", memory.reserved_size / KILOBYTE);
+  printf("committed: %lu KB\n", memory.committed_size / KILOBYTE);
+  printf("retained:  %lu KB\n", memory.retained_size / KILOBYTE);
+#if ARENA_PROFILE
+  qsort(profile_counters, profile_counter_count, sizeof(ProfileCounter), compare_counters);
+  const char* category = 0;
+  for (int i = 0; i < profile_counter_count; i++) {
+    ProfileCounter* counter = &profile_counters[i];
+    if (counter->category != category) {
+      category = counter->category;
+      printf("\n%-56s %14s %10s\n", category, "bytes", "objects");
+    }
+    if (counter->subkey) {
+      char site[256];
+      snprintf(site, sizeof(site), "%s:%s", counter->key, counter->subkey);
+      printf("%-56s %14lu %10lu\n", site, counter->size, counter->count);
+    } else {
+      printf("%-56s %14lu %10lu\n", counter->key, counter->size, counter->count);
+    }
+  }
+#else
+  printf("\n(Per-arena and per-site counters need a build with -DARENA_PROFILE=ON.)\n");
+#endif
+}
@@ -1,44 +1,192 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
+#include <pthread.h>
 #include <memory.h>
 #include "adt/basic.h"
 #include "adt/list.h"
 
 #define ZMEM_ON_FREE  0
-#define ZMEM_ON_ALLOC 1
+
+/**
+ * Clear every allocation, instead of only the memory below `memory_zero`.
+ * For comparison, see bench_parse_time_memset.
+ **/
+#ifndef ZMEM_ON_ALLOC
+#define ZMEM_ON_ALLOC  0
+#endif
+
+/**
+ * Profiling builds (-DARENA_PROFILE=ON) count the bytes and objects
+ * allocated per arena, per call site and per category (see Memory::profile_count).
+ * The call site is passed down through default arguments.
+ **/
+#ifndef ARENA_PROFILE
+#define ARENA_PROFILE  0
+#endif
+
+#if ARENA_PROFILE
+#define ARENA_SITE_PARAMS  , const char* site_file = __builtin_FILE(), const char* site_function = __builtin_FUNCTION()
+#define ARENA_SITE_DECL    , const char* site_file, const char* site_function
+#define ARENA_SITE_ARGS    , site_file, site_function
+#else
+#define ARENA_SITE_PARAMS
+#define ARENA_SITE_DECL
+#define ARENA_SITE_ARGS
+#endif
+
+/* Untyped allocations are aligned for any fundamental type. */
+#define ARENA_ALIGNMENT  alignof(max_align_t)
+#define CACHE_LINE_SIZE  64
+
+/**
+ * Free blocks are binned by their size in pages:
+ *
+ *   bin k  ...  [2^k, 2^(k+1)) pages
+ *
+ * and are also kept in an address-ordered tree (a treap), which finds
+ * the neighbours of a released block for coalescing.
+ **/
+#define PAGE_BIN_COUNT 64
+
+/**
+ * What happens to the physical pages behind a released block:
+ *
+ *   Keep      ...  they stay resident, to be reused (and zeroed) by the next arena.
+ *   DontNeed  ...  they are dropped, and read back as zero.
+ *   Free      ...  the kernel may reclaim them lazily (MADV_FREE), contents undefined.
+ *
+ * Free blocks holding less than the threshold of retained memory are kept,
+ * until coalescing grows them past it.
+ **/
+enum class PageRelease : int {
+  Keep = 0,
+  DontNeed,
+  Free,
+};
+#define PAGE_RELEASE_THRESHOLD  (64 * KILOBYTE)
+
+/**
+ * In huge page mode the reservation is advised MADV_HUGEPAGE, and arenas
+ * grow in aligned multiples of the huge page size, so that the kernel can
+ * back them with transparent huge pages.
+ **/
+#define HUGE_PAGE_SIZE  (2 * MEGABYTE)
+
+/* Arenas refill from a per-thread chunk of this size, see PageCache. */
+#define PAGE_CACHE_SIZE  (256 * KILOBYTE)
 
 struct PageBlock {
   List link;
   uint8_t* memory_begin;
   uint8_t* memory_end;
+  PageBlock* left_branch;
+  PageBlock* right_branch;
+  uint32_t priority;
+  bool dirty;
+  uint64_t retained_size;
 
-  static PageBlock* find_first_fit(int size);
+  static PageBlock* find_first_fit(uint64_t size);
   static PageBlock* new_block();
   void recycle();
-  PageBlock* insert_and_coalesce(PageBlock* block);
+  static void insert_and_coalesce(PageBlock* block);
+  void release(bool dirty = true);
+  void return_pages();
+  void take_pages(uint64_t size);
+  PageBlock* split(uint8_t* address, PageBlock* upper_block);
+  uint64_t page_count();
+  int bin_index();
+  void bin_insert();
+  void bin_remove();
+  static PageBlock* tree_insert(PageBlock* root, PageBlock* block);
+  static PageBlock* tree_remove(PageBlock* root, PageBlock* block);
+  static void tree_neighbours(uint8_t* address, PageBlock** left/*out*/, PageBlock** right/*out*/);
   static PageBlock* owner_of(List* list);
 };
 
+struct ArenaMark {
+  PageBlock* owned_pages;
+  uint8_t* memory_avail;
+  uint8_t* memory_limit;
+};
+
+/**
+ * An arena belongs to one thread at a time; the page pool behind it is shared.
+ *
+ * Pages come from the pool zero-filled, so only the memory below
+ * `memory_zero` (handed out before a rewind) needs to be cleared again.
+ **/
 struct Arena {
   PageBlock* owned_pages;
   uint8_t* memory_avail;
   uint8_t* memory_limit;
+  uint8_t* memory_zero;
 
-  void grow(uint32_t size);
+  void grow(uint64_t size);
   void free();
-  void* allocate(int size, int count);
+  void* bump(uint64_t size, uint64_t count, uint64_t alignment);
+  bool extend_pages(uint64_t size);
+  bool try_extend(void* allocation, uint64_t old_size, uint64_t new_size);
+  void* allocate(uint64_t size, uint64_t count, uint64_t alignment = ARENA_ALIGNMENT ARENA_SITE_PARAMS);
+  void* allocate_uninit(uint64_t size, uint64_t count, uint64_t alignment = ARENA_ALIGNMENT ARENA_SITE_PARAMS);
+  ArenaMark mark();
+  void rewind(ArenaMark mark);
+
+  template<class T> T* allocate(uint64_t count = 1 ARENA_SITE_PARAMS) {
+    return (T*)allocate(sizeof(T), count, alignof(T) ARENA_SITE_ARGS);
+  }
+
+  template<class T> T* allocate(uint64_t count, uint64_t alignment ARENA_SITE_PARAMS) {
+    return (T*)allocate(sizeof(T), count, alignment > alignof(T) ? alignment : alignof(T) ARENA_SITE_ARGS);
+  }
+
+  template<class T> T* allocate_uninit(uint64_t count ARENA_SITE_PARAMS) {
+    return (T*)allocate_uninit(sizeof(T), count, alignof(T) ARENA_SITE_ARGS);
+  }
+};
+
+/**
+ * Rewinds the arena to where it was when the scope was entered,
+ * releasing everything allocated inside the scope.
+ **/
+struct ArenaScope {
+  Arena* arena;
+  ArenaMark mark;
+
+  ArenaScope(Arena* arena);
+  ~ArenaScope();
 };
 
 struct Memory
 {
+  pthread_mutex_t pool_mutex;
   int page_size;
-  int page_count;
+  uint64_t region_size;
+  uint64_t reserved_size;
+  uint64_t committed_size;
+  uint64_t retained_size;
+  PageRelease release_policy;
+  uint64_t release_threshold;
+  uint64_t grow_granularity;
+  bool huge_pages;
+  uint64_t peak_reserved_size;
+  uint64_t peak_committed_size;
   uint8_t* page_memory;
   Arena block_storage;
-  PageBlock* first_block;
-  PageBlock* block_freelist;
   PageBlock* recycled_blocks;
+  PageBlock* block_bins[PAGE_BIN_COUNT];
+  uint64_t nonempty_bins;
+  PageBlock* block_tree;
+  uint32_t priority_seed;
 
-  static void reserve(int amount);
+  static void reserve(uint64_t amount);
+  static void map_region(uint64_t amount);
+  static void use_huge_pages();
+  static void set_release_policy(PageRelease policy, uint64_t threshold);
+  static void begin_phase(const char* name);
+  static void name_arena(Arena* arena, const char* name);
+  static void profile_count(const char* category, const char* key, uint64_t size);
+  static void print_report();
+  static bool check_retained();
 };
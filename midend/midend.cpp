@@ -2,18 +2,22 @@
 
 void Midend::do_analysis(Arena* storage, Arena* scratch,
        SourceText* source_text, Frontend* frontend) {
+  Memory::begin_phase("Midend::type_checker");
   type_checker.allocate(storage);
 
+  Memory::begin_phase("Midend::builtin_methods");
   builtin_methods.storage = storage;
   builtin_methods.p4program = frontend->p4program;
   builtin_methods.do_pass();
 
+  Memory::begin_phase("Midend::scope_hierarchy");
   scope_hierarchy.storage = storage;
   scope_hierarchy.p4program = frontend->p4program;
   scope_hierarchy.root_scope = frontend->root_scope;
   scope_hierarchy.do_pass();
   scope_map = scope_hierarchy.scope_map;
 
+  Memory::begin_phase("Midend::name_binding");
   name_binding.storage = storage;
   name_binding.p4program = frontend->p4program;
   name_binding.root_scope = frontend->root_scope;
@@ -22,8 +26,9 @@ void Midend::do_analysis(Arena* storage, Arena* scratch,
   decl_map = name_binding.decl_map;
   type_array = name_binding.type_array;
 
+  Memory::begin_phase("Midend::declared_types");
   declared_types.storage = storage;
-  declared_types.source_file = source_text->filename;
+  declared_types.source_text = source_text;
   declared_types.p4program = frontend->p4program;
   declared_types.root_scope = frontend->root_scope;
   declared_types.scope_map = scope_map;
@@ -32,8 +37,10 @@ void Midend::do_analysis(Arena* storage, Arena* scratch,
   declared_types.do_pass();
   type_env = declared_types.type_env;
 
+  Memory::begin_phase("Midend::potential_types");
   potential_types.storage = storage;
-  potential_types.source_file = source_text->filename;
+  potential_types.scratch = scratch;
+  potential_types.source_text = source_text;
   potential_types.p4program = frontend->p4program;
   potential_types.root_scope = frontend->root_scope;
   potential_types.scope_map = scope_map;
@@ -42,8 +49,9 @@ void Midend::do_analysis(Arena* storage, Arena* scratch,
   potential_types.do_pass();
   po_type_map = potential_types.po_type_map;
 
+  Memory::begin_phase("Midend::select_type");
   select_type.storage = storage;
-  select_type.source_file = source_text->filename;
+  select_type.source_text = source_text;
   select_type.p4program = frontend->p4program;
   select_type.root_scope = frontend->root_scope;
   select_type.scope_map = scope_map;
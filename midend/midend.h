@@ -1,6 +1,5 @@
 #pragma once
 
-#include "adt/map.h"
 #include "adt/array.h"
 #include "frontend/lexer.h"
 #include "frontend/frontend.h"
@@ -13,11 +12,11 @@
 #include "midend/passes/select_type.h"
 
 struct Midend {
-  Map* scope_map;
-  Map* decl_map;
-  Array* type_array;
-  Map* type_env;
-  Map* po_type_map;
+  AstAttribute<Scope*>* scope_map;
+  AstAttribute<NameDeclaration*>* decl_map;
+  SegmentedArray<Type>* type_array;
+  AstAttribute<Type*>* type_env;
+  AstAttribute<PotentialType*>* po_type_map;
 
   BuiltinMethodsPass builtin_methods;
   ScopeHierarchyPass scope_hierarchy;
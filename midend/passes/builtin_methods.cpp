@@ -1,4 +1,5 @@
 #include "adt/basic.h"
+#include "adt/atom.h"
 #include "frontend/ast.h"
 #include "midend/passes/builtin_methods.h"
 
@@ -112,19 +113,18 @@ void BuiltinMethodsPass::visit_parserTypeDeclaration(Ast* type_decl)
 {
   assert(type_decl->kind == AstEnum::parserTypeDeclaration);
   Ast* return_type = Ast_baseTypeVoid::allocate(storage);
-  return_type->name.strname = "void";
+  return_type->name.strname = atom::intern("void");
 
   Ast* type_ref = Ast_typeRef::allocate(storage);
   type_ref->typeRef.type = return_type;
 
   Ast* method = Ast_functionPrototype::allocate(storage);
-  method->line_no = type_decl->line_no;
-  method->column_no = type_decl->column_no;
+  method->offset = type_decl->offset;
   method->functionPrototype.return_type = type_ref;
   method->functionPrototype.params = type_decl->parserTypeDeclaration.params->clone(storage);
 
   Ast* name = Ast_name::allocate(storage);
-  name->name.strname = "apply";
+  name->name.strname = atom::intern("apply");
   method->functionPrototype.name = name;
 
   Ast* method_protos = type_decl->parserTypeDeclaration.method_protos;
@@ -300,19 +300,18 @@ void BuiltinMethodsPass::visit_controlTypeDeclaration(Ast* type_decl)
   assert(type_decl->kind == AstEnum::controlTypeDeclaration);
 
   Ast* return_type = Ast_baseTypeVoid::allocate(storage);
-  return_type->name.strname = "void";
+  return_type->name.strname = atom::intern("void");
 
   Ast* type_ref = Ast_typeRef::allocate(storage);
   type_ref->typeRef.type = return_type;
 
   Ast* method = Ast_functionPrototype::allocate(storage);
-  method->line_no = type_decl->line_no;
-  method->column_no = type_decl->column_no;
+  method->offset = type_decl->offset;
   method->functionPrototype.return_type = type_ref;
   method->functionPrototype.params = type_decl->controlTypeDeclaration.params->clone(storage);
 
   Ast* name = Ast_name::allocate(storage);
-  name->name.strname = "apply";
+  name->name.strname = atom::intern("apply");
   method->functionPrototype.name = name;
 
   Ast* method_protos = type_decl->controlTypeDeclaration.method_protos;
@@ -790,23 +789,21 @@ void BuiltinMethodsPass::visit_tableDeclaration(Ast* table_decl)
   assert(table_decl->kind == AstEnum::tableDeclaration);
 
   Ast* return_type = Ast_baseTypeVoid::allocate(storage);
-  return_type->name.strname = "void";
+  return_type->name.strname = atom::intern("void");
 
   Ast* type_ref = Ast_typeRef::allocate(storage);
   type_ref->typeRef.type = return_type;
 
   Ast* method = Ast_functionPrototype::allocate(storage);
-  method->line_no = table_decl->line_no;
-  method->column_no = table_decl->column_no;
+  method->offset = table_decl->offset;
   method->functionPrototype.return_type = type_ref;
 
   Ast* params = Ast_parameterList::allocate(storage);
-  params->line_no = table_decl->line_no;
-  params->column_no = table_decl->column_no;
+  params->offset = table_decl->offset;
   method->functionPrototype.params = params;
 
   Ast* name = Ast_name::allocate(storage);
-  name->name.strname = "apply";
+  name->name.strname = atom::intern("apply");
   method->functionPrototype.name = name;
 
   Ast* method_protos = table_decl->tableDeclaration.method_protos;
@@ -1,6 +1,6 @@
 #include <stdio.h>
 #include "adt/basic.h"
-#include "adt/cstring.h"
+#include "adt/atom.h"
 #include "midend/type_checker.h"
 #include "midend/passes/declared_type.h"
 
@@ -31,9 +31,9 @@ void DeclaredTypePass::define_builtin_types()
   };
 
   for (int i = 0; i < sizeof(base_types) / sizeof(base_types[0]); i++) {
-    NameEntry* name_entry = root_scope->lookup(base_types[i], NameSpace::Type);
+    NameEntry* name_entry = root_scope->lookup(atom::intern(base_types[i]), NameSpace::Type);
     NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-    type_env->insert(name_decl->ast, name_decl->type, 0);
+    type_env->insert(name_decl->ast, name_decl->type);
   }
 
   Ast* ast;
@@ -41,15 +41,15 @@ void DeclaredTypePass::define_builtin_types()
 
   ast = root_scope->lookup_builtin("accept", NameSpace::Var)->ast;
   ty = Type_State::append(type_array);
-  type_env->insert(ast, ty, 0);
+  type_env->insert(ast, ty);
 
   ast = root_scope->lookup_builtin("reject", NameSpace::Var)->ast;
   ty = Type_State::append(type_array);
-  type_env->insert(ast, ty, 0);
+  type_env->insert(ast, ty);
 
   for (int i = 0; i < sizeof(arithmetic_ops) / sizeof(arithmetic_ops[0]); i++) {
     Type* ty = Type_Function::append(type_array);
-    ty->strname = arithmetic_ops[i];
+    ty->strname = atom::intern(arithmetic_ops[i]);
     Type* params_ty = Type_Product::append(type_array, storage, 2);
     params_ty->product.set(0, root_scope->lookup_builtin("int", NameSpace::Type)->type);
     params_ty->product.set(1, root_scope->lookup_builtin("int", NameSpace::Type)->type);
@@ -61,7 +61,7 @@ void DeclaredTypePass::define_builtin_types()
 
   for (int i = 0; i < sizeof(logical_ops) / sizeof(logical_ops[0]); i++) {
     Type* ty = Type_Function::append(type_array);
-    ty->strname = logical_ops[i];
+    ty->strname = atom::intern(logical_ops[i]);
     Type* params_ty = Type_Product::append(type_array, storage, 2);
     params_ty->product.set(0, root_scope->lookup_builtin("bool", NameSpace::Type)->type);
     params_ty->product.set(1, root_scope->lookup_builtin("bool", NameSpace::Type)->type);
@@ -73,7 +73,7 @@ void DeclaredTypePass::define_builtin_types()
 
   for (int i = 0; i < sizeof(relational_ops) / sizeof(relational_ops[0]); i++) {
     Type* ty = Type_Function::append(type_array);
-    ty->strname = relational_ops[i];
+    ty->strname = atom::intern(relational_ops[i]);
     Type* params_ty = Type_Product::append(type_array, storage, 2);
     params_ty->product.set(0, root_scope->lookup_builtin("int", NameSpace::Type)->type);
     params_ty->product.set(1, root_scope->lookup_builtin("int", NameSpace::Type)->type);
@@ -85,7 +85,7 @@ void DeclaredTypePass::define_builtin_types()
 
   for (int i = 0; i < sizeof(bitwise_ops) / sizeof(bitwise_ops[0]); i++) {
     Type* ty = Type_Function::append(type_array);
-    ty->strname = bitwise_ops[i];
+    ty->strname = atom::intern(bitwise_ops[i]);
     Type* params_ty = Type_Product::append(type_array, storage, 2);
     params_ty->product.set(0, root_scope->lookup_builtin("bit", NameSpace::Type)->type);
     params_ty->product.set(1, root_scope->lookup_builtin("bit", NameSpace::Type)->type);
@@ -96,29 +96,53 @@ void DeclaredTypePass::define_builtin_types()
   }
 }
 
-void DEBUG_print_type_env(Map* env)
+/**
+ * Indexes by id the node `ast`, the siblings that follow it and the nodes below them.
+ **/
+static void DEBUG_index_nodes(Ast* ast, Ast** nodes, uint32_t node_count)
 {
-  int i = 0;
-  for (MapEntry* m = env->first; m != 0; m = m->next) {
-    Ast* ast = (Ast*)m->key;
-    Type* ty = (Type*)m->value;
-    if (ty->strname) {
-      printf("[%d] 0x%x %s ... %d:%d\n", i, ty, ty->strname, ast->line_no, ast->column_no);
+  while (ast && ast->id < node_count && !nodes[ast->id]) {
+    nodes[ast->id] = ast;
+    Ast** fields[AST_MAX_FIELDS];
+    int field_count = ast->child_fields(fields);
+    for (int i = 0; i < field_count; i++) {
+      DEBUG_index_nodes(*fields[i], nodes, node_count);
+    }
+    if (ast->tree.first_child) {
+      DEBUG_index_nodes(Ast::owner_of(ast->tree.first_child), nodes, node_count);
+    }
+    ast = ast->tree.right_sibling ? Ast::owner_of(ast->tree.right_sibling) : 0;
+  }
+}
+
+void DEBUG_print_type_env(AstAttribute<Type*>* env, Ast* p4program, SourceText* source_text)
+{
+  /* The table is indexed by node id; find the nodes, for their location. */
+  Arena scratch = {};
+  Ast** nodes = scratch.allocate<Ast*>(env->capacity);
+  DEBUG_index_nodes(p4program, nodes, env->capacity);
+
+  for (uint32_t id = 0; id < env->capacity; id++) {
+    Type* ty = env->values[id];
+    if (!ty) {
+      continue;
+    }
+    Ast* ast = nodes[id];
+    char* strname = ty->strname ? ty->strname : TypeEnum_to_string(ty->kind);
+    if (ast) {
+      printf("[%d] 0x%x %s ... %d:%d\n", id, ty, strname,
+             source_text->line_no_at(ast->offset), source_text->column_no_at(ast->offset));
     } else {
-      if (ast) {
-        printf("[%d] 0x%x %s ... %d:%d\n", i, ty, TypeEnum_to_string(ty->kind), ast->line_no, ast->column_no);
-      } else {
-        printf("[%d] 0x%x %s\n", i, ty, TypeEnum_to_string(ty->kind));
-      }
+      printf("[%d] 0x%x %s\n", id, ty, strname);
     }
-    i += 1;
   }
+  scratch.free();
 }
 
-void DEBUG_print_type_array(Array* type_array)
+void DEBUG_print_type_array(SegmentedArray<Type>* type_array)
 {
   for (int i = 0; i < type_array->element_count; i++) {
-    Type* ty = (Type*)type_array->get(i);
+    Type* ty = type_array->get(i);
     ty = ty->actual_type();
 
     if (ty->strname) {
@@ -131,35 +155,36 @@ void DEBUG_print_type_array(Array* type_array)
 
 void DeclaredTypePass::do_pass()
 {
-  type_env = (Map*)storage->allocate(sizeof(Map), 1);
-  type_env->storage = storage;
+  type_env = AstAttribute<Type*>::allocate(storage, Ast::node_count);
 
   define_builtin_types();
   visit_p4program(p4program);
 
-  for (int i = 0; i < type_array->element_count; i++) {
-    Type* ty = (Type*)type_array->get(i);
+  SegmentedArrayIterator<Type> it(type_array);
+  for (Type* ty = it.next(); ty != 0; ty = it.next()) {
     if (ty->kind == TypeEnum::Nameref) {
       Ast* name = ty->nameref.name;
       NameEntry* name_entry = ty->nameref.scope->lookup(name->name.strname, NameSpace::Type);
       NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
       if (name_decl) {
-        Type* ref_ty = (Type*)type_env->lookup(name_decl->ast, 0);
+        Type* ref_ty = type_env->lookup(name_decl->ast);
         assert(ref_ty);
         name_decl->type = ref_ty;
         ty->kind = TypeEnum::Type;
         ty->type.type = ref_ty;
         if (name_decl->next_in_scope) {
           error("%s:%d:%d: error: ambiguous type reference `%s`.",
-                source_file, name->line_no, name->column_no, name->name.strname);
+                source_text->filename, source_text->line_no_at(name->offset),
+                source_text->column_no_at(name->offset), name->name.strname);
         }
       } else error("%s:%d:%d: error: unresolved type reference `%s`.",
-                   source_file, name->line_no, name->column_no, name->name.strname);
+                   source_text->filename, source_text->line_no_at(name->offset),
+                   source_text->column_no_at(name->offset), name->name.strname);
     }
   }
 
-  for (int i = 0; i < type_array->element_count; i++) {
-    Type* ty = (Type*)type_array->get(i);
+  it.begin(type_array);
+  for (Type* ty = it.next(); ty != 0; ty = it.next()) {
     if (ty->kind == TypeEnum::Typedef) {
       Type* ref_ty = ty->typedef_.ref->actual_type();
       while (ref_ty->kind == TypeEnum::Typedef) {
@@ -170,8 +195,8 @@ void DeclaredTypePass::do_pass()
     }
   }
 
-  for (int i = 0; i < type_array->element_count; i++) {
-    Type* ty = (Type*)type_array->get(i);
+  it.begin(type_array);
+  for (Type* ty = it.next(); ty != 0; ty = it.next()) {
     if (ty->kind == TypeEnum::Type) {
       Type* ref_ty = ty->type.type->actual_type();
       while (ref_ty->kind == TypeEnum::Type) {
@@ -238,8 +263,8 @@ void DeclaredTypePass::visit_name(Ast* name)
   name_ty->strname = name->name.strname;
   name_ty->ast = name;
   name_ty->nameref.name = name;
-  name_ty->nameref.scope = (Scope*)scope_map->lookup(name, 0);
-  type_env->insert(name, name_ty, 0);
+  name_ty->nameref.scope = scope_map->lookup(name);
+  type_env->insert(name, name_ty);
 }
 
 void DeclaredTypePass::visit_parameterList(Ast* params)
@@ -262,11 +287,11 @@ void DeclaredTypePass::visit_parameterList(Ast* params)
   int i = 0;
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    params_ty->product.set(i, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    params_ty->product.set(i, type_env->lookup(Ast::owner_of(tree)));
     i += 1;
   }
   assert(i == params_ty->product.count);
-  type_env->insert(params, params_ty, 0);
+  type_env->insert(params, params_ty);
 }
 
 void DeclaredTypePass::visit_parameter(Ast* param)
@@ -274,12 +299,12 @@ void DeclaredTypePass::visit_parameter(Ast* param)
   assert(param->kind == AstEnum::parameter);
 
   visit_typeRef(param->parameter.type);
-  Type* param_ty = (Type*)type_env->lookup(param->parameter.type, 0);
-  type_env->insert(param, param_ty, 0);
+  Type* param_ty = type_env->lookup(param->parameter.type);
+  type_env->insert(param, param_ty);
   if (param->parameter.init_expr) {
     visit_expression(param->parameter.init_expr);
   }
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(param, 0);
+  NameDeclaration* name_decl = decl_map->lookup(param);
   name_decl->type = param_ty;
 }
 
@@ -292,9 +317,9 @@ void DeclaredTypePass::visit_packageTypeDeclaration(Ast* type_decl)
   Type* package_ty = Type_Package::append(type_array);
   package_ty->strname = name->name.strname;
   package_ty->ast = type_decl;
-  package_ty->package.params = (Type*)type_env->lookup(type_decl->packageTypeDeclaration.params, 0);
-  type_env->insert(type_decl, package_ty, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(type_decl, 0);
+  package_ty->package.params = type_env->lookup(type_decl->packageTypeDeclaration.params);
+  type_env->insert(type_decl, package_ty);
+  NameDeclaration* name_decl = decl_map->lookup(type_decl);
   name_decl->type = package_ty;
 }
 
@@ -304,9 +329,9 @@ void DeclaredTypePass::visit_instantiation(Ast* inst)
 
   visit_typeRef(inst->instantiation.type);
   visit_argumentList(inst->instantiation.args);
-  Type* inst_ty = (Type*)type_env->lookup(inst->instantiation.type, 0);
-  type_env->insert(inst, inst_ty, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(inst, 0);
+  Type* inst_ty = type_env->lookup(inst->instantiation.type);
+  type_env->insert(inst, inst_ty);
+  NameDeclaration* name_decl = decl_map->lookup(inst);
   name_decl->type = inst_ty;
 }
 
@@ -319,8 +344,8 @@ void DeclaredTypePass::visit_parserDeclaration(Ast* parser_decl)
   visit_typeDeclaration(parser_decl->parserDeclaration.proto);
   if (parser_decl->parserDeclaration.ctor_params) {
     visit_parameterList(parser_decl->parserDeclaration.ctor_params);
-    Type* parser_ty = (Type*)type_env->lookup(parser_decl->parserDeclaration.proto, 0);
-    parser_ty->parser.ctor_params = (Type*)type_env->lookup(parser_decl->parserDeclaration.ctor_params, 0);
+    Type* parser_ty = type_env->lookup(parser_decl->parserDeclaration.proto);
+    parser_ty->parser.ctor_params = type_env->lookup(parser_decl->parserDeclaration.ctor_params);
   }
   visit_parserLocalElements(parser_decl->parserDeclaration.local_elements);
   visit_parserStates(parser_decl->parserDeclaration.states);
@@ -335,12 +360,12 @@ void DeclaredTypePass::visit_parserTypeDeclaration(Ast* type_decl)
   Type* parser_ty = Type_Parser::append(type_array);
   parser_ty->strname = name->name.strname;
   parser_ty->ast = type_decl;
-  parser_ty->parser.params = (Type*)type_env->lookup(type_decl->parserTypeDeclaration.params, 0);
-  type_env->insert(type_decl, parser_ty, 0);
+  parser_ty->parser.params = type_env->lookup(type_decl->parserTypeDeclaration.params);
+  type_env->insert(type_decl, parser_ty);
   visit_methodPrototypes(type_decl->parserTypeDeclaration.method_protos, 0, 0);
-  Type* methods_ty = (Type*)type_env->lookup(type_decl->parserTypeDeclaration.method_protos, 0);
+  Type* methods_ty = type_env->lookup(type_decl->parserTypeDeclaration.method_protos);
   parser_ty->parser.methods = methods_ty;
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(type_decl, 0);
+  NameDeclaration* name_decl = decl_map->lookup(type_decl);
   name_decl->type = parser_ty;
 }
 
@@ -384,8 +409,8 @@ void DeclaredTypePass::visit_parserState(Ast* state)
   state_ty->ast = state;
   visit_parserStatements(state->parserState.stmt_list);
   visit_transitionStatement(state->parserState.transition_stmt);
-  type_env->insert(state, state_ty, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(state, 0);
+  type_env->insert(state, state_ty);
+  NameDeclaration* name_decl = decl_map->lookup(state);
   name_decl->type = state_ty;
 }
 
@@ -508,8 +533,8 @@ void DeclaredTypePass::visit_controlDeclaration(Ast* control_decl) {
   visit_typeDeclaration(control_decl->controlDeclaration.proto);
   if (control_decl->controlDeclaration.ctor_params) {
     visit_parameterList(control_decl->controlDeclaration.ctor_params);
-    Type* control_ty = (Type*)type_env->lookup(control_decl->controlDeclaration.proto, 0);
-    control_ty->control.ctor_params = (Type*)type_env->lookup(control_decl->controlDeclaration.ctor_params, 0);
+    Type* control_ty = type_env->lookup(control_decl->controlDeclaration.proto);
+    control_ty->control.ctor_params = type_env->lookup(control_decl->controlDeclaration.ctor_params);
   }
   visit_controlLocalDeclarations(control_decl->controlDeclaration.local_decls);
   visit_blockStatement(control_decl->controlDeclaration.apply_stmt);
@@ -524,12 +549,12 @@ void DeclaredTypePass::visit_controlTypeDeclaration(Ast* type_decl)
   Type* control_ty = Type_Control::append(type_array);
   control_ty->strname = name->name.strname;
   control_ty->ast = type_decl;
-  control_ty->control.params = (Type*)type_env->lookup(type_decl->packageTypeDeclaration.params, 0);
-  type_env->insert(type_decl, control_ty, 0);
+  control_ty->control.params = type_env->lookup(type_decl->packageTypeDeclaration.params);
+  type_env->insert(type_decl, control_ty);
   visit_methodPrototypes(type_decl->controlTypeDeclaration.method_protos, 0, 0);
-  Type* methods_ty = (Type*)type_env->lookup(type_decl->controlTypeDeclaration.method_protos, 0);
+  Type* methods_ty = type_env->lookup(type_decl->controlTypeDeclaration.method_protos);
   control_ty->control.methods = methods_ty;
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(type_decl, 0);
+  NameDeclaration* name_decl = decl_map->lookup(type_decl);
   name_decl->type = control_ty;
 }
 
@@ -577,14 +602,14 @@ void DeclaredTypePass::visit_externTypeDeclaration(Ast* type_decl)
   Type* extern_ty = Type_Extern::append(type_array);
   extern_ty->strname = name->name.strname;
   extern_ty->ast = type_decl;
-  type_env->insert(type_decl, extern_ty, 0);
+  type_env->insert(type_decl, extern_ty);
   visit_methodPrototypes(type_decl->externTypeDeclaration.method_protos, extern_ty, name->name.strname);
-  Type* methods_ty = (Type*)type_env->lookup(type_decl->externTypeDeclaration.method_protos, 0);
+  Type* methods_ty = type_env->lookup(type_decl->externTypeDeclaration.method_protos);
   extern_ty->extern_.methods = methods_ty;
 
   int count = 0;
   for (int i = 0; i < methods_ty->product.count; i++) {
-    if (cstring::match(methods_ty->product.get(i)->strname, name->name.strname)) {
+    if (atom::match(methods_ty->product.get(i)->strname, name->name.strname)) {
       count += 1;
     }
   }
@@ -593,12 +618,12 @@ void DeclaredTypePass::visit_externTypeDeclaration(Ast* type_decl)
   ctors_ty->ast = type_decl;
 
   for (int i = 0; i < methods_ty->product.count; i++) {
-    if (cstring::match(methods_ty->product.get(i)->strname, name->name.strname)) {
+    if (atom::match(methods_ty->product.get(i)->strname, name->name.strname)) {
       ctors_ty->product.set(i, methods_ty->product.get(i));
     }
   }
   extern_ty->extern_.ctors = ctors_ty;
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(type_decl, 0);
+  NameDeclaration* name_decl = decl_map->lookup(type_decl);
   name_decl->type = extern_ty;
 }
 
@@ -622,11 +647,11 @@ void DeclaredTypePass::visit_methodPrototypes(Ast* protos, Type* ctor_ty, char*
   int i = 0;
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    methods_ty->product.set(i, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    methods_ty->product.set(i, type_env->lookup(Ast::owner_of(tree)));
     i += 1;
   }
   assert(i == methods_ty->product.count);
-  type_env->insert(protos, methods_ty, 0);
+  type_env->insert(protos, methods_ty);
 }
 
 void DeclaredTypePass::visit_functionPrototype(Ast* func_proto, Type* ctor_ty, char* ctor_strname)
@@ -641,15 +666,15 @@ void DeclaredTypePass::visit_functionPrototype(Ast* func_proto, Type* ctor_ty, c
   Type* func_ty = Type_Function::append(type_array);
   func_ty->strname = name->name.strname;
   func_ty->ast = func_proto;
-  func_ty->function.params = (Type*)type_env->lookup(func_proto->functionPrototype.params, 0);
-  type_env->insert(func_proto, func_ty, 0);
+  func_ty->function.params = type_env->lookup(func_proto->functionPrototype.params);
+  type_env->insert(func_proto, func_ty);
   Ast* return_type = func_proto->functionPrototype.return_type;
   if (return_type) {
-    func_ty->function.return_ = (Type*)type_env->lookup(return_type, 0);
-  } else if (cstring::match(name->name.strname, ctor_strname)) {
+    func_ty->function.return_ = type_env->lookup(return_type);
+  } else if (atom::match(name->name.strname, ctor_strname)) {
     func_ty->function.return_ = ctor_ty;
   } else assert(0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(func_proto, 0);
+  NameDeclaration* name_decl = decl_map->lookup(func_proto);
   name_decl->type = func_ty;
 }
 
@@ -680,8 +705,8 @@ void DeclaredTypePass::visit_typeRef(Ast* type_ref)
   } else if (type_ref->typeRef.type->kind == AstEnum::tupleType) {
     visit_tupleType(type_ref->typeRef.type);
   } else assert(0);
-  Type* ref_ty = (Type*)type_env->lookup(type_ref->typeRef.type, 0);
-  type_env->insert(type_ref, ref_ty, 0);
+  Type* ref_ty = type_env->lookup(type_ref->typeRef.type);
+  type_env->insert(type_ref, ref_ty);
 }
 
 void DeclaredTypePass::visit_tupleType(Ast* type_decl)
@@ -689,8 +714,8 @@ void DeclaredTypePass::visit_tupleType(Ast* type_decl)
   assert(type_decl->kind == AstEnum::tupleType);
 
   visit_typeArgumentList(type_decl->tupleType.type_args);
-  Type* tuple_ty = (Type*)type_env->lookup(type_decl->tupleType.type_args, 0);
-  type_env->insert(type_decl, tuple_ty, 0);
+  Type* tuple_ty = type_env->lookup(type_decl->tupleType.type_args);
+  type_env->insert(type_decl, tuple_ty);
 }
 
 void DeclaredTypePass::visit_headerStackType(Ast* type_decl)
@@ -701,15 +726,15 @@ void DeclaredTypePass::visit_headerStackType(Ast* type_decl)
   visit_expression(type_decl->headerStackType.stack_expr);
   Type* stack_ty = Type_HeaderStack::append(type_array);
   stack_ty->ast = type_decl;
-  type_env->insert(type_decl, stack_ty, 0);
-  stack_ty->header_stack.element = (Type*)type_env->lookup(type_decl->headerStackType.type, 0);
+  type_env->insert(type_decl, stack_ty);
+  stack_ty->header_stack.element = type_env->lookup(type_decl->headerStackType.type);
 }
 
 void DeclaredTypePass::visit_baseTypeBoolean(Ast* bool_type)
 {
   assert(bool_type->kind == AstEnum::baseTypeBoolean);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(bool_type, 0);
-  type_env->insert(bool_type, name_decl->type, 0);
+  NameDeclaration* name_decl = decl_map->lookup(bool_type);
+  type_env->insert(bool_type, name_decl->type);
 }
 
 void DeclaredTypePass::visit_baseTypeInteger(Ast* int_type)
@@ -719,8 +744,8 @@ void DeclaredTypePass::visit_baseTypeInteger(Ast* int_type)
   if (int_type->baseTypeInteger.size) {
     visit_integerTypeSize(int_type->baseTypeInteger.size);
   }
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(int_type, 0);
-  type_env->insert(int_type, name_decl->type, 0);
+  NameDeclaration* name_decl = decl_map->lookup(int_type);
+  type_env->insert(int_type, name_decl->type);
 }
 
 void DeclaredTypePass::visit_baseTypeBit(Ast* bit_type)
@@ -730,8 +755,8 @@ void DeclaredTypePass::visit_baseTypeBit(Ast* bit_type)
   if (bit_type->baseTypeBit.size) {
     visit_integerTypeSize(bit_type->baseTypeBit.size);
   }
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(bit_type, 0);
-  type_env->insert(bit_type, name_decl->type, 0);
+  NameDeclaration* name_decl = decl_map->lookup(bit_type);
+  type_env->insert(bit_type, name_decl->type);
 }
 
 void DeclaredTypePass::visit_baseTypeVarbit(Ast* varbit_type)
@@ -739,29 +764,29 @@ void DeclaredTypePass::visit_baseTypeVarbit(Ast* varbit_type)
   assert(varbit_type->kind == AstEnum::baseTypeVarbit);
 
   visit_integerTypeSize(varbit_type->baseTypeVarbit.size);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(varbit_type, 0);
-  type_env->insert(varbit_type, name_decl->type, 0);
+  NameDeclaration* name_decl = decl_map->lookup(varbit_type);
+  type_env->insert(varbit_type, name_decl->type);
 }
 
 void DeclaredTypePass::visit_baseTypeString(Ast* str_type)
 {
   assert(str_type->kind == AstEnum::baseTypeString);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(str_type, 0);
-  type_env->insert(str_type, name_decl->type, 0);
+  NameDeclaration* name_decl = decl_map->lookup(str_type);
+  type_env->insert(str_type, name_decl->type);
 }
 
 void DeclaredTypePass::visit_baseTypeVoid(Ast* void_type)
 {
   assert(void_type->kind == AstEnum::baseTypeVoid);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(void_type, 0);
-  type_env->insert(void_type, name_decl->type, 0);
+  NameDeclaration* name_decl = decl_map->lookup(void_type);
+  type_env->insert(void_type, name_decl->type);
 }
 
 void DeclaredTypePass::visit_baseTypeError(Ast* error_type)
 {
   assert(error_type->kind == AstEnum::baseTypeError);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(error_type, 0);
-  type_env->insert(error_type, name_decl->type, 0);
+  NameDeclaration* name_decl = decl_map->lookup(error_type);
+  type_env->insert(error_type, name_decl->type);
 }
 
 void DeclaredTypePass::visit_integerTypeSize(Ast* type_size)
@@ -790,8 +815,8 @@ void DeclaredTypePass::visit_typeArg(Ast* type_arg)
   } else if (type_arg->typeArg.arg->kind == AstEnum::dontcare) {
     visit_dontcare(type_arg->typeArg.arg);
   } else assert(0);
-  Type* arg_ty = (Type*)type_env->lookup(type_arg->typeArg.arg, 0);
-  type_env->insert(type_arg, arg_ty, 0);
+  Type* arg_ty = type_env->lookup(type_arg->typeArg.arg);
+  type_env->insert(type_arg, arg_ty);
 }
 
 void DeclaredTypePass::visit_typeArgumentList(Ast* args)
@@ -814,11 +839,11 @@ void DeclaredTypePass::visit_typeArgumentList(Ast* args)
   int i = 0;
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    args_ty->product.set(i, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    args_ty->product.set(i, type_env->lookup(Ast::owner_of(tree)));
     i += 1;
   }
   assert(i == args_ty->product.count);
-  type_env->insert(args, args_ty, 0);
+  type_env->insert(args, args_ty);
 }
 
 void DeclaredTypePass::visit_typeDeclaration(Ast* type_decl)
@@ -836,8 +861,8 @@ void DeclaredTypePass::visit_typeDeclaration(Ast* type_decl)
   } else if (type_decl->typeDeclaration.decl->kind == AstEnum::packageTypeDeclaration) {
     visit_packageTypeDeclaration(type_decl->typeDeclaration.decl);
   } else assert(0);
-  Type* decl_ty = (Type*)type_env->lookup(type_decl->typeDeclaration.decl, 0);
-  type_env->insert(type_decl, decl_ty, 0);
+  Type* decl_ty = type_env->lookup(type_decl->typeDeclaration.decl);
+  type_env->insert(type_decl, decl_ty);
 }
 
 void DeclaredTypePass::visit_derivedTypeDeclaration(Ast* type_decl)
@@ -853,8 +878,8 @@ void DeclaredTypePass::visit_derivedTypeDeclaration(Ast* type_decl)
   } else if (type_decl->derivedTypeDeclaration.decl->kind == AstEnum::enumDeclaration) {
     visit_enumDeclaration(type_decl->derivedTypeDeclaration.decl);
   } else assert(0);
-  Type* decl_ty = (Type*)type_env->lookup(type_decl->derivedTypeDeclaration.decl, 0);
-  type_env->insert(type_decl, decl_ty, 0);
+  Type* decl_ty = type_env->lookup(type_decl->derivedTypeDeclaration.decl);
+  type_env->insert(type_decl, decl_ty);
 }
 
 void DeclaredTypePass::visit_headerTypeDeclaration(Ast* header_decl)
@@ -866,9 +891,9 @@ void DeclaredTypePass::visit_headerTypeDeclaration(Ast* header_decl)
   Type* header_ty = Type_Struct::append(type_array);
   header_ty->strname = name->name.strname;
   header_ty->ast = header_decl;
-  type_env->insert(header_decl, header_ty, 0);
-  header_ty->struct_.fields = (Type*)type_env->lookup(header_decl->headerTypeDeclaration.fields, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(header_decl, 0);
+  type_env->insert(header_decl, header_ty);
+  header_ty->struct_.fields = type_env->lookup(header_decl->headerTypeDeclaration.fields);
+  NameDeclaration* name_decl = decl_map->lookup(header_decl);
   name_decl->type = header_ty;
 }
 
@@ -881,9 +906,9 @@ void DeclaredTypePass::visit_headerUnionDeclaration(Ast* union_decl)
   Type* union_ty = Type_Struct::append(type_array);
   union_ty->strname = name->name.strname;
   union_ty->ast = union_decl;
-  type_env->insert(union_decl, union_ty, 0);
-  union_ty->struct_.fields = (Type*)type_env->lookup(union_decl->headerUnionDeclaration.fields, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(union_decl, 0);
+  type_env->insert(union_decl, union_ty);
+  union_ty->struct_.fields = type_env->lookup(union_decl->headerUnionDeclaration.fields);
+  NameDeclaration* name_decl = decl_map->lookup(union_decl);
   name_decl->type = union_ty;
 }
 
@@ -896,9 +921,9 @@ void DeclaredTypePass::visit_structTypeDeclaration(Ast* struct_decl)
   Type* struct_ty = Type_Struct::append(type_array);
   struct_ty->strname = name->name.strname;
   struct_ty->ast = struct_decl;
-  type_env->insert(struct_decl, struct_ty, 0);
-  struct_ty->struct_.fields = (Type*)type_env->lookup(struct_decl->structTypeDeclaration.fields, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(struct_decl, 0);
+  type_env->insert(struct_decl, struct_ty);
+  struct_ty->struct_.fields = type_env->lookup(struct_decl->structTypeDeclaration.fields);
+  NameDeclaration* name_decl = decl_map->lookup(struct_decl);
   name_decl->type = struct_ty;
 }
 
@@ -922,11 +947,11 @@ void DeclaredTypePass::visit_structFieldList(Ast* fields)
   int i = 0;
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    fields_ty->product.set(i, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    fields_ty->product.set(i, type_env->lookup(Ast::owner_of(tree)));
     i += 1;
   }
   assert(i == fields_ty->product.count);
-  type_env->insert(fields, fields_ty, 0);
+  type_env->insert(fields, fields_ty);
 }
 
 void DeclaredTypePass::visit_structField(Ast* field)
@@ -938,9 +963,9 @@ void DeclaredTypePass::visit_structField(Ast* field)
   Type* field_ty = Type_Field::append(type_array);
   field_ty->strname = name->name.strname;
   field_ty->ast = field;
-  field_ty->field.type = (Type*)type_env->lookup(field->structField.type, 0);
-  type_env->insert(field, field_ty, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(field, 0);
+  field_ty->field.type = type_env->lookup(field->structField.type);
+  type_env->insert(field, field_ty);
+  NameDeclaration* name_decl = decl_map->lookup(field);
   name_decl->type = field_ty;
 }
 
@@ -952,10 +977,10 @@ void DeclaredTypePass::visit_enumDeclaration(Ast* enum_decl)
   Type* enum_ty = Type_Enum::append(type_array);
   enum_ty->strname = name->name.strname;
   enum_ty->ast = enum_decl;
-  type_env->insert(enum_decl, enum_ty, 0);
+  type_env->insert(enum_decl, enum_ty);
   visit_specifiedIdentifierList(enum_decl->enumDeclaration.fields, enum_ty);
-  enum_ty->enum_.fields = (Type*)type_env->lookup(enum_decl->enumDeclaration.fields, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(enum_decl, 0);
+  enum_ty->enum_.fields = type_env->lookup(enum_decl->enumDeclaration.fields);
+  NameDeclaration* name_decl = decl_map->lookup(enum_decl);
   name_decl->type = enum_ty;
 }
 
@@ -967,7 +992,7 @@ void DeclaredTypePass::visit_errorDeclaration(Ast* error_decl)
   Type* fields_ty = error_ty->enum_.fields;
   if (error_ty->enum_.field_count > 0 && fields_ty->product.members == 0) {
     fields_ty->product.count = error_ty->enum_.field_count;
-    fields_ty->product.members = (Type**)storage->allocate(sizeof(Type*), fields_ty->product.count);
+    fields_ty->product.members = storage->allocate<Type*>(fields_ty->product.count);
   }
   visit_identifierList(error_decl->errorDeclaration.fields, error_ty,
       error_ty->enum_.fields, &error_ty->enum_.i);
@@ -981,7 +1006,7 @@ void DeclaredTypePass::visit_matchKindDeclaration(Ast* match_decl)
   Type* fields_ty = match_kind_ty->enum_.fields;
   if (match_kind_ty->enum_.field_count > 0 && fields_ty->product.members == 0) {
     fields_ty->product.count = match_kind_ty->enum_.field_count;
-    fields_ty->product.members = (Type**)storage->allocate(sizeof(Type*), fields_ty->product.count);
+    fields_ty->product.members = storage->allocate<Type*>(fields_ty->product.count);
   }
   visit_identifierList(match_decl->matchKindDeclaration.fields, match_kind_ty,
       match_kind_ty->enum_.fields, &match_kind_ty->enum_.i);
@@ -999,10 +1024,10 @@ void DeclaredTypePass::visit_identifierList(Ast* ident_list, Type* enum_ty, Type
     name_ty->strname = Ast::owner_of(tree)->name.strname;
     name_ty->ast = Ast::owner_of(tree);
     name_ty->field.type = enum_ty;
-    type_env->insert(Ast::owner_of(tree), name_ty, 0);
-    NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(Ast::owner_of(tree), 0);
+    type_env->insert(Ast::owner_of(tree), name_ty);
+    NameDeclaration* name_decl = decl_map->lookup(Ast::owner_of(tree));
     name_decl->type = name_ty;
-    idents_ty->product.set(j, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    idents_ty->product.set(j, type_env->lookup(Ast::owner_of(tree)));
     j += 1;
   }
   *i = j;
@@ -1028,11 +1053,11 @@ void DeclaredTypePass::visit_specifiedIdentifierList(Ast* ident_list, Type* enum
   int i = 0;
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    idents_ty->product.set(i, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    idents_ty->product.set(i, type_env->lookup(Ast::owner_of(tree)));
     i += 1;
   }
   assert(i == idents_ty->product.count);
-  type_env->insert(ident_list, idents_ty, 0);
+  type_env->insert(ident_list, idents_ty);
 }
 
 void DeclaredTypePass::visit_specifiedIdentifier(Ast* ident, Type* enum_ty)
@@ -1044,8 +1069,8 @@ void DeclaredTypePass::visit_specifiedIdentifier(Ast* ident, Type* enum_ty)
   ident_ty->strname = name->name.strname;
   ident_ty->ast = ident;
   ident_ty->field.type = enum_ty;
-  type_env->insert(ident, ident_ty, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(ident, 0);
+  type_env->insert(ident, ident_ty);
+  NameDeclaration* name_decl = decl_map->lookup(ident);
   name_decl->type = ident_ty;
 }
 
@@ -1062,9 +1087,9 @@ void DeclaredTypePass::visit_typedefDeclaration(Ast* typedef_decl)
   Type* typedef_ty = Type_Typedef::append(type_array);
   typedef_ty->strname = name->name.strname;
   typedef_ty->ast = typedef_decl;
-  type_env->insert(typedef_decl, typedef_ty, 0);
-  typedef_ty->typedef_.ref = (Type*)type_env->lookup(typedef_decl->typedefDeclaration.type_ref, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(typedef_decl, 0);
+  type_env->insert(typedef_decl, typedef_ty);
+  typedef_ty->typedef_.ref = type_env->lookup(typedef_decl->typedefDeclaration.type_ref);
+  NameDeclaration* name_decl = decl_map->lookup(typedef_decl);
   name_decl->type = typedef_ty;
 }
 
@@ -1223,11 +1248,11 @@ void DeclaredTypePass::visit_tableDeclaration(Ast* table_decl)
   Type* table_ty = Type_Table::append(type_array);
   table_ty->strname = name->name.strname;
   table_ty->ast = table_decl;
-  type_env->insert(table_decl, table_ty, 0);
+  type_env->insert(table_decl, table_ty);
   visit_methodPrototypes(table_decl->tableDeclaration.method_protos, 0, 0);
-  Type* methods_ty = (Type*)type_env->lookup(table_decl->tableDeclaration.method_protos, 0);
+  Type* methods_ty = type_env->lookup(table_decl->tableDeclaration.method_protos);
   table_ty->table.methods = methods_ty;
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(table_decl, 0);
+  NameDeclaration* name_decl = decl_map->lookup(table_decl);
   name_decl->type = table_ty;
 }
 
@@ -1315,10 +1340,10 @@ void DeclaredTypePass::visit_actionDeclaration(Ast* action_decl)
   Type* action_ty = Type_Function::append(type_array);
   action_ty->strname = name->name.strname;
   action_ty->ast = action_decl;
-  action_ty->function.params = (Type*)type_env->lookup(action_decl->actionDeclaration.params, 0);
-  type_env->insert(action_decl, action_ty, 0);
+  action_ty->function.params = type_env->lookup(action_decl->actionDeclaration.params);
+  type_env->insert(action_decl, action_ty);
   action_ty->function.return_ = root_scope->lookup_builtin("void", NameSpace::Type)->type;
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(action_decl, 0);
+  NameDeclaration* name_decl = decl_map->lookup(action_decl);
   name_decl->type = action_ty;
 }
 
@@ -1332,9 +1357,9 @@ void DeclaredTypePass::visit_variableDeclaration(Ast* var_decl)
   if (var_decl->variableDeclaration.init_expr) {
     visit_expression(var_decl->variableDeclaration.init_expr);
   }
-  Type* var_ty = (Type*)type_env->lookup(var_decl->variableDeclaration.type, 0);
-  type_env->insert(var_decl, var_ty, 0);
-  NameDeclaration* name_decl = (NameDeclaration*)decl_map->lookup(var_decl, 0);
+  Type* var_ty = type_env->lookup(var_decl->variableDeclaration.type);
+  type_env->insert(var_decl, var_ty);
+  NameDeclaration* name_decl = decl_map->lookup(var_decl);
   name_decl->type = var_ty;
 }
 
@@ -1469,7 +1494,7 @@ void DeclaredTypePass::visit_indexExpression(Ast* index_expr)
     visit_expression(index_expr->indexExpression.end_index);
   }
   Type* ty = root_scope->lookup_builtin("int", NameSpace::Type)->type;
-  type_env->insert(index_expr, ty, 0);
+  type_env->insert(index_expr, ty);
 }
 
 void DeclaredTypePass::visit_booleanLiteral(Ast* bool_literal)
@@ -1477,7 +1502,7 @@ void DeclaredTypePass::visit_booleanLiteral(Ast* bool_literal)
   assert(bool_literal->kind == AstEnum::booleanLiteral);
 
   Type* ty = root_scope->lookup_builtin("bool", NameSpace::Type)->type;
-  type_env->insert(bool_literal, ty, 0);
+  type_env->insert(bool_literal, ty);
 }
 
 void DeclaredTypePass::visit_integerLiteral(Ast* int_literal)
@@ -1485,7 +1510,7 @@ void DeclaredTypePass::visit_integerLiteral(Ast* int_literal)
   assert(int_literal->kind == AstEnum::integerLiteral);
 
   Type* ty = root_scope->lookup_builtin("int", NameSpace::Type)->type;
-  type_env->insert(int_literal, ty, 0);
+  type_env->insert(int_literal, ty);
 }
 
 void DeclaredTypePass::visit_stringLiteral(Ast* str_literal)
@@ -1493,7 +1518,7 @@ void DeclaredTypePass::visit_stringLiteral(Ast* str_literal)
   assert(str_literal->kind == AstEnum::stringLiteral);
 
   Type* ty = root_scope->lookup_builtin("string", NameSpace::Type)->type;
-  type_env->insert(str_literal, ty, 0);
+  type_env->insert(str_literal, ty);
 }
 
 void DeclaredTypePass::visit_default(Ast* default_)
@@ -1501,7 +1526,7 @@ void DeclaredTypePass::visit_default(Ast* default_)
   assert(default_->kind == AstEnum::default_);
 
   Type* ty = root_scope->lookup_builtin("_", NameSpace::Type)->type;
-  type_env->insert(default_, ty, 0);
+  type_env->insert(default_, ty);
 }
 
 void DeclaredTypePass::visit_dontcare(Ast* dontcare)
@@ -1509,5 +1534,5 @@ void DeclaredTypePass::visit_dontcare(Ast* dontcare)
   assert(dontcare->kind == AstEnum::dontcare);
 
   Type* ty = root_scope->lookup_builtin("_", NameSpace::Type)->type;
-  type_env->insert(dontcare, ty, 0);
+  type_env->insert(dontcare, ty);
 }
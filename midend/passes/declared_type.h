@@ -1,22 +1,22 @@
 #pragma once
 
 #include "memory/arena.h"
-#include "adt/map.h"
 #include "frontend/ast.h"
+#include "frontend/lexer.h"
 #include "frontend/scope.h"
 
 struct DeclaredTypePass {
   /* in */
   Arena* storage;
-  char* source_file;
+  SourceText* source_text;
   Ast* p4program;
   Scope* root_scope;
-  Map* scope_map;
-  Map* decl_map;
-  Array* type_array;
+  AstAttribute<Scope*>* scope_map;
+  AstAttribute<NameDeclaration*>* decl_map;
+  SegmentedArray<Type>* type_array;
 
   /* out */
-  Map* type_env;
+  AstAttribute<Type*>* type_env;
 
 /** PROGRAM **/
 
@@ -1,7 +1,17 @@
 #include <stdio.h>
 #include "adt/basic.h"
+#include "adt/atom.h"
 #include "midend/passes/name_binding.h"
 
+/**
+ * The type_array holds a Type for every declaration, and the passes after this
+ * one add to it. At 5 segments it ran out ("Maximum array capacity has been reached.")
+ * on programs with more than about 500 types, a 54k-line generated one among them.
+ * 16, the most an Array can have, holds about a million; segments are only
+ * allocated when they're reached, so smaller programs don't pay for them.
+ **/
+#define TYPE_ARRAY_SEGMENT_COUNT  16
+
 struct BuiltinName {
   char* strname;
   enum NameSpace ns;
@@ -44,13 +54,13 @@ void NameBindingPass::define_builtin_names()
 
   for (int i = 0; i < sizeof(builtin_names) / sizeof(builtin_names[0]); i++) {
     Ast* name = Ast_name::allocate(storage);
-    name->name.strname = builtin_names[i].strname;
+    name->name.strname = atom::intern(builtin_names[i].strname);
     NameDeclaration* name_decl = root_scope->bind_name(storage, name->name.strname, builtin_names[i].ns);
     name_decl->ast = name;
   }
 
   for (int i = 0; i < sizeof(builtin_types) / sizeof(builtin_types[0]); i++) {
-    NameEntry* name_entry = root_scope->lookup(builtin_types[i].strname, NameSpace::Type);
+    NameEntry* name_entry = root_scope->lookup(atom::intern(builtin_types[i].strname), NameSpace::Type);
     NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
     Type* ty = 0;
 
@@ -70,7 +80,7 @@ void NameBindingPass::define_builtin_names()
   }
 }
 
-void DEBUG_scope_decls(Scope* scope)
+void DEBUG_scope_decls(Scope* scope, SourceText* source_text)
 {
   int count = 0;
   enum NameSpace ns[] = {NameSpace::Var, NameSpace::Type, NameSpace::Keyword};
@@ -88,7 +98,8 @@ void DEBUG_scope_decls(Scope* scope)
           printf("%s, %s\n", decl->strname, NameSpace_to_string(ns[i]));
         } else {
           Ast* ast = decl->ast;
-          printf("%s  ...  at %d:%d, %s\n", decl->strname, ast->line_no, ast->column_no, NameSpace_to_string(ns[i]));
+          printf("%s  ...  at %d:%d, %s\n", decl->strname, source_text->line_no_at(ast->offset),
+                 source_text->column_no_at(ast->offset), NameSpace_to_string(ns[i]));
         }
         decl = decl->next_in_scope;
         count += 1;
@@ -102,9 +113,8 @@ void DEBUG_scope_decls(Scope* scope)
 void NameBindingPass::do_pass()
 {
   current_scope = root_scope;
-  decl_map = (Map*)storage->allocate(sizeof(Map), 1);
-  decl_map->storage = storage;
-  type_array = Array::allocate(storage, sizeof(Type), 5);
+  decl_map = AstAttribute<NameDeclaration*>::allocate(storage, Ast::node_count);
+  type_array = SegmentedArray<Type>::allocate(storage, TYPE_ARRAY_SEGMENT_COUNT);
   define_builtin_names();
   visit_p4program(p4program);
   assert(current_scope == root_scope);
@@ -116,7 +126,7 @@ void NameBindingPass::visit_p4program(Ast* p4program)
 {
   assert(p4program->kind == AstEnum::p4program);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(p4program, 0);
+  current_scope = scope_map->lookup(p4program);
   visit_declarationList(p4program->p4program.decl_list);
   current_scope = prev_scope;
 }
@@ -164,8 +174,8 @@ void NameBindingPass::visit_declaration(Ast* decl)
 void NameBindingPass::visit_name(Ast* name)
 {
   assert(name->kind == AstEnum::name);
-  MapEntry* m = scope_map->insert(name, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(name, current_scope);
+  assert(inserted);
 }
 
 void NameBindingPass::visit_parameterList(Ast* params)
@@ -187,7 +197,7 @@ void NameBindingPass::visit_parameter(Ast* param)
   Ast* name = param->parameter.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Var);
   name_decl->ast = param;
-  decl_map->insert(param, name_decl, 0);
+  decl_map->insert(param, name_decl);
   if (param->parameter.init_expr) {
     visit_expression(param->parameter.init_expr);
   }
@@ -201,9 +211,9 @@ void NameBindingPass::visit_packageTypeDeclaration(Ast* type_decl)
   Ast* name = type_decl->packageTypeDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = type_decl;
-  decl_map->insert(type_decl, name_decl, 0);
+  decl_map->insert(type_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(type_decl, 0);
+  current_scope = scope_map->lookup(type_decl);
   visit_parameterList(type_decl->packageTypeDeclaration.params);
   current_scope = prev_scope;
 }
@@ -217,7 +227,7 @@ void NameBindingPass::visit_instantiation(Ast* inst)
   Ast* name = inst->instantiation.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Var);
   name_decl->ast = inst;
-  decl_map->insert(inst, name_decl, 0);
+  decl_map->insert(inst, name_decl);
 }
 
 /** PARSER **/
@@ -228,7 +238,7 @@ void NameBindingPass::visit_parserDeclaration(Ast* parser_decl)
 
   visit_typeDeclaration(parser_decl->parserDeclaration.proto);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(parser_decl, 0);
+  current_scope = scope_map->lookup(parser_decl);
   if (parser_decl->parserDeclaration.ctor_params) {
     visit_parameterList(parser_decl->parserDeclaration.ctor_params);
   }
@@ -245,9 +255,9 @@ void NameBindingPass::visit_parserTypeDeclaration(Ast* type_decl)
   Ast* name = type_decl->parserTypeDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = type_decl;
-  decl_map->insert(type_decl, name_decl, 0);
+  decl_map->insert(type_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(type_decl, 0);
+  current_scope = scope_map->lookup(type_decl);
   visit_parameterList(type_decl->parserTypeDeclaration.params);
   visit_methodPrototypes(type_decl->parserTypeDeclaration.method_protos, name_decl);
   current_scope = prev_scope;
@@ -290,9 +300,9 @@ void NameBindingPass::visit_parserState(Ast* state)
   Ast* name = state->parserState.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Var);
   name_decl->ast = state;
-  decl_map->insert(state, name_decl, 0);
+  decl_map->insert(state, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(state, 0);
+  current_scope = scope_map->lookup(state);
   visit_parserStatements(state->parserState.stmt_list);
   visit_transitionStatement(state->parserState.transition_stmt);
   current_scope = prev_scope;
@@ -331,7 +341,7 @@ void NameBindingPass::visit_parserBlockStatement(Ast* block_stmt)
 {
   assert(block_stmt->kind == AstEnum::parserBlockStatement);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(block_stmt, 0);
+  current_scope = scope_map->lookup(block_stmt);
   visit_parserStatements(block_stmt->parserBlockStatement.stmt_list);
   current_scope = prev_scope;
 }
@@ -422,7 +432,7 @@ void NameBindingPass::visit_controlDeclaration(Ast* control_decl)
 
   visit_typeDeclaration(control_decl->controlDeclaration.proto);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(control_decl, 0);
+  current_scope = scope_map->lookup(control_decl);
   if (control_decl->controlDeclaration.ctor_params) {
     visit_parameterList(control_decl->controlDeclaration.ctor_params);
   }
@@ -439,9 +449,9 @@ void NameBindingPass::visit_controlTypeDeclaration(Ast* type_decl)
   Ast* name = type_decl->controlTypeDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = type_decl;
-  decl_map->insert(type_decl, name_decl, 0);
+  decl_map->insert(type_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(type_decl, 0);
+  current_scope = scope_map->lookup(type_decl);
   visit_parameterList(type_decl->controlTypeDeclaration.params);
   visit_methodPrototypes(type_decl->controlTypeDeclaration.method_protos, name_decl);
   current_scope = prev_scope;
@@ -490,9 +500,9 @@ void NameBindingPass::visit_externTypeDeclaration(Ast* type_decl)
   Ast* name = type_decl->externTypeDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = type_decl;
-  decl_map->insert(type_decl, name_decl, 0);
+  decl_map->insert(type_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(type_decl, 0);
+  current_scope = scope_map->lookup(type_decl);
   visit_methodPrototypes(type_decl->externTypeDeclaration.method_protos, name_decl);
   current_scope = prev_scope;
 }
@@ -515,9 +525,9 @@ void NameBindingPass::visit_functionPrototype(Ast* func_proto)
   Ast* name = func_proto->functionPrototype.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = func_proto;
-  decl_map->insert(func_proto, name_decl, 0);
+  decl_map->insert(func_proto, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(func_proto, 0);
+  current_scope = scope_map->lookup(func_proto);
   if (func_proto->functionPrototype.return_type) {
     visit_typeRef(func_proto->functionPrototype.return_type);
   }
@@ -570,9 +580,9 @@ void NameBindingPass::visit_baseTypeBoolean(Ast* bool_type)
 {
   assert(bool_type->kind == AstEnum::baseTypeBoolean);
 
-  NameEntry* name_entry = root_scope->lookup("bool", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("bool"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-  decl_map->insert(bool_type, name_decl, 0);
+  decl_map->insert(bool_type, name_decl);
 }
 
 void NameBindingPass::visit_baseTypeInteger(Ast* int_type)
@@ -582,9 +592,9 @@ void NameBindingPass::visit_baseTypeInteger(Ast* int_type)
   if (int_type->baseTypeInteger.size) {
     visit_integerTypeSize(int_type->baseTypeInteger.size);
   }
-  NameEntry* name_entry = root_scope->lookup("int", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("int"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-  decl_map->insert(int_type, name_decl, 0);
+  decl_map->insert(int_type, name_decl);
 }
 
 void NameBindingPass::visit_baseTypeBit(Ast* bit_type)
@@ -594,9 +604,9 @@ void NameBindingPass::visit_baseTypeBit(Ast* bit_type)
   if (bit_type->baseTypeBit.size) {
     visit_integerTypeSize(bit_type->baseTypeBit.size);
   }
-  NameEntry* name_entry = root_scope->lookup("bit", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("bit"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-  decl_map->insert(bit_type, name_decl, 0);
+  decl_map->insert(bit_type, name_decl);
 }
 
 void NameBindingPass::visit_baseTypeVarbit(Ast* varbit_type)
@@ -604,36 +614,36 @@ void NameBindingPass::visit_baseTypeVarbit(Ast* varbit_type)
   assert(varbit_type->kind == AstEnum::baseTypeVarbit);
 
   visit_integerTypeSize(varbit_type->baseTypeVarbit.size);
-  NameEntry* name_entry = root_scope->lookup("varbit", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("varbit"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-  decl_map->insert(varbit_type, name_decl, 0);
+  decl_map->insert(varbit_type, name_decl);
 }
 
 void NameBindingPass::visit_baseTypeString(Ast* str_type)
 {
   assert(str_type->kind == AstEnum::baseTypeString);
 
-  NameEntry* name_entry = root_scope->lookup("string", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("string"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-  decl_map->insert(str_type, name_decl, 0);
+  decl_map->insert(str_type, name_decl);
 }
 
 void NameBindingPass::visit_baseTypeVoid(Ast* void_type)
 {
   assert(void_type->kind == AstEnum::baseTypeVoid);
 
-  NameEntry* name_entry = root_scope->lookup("void", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("void"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-  decl_map->insert(void_type, name_decl, 0);
+  decl_map->insert(void_type, name_decl);
 }
 
 void NameBindingPass::visit_baseTypeError(Ast* error_type)
 {
   assert(error_type->kind == AstEnum::baseTypeError);
 
-  NameEntry* name_entry = root_scope->lookup("error", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("error"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
-  decl_map->insert(error_type, name_decl, 0);
+  decl_map->insert(error_type, name_decl);
 }
 
 void NameBindingPass::visit_integerTypeSize(Ast* type_size)
@@ -710,9 +720,9 @@ void NameBindingPass::visit_headerTypeDeclaration(Ast* header_decl)
   Ast* name = header_decl->headerTypeDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = header_decl;
-  decl_map->insert(header_decl, name_decl, 0);
+  decl_map->insert(header_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(header_decl, 0);
+  current_scope = scope_map->lookup(header_decl);
   visit_structFieldList(header_decl->headerTypeDeclaration.fields, name_decl);
   current_scope = prev_scope;
 }
@@ -724,9 +734,9 @@ void NameBindingPass::visit_headerUnionDeclaration(Ast* union_decl)
   Ast* name = union_decl->headerUnionDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = union_decl;
-  decl_map->insert(union_decl, name_decl, 0);
+  decl_map->insert(union_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(union_decl, 0);
+  current_scope = scope_map->lookup(union_decl);
   visit_structFieldList(union_decl->headerUnionDeclaration.fields, name_decl);
   current_scope = prev_scope;
 }
@@ -738,9 +748,9 @@ void NameBindingPass::visit_structTypeDeclaration(Ast* struct_decl)
   Ast* name = struct_decl->structTypeDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = struct_decl;
-  decl_map->insert(struct_decl, name_decl, 0);
+  decl_map->insert(struct_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(struct_decl, 0);
+  current_scope = scope_map->lookup(struct_decl);
   visit_structFieldList(struct_decl->structTypeDeclaration.fields, name_decl);
   current_scope = prev_scope;
 }
@@ -763,7 +773,7 @@ void NameBindingPass::visit_structField(Ast* field)
   Ast* name = field->structField.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = field;
-  decl_map->insert(field, name_decl, 0);
+  decl_map->insert(field, name_decl);
 }
 
 void NameBindingPass::visit_enumDeclaration(Ast* enum_decl)
@@ -773,9 +783,9 @@ void NameBindingPass::visit_enumDeclaration(Ast* enum_decl)
   Ast* name = enum_decl->enumDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = enum_decl;
-  decl_map->insert(enum_decl, name_decl, 0);
+  decl_map->insert(enum_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(enum_decl, 0);
+  current_scope = scope_map->lookup(enum_decl);
   visit_specifiedIdentifierList(enum_decl->enumDeclaration.fields, name_decl);
   current_scope = prev_scope;
 }
@@ -784,12 +794,12 @@ void NameBindingPass::visit_errorDeclaration(Ast* error_decl)
 {
   assert(error_decl->kind == AstEnum::errorDeclaration);
 
-  NameEntry* name_entry = root_scope->lookup("error", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("error"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
   Type* error_ty = name_decl->type;
-  decl_map->insert(error_decl, name_decl, 0);
+  decl_map->insert(error_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(error_decl, 0);
+  current_scope = scope_map->lookup(error_decl);
   error_ty->enum_.field_count += visit_identifierList(error_decl->errorDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -798,12 +808,12 @@ void NameBindingPass::visit_matchKindDeclaration(Ast* match_decl)
 {
   assert(match_decl->kind == AstEnum::matchKindDeclaration);
 
-  NameEntry* name_entry = root_scope->lookup("match_kind", NameSpace::Type);
+  NameEntry* name_entry = root_scope->lookup(atom::intern("match_kind"), NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Type);
   Type* match_kind_ty = name_decl->type;
-  decl_map->insert(match_decl, name_decl, 0);
+  decl_map->insert(match_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(match_decl, 0);
+  current_scope = scope_map->lookup(match_decl);
   match_kind_ty->enum_.field_count += visit_identifierList(match_decl->matchKindDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -819,7 +829,7 @@ int NameBindingPass::visit_identifierList(Ast* ident_list)
     Ast* name = Ast::owner_of(tree);
     NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
     name_decl->ast = name;
-    decl_map->insert(name, name_decl, 0);
+    decl_map->insert(name, name_decl);
     count += 1;
   }
   return count;
@@ -842,7 +852,7 @@ void NameBindingPass::visit_specifiedIdentifier(Ast* ident)
   Ast* name = ident->specifiedIdentifier.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = ident;
-  decl_map->insert(ident, name_decl, 0);
+  decl_map->insert(ident, name_decl);
   if (ident->specifiedIdentifier.init_expr) {
     visit_expression(ident->specifiedIdentifier.init_expr);
   }
@@ -860,7 +870,7 @@ void NameBindingPass::visit_typedefDeclaration(Ast* typedef_decl)
   Ast* name = typedef_decl->typedefDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = typedef_decl;
-  decl_map->insert(typedef_decl, name_decl, 0);
+  decl_map->insert(typedef_decl, name_decl);
 }
 
 /** STATEMENTS **/
@@ -937,7 +947,7 @@ void NameBindingPass::visit_statement(Ast* stmt)
     ;
   } else if (stmt->statement.stmt->kind == AstEnum::blockStatement) {
     Scope* prev_scope = current_scope;
-    current_scope = (Scope*)scope_map->lookup(stmt, 0);
+    current_scope = scope_map->lookup(stmt);
     visit_blockStatement(stmt->statement.stmt);
     current_scope = prev_scope;
   } else if (stmt->statement.stmt->kind == AstEnum::exitStatement) {
@@ -1022,9 +1032,9 @@ void NameBindingPass::visit_tableDeclaration(Ast* table_decl)
   Ast* name = table_decl->tableDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = table_decl;
-  decl_map->insert(table_decl, name_decl, 0);
+  decl_map->insert(table_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(table_decl, 0);
+  current_scope = scope_map->lookup(table_decl);
   visit_tablePropertyList(table_decl->tableDeclaration.prop_list);
   visit_methodPrototypes(table_decl->tableDeclaration.method_protos, name_decl);
   current_scope = prev_scope;
@@ -1118,9 +1128,9 @@ void NameBindingPass::visit_actionDeclaration(Ast* action_decl)
   Ast* name = action_decl->actionDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = action_decl;
-  decl_map->insert(action_decl, name_decl, 0);
+  decl_map->insert(action_decl, name_decl);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(action_decl, 0);
+  current_scope = scope_map->lookup(action_decl);
   visit_parameterList(action_decl->actionDeclaration.params);
   visit_blockStatement(action_decl->actionDeclaration.stmt);
   current_scope = prev_scope;
@@ -1137,7 +1147,7 @@ void NameBindingPass::visit_variableDeclaration(Ast* var_decl)
   Ast* name = var_decl->variableDeclaration.name;
   NameDeclaration* name_decl = current_scope->bind_name(storage, name->name.strname, NameSpace::Type);
   name_decl->ast = var_decl;
-  decl_map->insert(var_decl, name_decl, 0);
+  decl_map->insert(var_decl, name_decl);
   if (var_decl->variableDeclaration.init_expr) {
     visit_expression(var_decl->variableDeclaration.init_expr);
   }
@@ -1151,7 +1161,7 @@ void NameBindingPass::visit_functionDeclaration(Ast* func_decl)
 
   visit_functionPrototype(func_decl->functionDeclaration.proto);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(func_decl, 0);
+  current_scope = scope_map->lookup(func_decl);
   visit_blockStatement(func_decl->functionDeclaration.stmt);
   current_scope = prev_scope;
 }
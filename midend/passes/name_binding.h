@@ -1,9 +1,9 @@
 #pragma once
 
 #include "memory/arena.h"
-#include "adt/map.h"
 #include "adt/array.h"
 #include "frontend/ast.h"
+#include "frontend/lexer.h"
 #include "frontend/scope.h"
 
 struct NameBindingPass {
@@ -11,11 +11,11 @@ struct NameBindingPass {
   Arena* storage;
   Ast* p4program;
   Scope* root_scope;
-  Map* scope_map;
+  AstAttribute<Scope*>* scope_map;
 
   /* out */
-  Map* decl_map;
-  Array* type_array;
+  AstAttribute<NameDeclaration*>* decl_map;
+  SegmentedArray<Type>* type_array;
 
   /* local */
   Scope* current_scope;
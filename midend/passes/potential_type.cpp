@@ -4,22 +4,19 @@
 
 static void DEBUG_print_potential_types(PotentialType_Set* tau)
 {
-  int i = 0;
-  for (MapEntry* m = tau->members.first; m != 0; m = m->next) {
-    Type* ty = (Type*)m->key;
+  for (int i = 0; i < tau->count; i++) {
+    Type* ty = tau->get(i);
     if (ty->strname) {
       printf("  [%d] 0x%x %s %s\n", i, ty, TypeEnum_to_string(ty->kind), ty->strname);
     } else {
       printf("  [%d] 0x%x %s\n", i, ty, TypeEnum_to_string(ty->kind));
     }
-    i += 1;
   }
 }
 
 void PotentialTypePass::do_pass()
 {
-  po_type_map = (Map*)storage->allocate(sizeof(Map), 1);
-  po_type_map->storage = storage;
+  po_type_map = AstAttribute<PotentialType*>::allocate(storage, Ast::node_count);
   visit_p4program(p4program);
 }
 
@@ -37,6 +34,7 @@ void PotentialTypePass::visit_declarationList(Ast* decl_list)
   TreeIterator it(&decl_list->tree);
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
+    ArenaScope scratch_scope(scratch);
     visit_declaration(Ast::owner_of(tree));
   }
 }
@@ -75,29 +73,25 @@ void PotentialTypePass::visit_name(Ast* name, PotentialType* potential_args)
 {
   assert(name->kind == AstEnum::name);
   if (potential_args) assert(potential_args->kind == PotentialTypeEnum::Product);
-  static Array* name_ty; // FIXME
 
-  if (!name_ty) {
-    name_ty = Array::allocate(storage, sizeof(Type*), 1);
-  }
-  name_ty->element_count = 0;
+  SegmentedArray<Type*>* name_ty = SegmentedArray<Type*>::allocate(scratch, 1);
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(name, tau, 0);
-  Scope* scope = (Scope*)scope_map->lookup(name, 0);
+  po_type_map->insert(name, tau);
+  Scope* scope = scope_map->lookup(name);
   NameEntry* name_entry = scope->lookup(name->name.strname, NameSpace::Var | NameSpace::Type);
   NameDeclaration* name_decl = name_entry->get_declarations(NameSpace::Var);
   if (name_decl) {
-    Type* ty = (Type*)type_env->lookup(name_decl->ast, 0);
-    *(Type**)name_ty->append() = ty->actual_type();
+    Type* ty = type_env->lookup(name_decl->ast);
+    *name_ty->append() = ty->actual_type();
     assert(!name_decl->next_in_scope);
   }
   name_decl = name_entry->get_declarations(NameSpace::Type);
   for(; name_decl != 0; name_decl = name_decl->next_in_scope) {
-    Type* ty = (Type*)type_env->lookup(name_decl->ast, 0);
-    *(Type**)name_ty->append() = ty->actual_type();
+    Type* ty = type_env->lookup(name_decl->ast);
+    *name_ty->append() = ty->actual_type();
   }
   for (int i = 0; i < name_ty->element_count; i++) {
-    Type* ty = *(Type**)name_ty->get(i);
+    Type* ty = *name_ty->get(i);
     if (potential_args) {
       if (ty->kind == TypeEnum::Function) {
         if (type_checker->match_params(potential_args, ty->function.params)) {
@@ -156,10 +150,10 @@ void PotentialTypePass::visit_instantiation(Ast* inst)
   assert(inst->kind == AstEnum::instantiation);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(inst, tau, 0);
+  po_type_map->insert(inst, tau);
   visit_typeRef(inst->instantiation.type);
   visit_argumentList(inst->instantiation.args);
-  Type* inst_ty = (Type*)type_env->lookup(inst, 0);
+  Type* inst_ty = type_env->lookup(inst);
   tau->set.add(inst_ty->actual_type());
 }
 
@@ -270,8 +264,8 @@ void PotentialTypePass::visit_stateExpression(Ast* state_expr)
   } else if (state_expr->stateExpression.expr->kind == AstEnum::selectExpression) {
     visit_selectExpression(state_expr->stateExpression.expr);
   } else assert(0);
-  tau = (PotentialType*)po_type_map->lookup(state_expr->stateExpression.expr, 0);
-  po_type_map->insert(state_expr, tau, 0);
+  tau = po_type_map->lookup(state_expr->stateExpression.expr);
+  po_type_map->insert(state_expr, tau);
 }
 
 void PotentialTypePass::visit_selectExpression(Ast* select_expr)
@@ -295,13 +289,13 @@ void PotentialTypePass::visit_selectCaseList(Ast* case_list)
     i += 1;
   }
   PotentialType* tau = PotentialType_Product::allocate(storage, i);
-  po_type_map->insert(case_list, tau, 0);
+  po_type_map->insert(case_list, tau);
 
   i = 0;
   it.begin(&case_list->tree);
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    PotentialType* tau_case = (PotentialType*)po_type_map->lookup(Ast::owner_of(tree), 0);
+    PotentialType* tau_case = po_type_map->lookup(Ast::owner_of(tree));
     tau->product.set(i, tau_case);
     i += 1;
   }
@@ -314,8 +308,8 @@ void PotentialTypePass::visit_selectCase(Ast* select_case)
 
   visit_keysetExpression(select_case->selectCase.keyset_expr);
   visit_name(select_case->selectCase.name, 0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(select_case->selectCase.name, 0);
-  po_type_map->insert(select_case, tau, 0);
+  PotentialType* tau = po_type_map->lookup(select_case->selectCase.name);
+  po_type_map->insert(select_case, tau);
 }
 
 void PotentialTypePass::visit_keysetExpression(Ast* keyset_expr)
@@ -327,8 +321,8 @@ void PotentialTypePass::visit_keysetExpression(Ast* keyset_expr)
   } else if (keyset_expr->keysetExpression.expr->kind == AstEnum::simpleKeysetExpression) {
     visit_simpleKeysetExpression(keyset_expr->keysetExpression.expr);
   } else assert(0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(keyset_expr->keysetExpression.expr, 0);
-  po_type_map->insert(keyset_expr, tau, 0);
+  PotentialType* tau = po_type_map->lookup(keyset_expr->keysetExpression.expr);
+  po_type_map->insert(keyset_expr, tau);
 }
 
 void PotentialTypePass::visit_tupleKeysetExpression(Ast* tuple_expr)
@@ -336,8 +330,8 @@ void PotentialTypePass::visit_tupleKeysetExpression(Ast* tuple_expr)
   assert(tuple_expr->kind == AstEnum::tupleKeysetExpression);
 
   visit_simpleExpressionList(tuple_expr->tupleKeysetExpression.expr_list);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(tuple_expr->tupleKeysetExpression.expr_list, 0);
-  po_type_map->insert(tuple_expr, tau, 0);
+  PotentialType* tau = po_type_map->lookup(tuple_expr->tupleKeysetExpression.expr_list);
+  po_type_map->insert(tuple_expr, tau);
 }
 
 void PotentialTypePass::visit_simpleKeysetExpression(Ast* simple_expr)
@@ -352,8 +346,8 @@ void PotentialTypePass::visit_simpleKeysetExpression(Ast* simple_expr)
     visit_dontcare(simple_expr->simpleKeysetExpression.expr);
   } else assert(0);
   PotentialType* tau = PotentialType_Product::allocate(storage, 1);
-  tau->product.set(0, (PotentialType*)po_type_map->lookup(simple_expr->simpleKeysetExpression.expr, 0));
-  po_type_map->insert(simple_expr, tau, 0);
+  tau->product.set(0, po_type_map->lookup(simple_expr->simpleKeysetExpression.expr));
+  po_type_map->insert(simple_expr, tau);
 }
 
 void PotentialTypePass::visit_simpleExpressionList(Ast* expr_list)
@@ -370,13 +364,13 @@ void PotentialTypePass::visit_simpleExpressionList(Ast* expr_list)
     i += 1;
   }
   PotentialType* tau = PotentialType_Product::allocate(storage, i);
-  po_type_map->insert(expr_list, tau, 0);
+  po_type_map->insert(expr_list, tau);
 
   i = 0;
   it.begin(&expr_list->tree);
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    PotentialType* tau_expr = (PotentialType*)po_type_map->lookup(Ast::owner_of(tree), 0);
+    PotentialType* tau_expr = po_type_map->lookup(Ast::owner_of(tree));
     tau->product.set(i, tau_expr);
     i += 1;
   }
@@ -491,8 +485,8 @@ void PotentialTypePass::visit_typeRef(Ast* type_ref)
   } else if (type_ref->typeRef.type->kind == AstEnum::tupleType) {
     visit_tupleType(type_ref->typeRef.type);
   } else assert(0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(type_ref->typeRef.type, 0);
-  po_type_map->insert(type_ref, tau, 0);
+  PotentialType* tau = po_type_map->lookup(type_ref->typeRef.type);
+  po_type_map->insert(type_ref, tau);
 }
 
 void PotentialTypePass::visit_tupleType(Ast* type_decl)
@@ -500,8 +494,8 @@ void PotentialTypePass::visit_tupleType(Ast* type_decl)
   assert(type_decl->kind == AstEnum::tupleType);
 
   visit_typeArgumentList(type_decl->tupleType.type_args);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(type_decl->tupleType.type_args, 0);
-  po_type_map->insert(type_decl, tau, 0);
+  PotentialType* tau = po_type_map->lookup(type_decl->tupleType.type_args);
+  po_type_map->insert(type_decl, tau);
 }
 
 void PotentialTypePass::visit_headerStackType(Ast* type_decl)
@@ -511,8 +505,8 @@ void PotentialTypePass::visit_headerStackType(Ast* type_decl)
   visit_typeRef(type_decl->headerStackType.type);
   visit_expression(type_decl->headerStackType.stack_expr, 0);
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(type_decl, tau, 0);
-  tau->set.add((Type*)type_env->lookup(type_decl, 0));
+  po_type_map->insert(type_decl, tau);
+  tau->set.add(type_env->lookup(type_decl));
 }
 
 void PotentialTypePass::visit_baseTypeBoolean(Ast* bool_type)
@@ -520,8 +514,8 @@ void PotentialTypePass::visit_baseTypeBoolean(Ast* bool_type)
   assert(bool_type->kind == AstEnum::baseTypeBoolean);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(bool_type, tau, 0);
-  tau->set.add((Type*)type_env->lookup(bool_type, 0));
+  po_type_map->insert(bool_type, tau);
+  tau->set.add(type_env->lookup(bool_type));
 }
 
 void PotentialTypePass::visit_baseTypeInteger(Ast* int_type)
@@ -532,8 +526,8 @@ void PotentialTypePass::visit_baseTypeInteger(Ast* int_type)
     visit_integerTypeSize(int_type->baseTypeInteger.size);
   }
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(int_type, tau, 0);
-  tau->set.add((Type*)type_env->lookup(int_type, 0));
+  po_type_map->insert(int_type, tau);
+  tau->set.add(type_env->lookup(int_type));
 }
 
 void PotentialTypePass::visit_baseTypeBit(Ast* bit_type)
@@ -544,8 +538,8 @@ void PotentialTypePass::visit_baseTypeBit(Ast* bit_type)
     visit_integerTypeSize(bit_type->baseTypeBit.size);
   }
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(bit_type, tau, 0);
-  tau->set.add((Type*)type_env->lookup(bit_type, 0));
+  po_type_map->insert(bit_type, tau);
+  tau->set.add(type_env->lookup(bit_type));
 }
 
 void PotentialTypePass::visit_baseTypeVarbit(Ast* varbit_type)
@@ -554,8 +548,8 @@ void PotentialTypePass::visit_baseTypeVarbit(Ast* varbit_type)
 
   visit_integerTypeSize(varbit_type->baseTypeVarbit.size);
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(varbit_type, tau, 0);
-  tau->set.add((Type*)type_env->lookup(varbit_type, 0));
+  po_type_map->insert(varbit_type, tau);
+  tau->set.add(type_env->lookup(varbit_type));
 }
 
 void PotentialTypePass::visit_baseTypeString(Ast* str_type)
@@ -563,8 +557,8 @@ void PotentialTypePass::visit_baseTypeString(Ast* str_type)
   assert(str_type->kind == AstEnum::baseTypeString);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(str_type, tau, 0);
-  tau->set.add((Type*)type_env->lookup(str_type, 0));
+  po_type_map->insert(str_type, tau);
+  tau->set.add(type_env->lookup(str_type));
 }
 
 void PotentialTypePass::visit_baseTypeVoid(Ast* void_type)
@@ -572,8 +566,8 @@ void PotentialTypePass::visit_baseTypeVoid(Ast* void_type)
   assert(void_type->kind == AstEnum::baseTypeVoid);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(void_type, tau, 0);
-  tau->set.add((Type*)type_env->lookup(void_type, 0));
+  po_type_map->insert(void_type, tau);
+  tau->set.add(type_env->lookup(void_type));
 }
 
 void PotentialTypePass::visit_baseTypeError(Ast* error_type)
@@ -581,8 +575,8 @@ void PotentialTypePass::visit_baseTypeError(Ast* error_type)
   assert(error_type->kind == AstEnum::baseTypeError);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(error_type, tau, 0);
-  tau->set.add((Type*)type_env->lookup(error_type, 0));
+  po_type_map->insert(error_type, tau);
+  tau->set.add(type_env->lookup(error_type));
 }
 
 void PotentialTypePass::visit_integerTypeSize(Ast* type_size)
@@ -590,8 +584,8 @@ void PotentialTypePass::visit_integerTypeSize(Ast* type_size)
   assert(type_size->kind == AstEnum::integerTypeSize);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(type_size, tau, 0);
-  tau->set.add((Type*)type_env->lookup(type_size, 0));
+  po_type_map->insert(type_size, tau);
+  tau->set.add(type_env->lookup(type_size));
 }
 
 void PotentialTypePass::visit_realTypeArg(Ast* type_arg)
@@ -759,7 +753,7 @@ void PotentialTypePass::visit_functionCall(Ast* func_call)
   assert(func_call->kind == AstEnum::functionCall);
 
   visit_argumentList(func_call->functionCall.args);
-  PotentialType* args_tau = (PotentialType*)po_type_map->lookup(func_call->functionCall.args, 0);
+  PotentialType* args_tau = po_type_map->lookup(func_call->functionCall.args);
   assert(args_tau->kind == PotentialTypeEnum::Product);
 
   if (func_call->functionCall.lhs_expr->kind == AstEnum::expression) {
@@ -767,8 +761,8 @@ void PotentialTypePass::visit_functionCall(Ast* func_call)
   } else if (func_call->functionCall.lhs_expr->kind == AstEnum::lvalueExpression) {
     visit_lvalueExpression(func_call->functionCall.lhs_expr, args_tau);
   } else assert(0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(func_call->functionCall.lhs_expr, 0);
-  po_type_map->insert(func_call, tau, 0);
+  PotentialType* tau = po_type_map->lookup(func_call->functionCall.lhs_expr);
+  po_type_map->insert(func_call, tau);
 }
 
 void PotentialTypePass::visit_returnStatement(Ast* return_stmt)
@@ -993,11 +987,11 @@ void PotentialTypePass::visit_variableDeclaration(Ast* var_decl)
 
   visit_typeRef(var_decl->variableDeclaration.type);
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(var_decl, tau, 0);
+  po_type_map->insert(var_decl, tau);
   if (var_decl->variableDeclaration.init_expr) {
     visit_expression(var_decl->variableDeclaration.init_expr, 0);
   }
-  Type* var_ty = (Type*)type_env->lookup(var_decl, 0);
+  Type* var_ty = type_env->lookup(var_decl);
   tau->set.add(var_ty->actual_type());
 }
 
@@ -1025,13 +1019,13 @@ void PotentialTypePass::visit_argumentList(Ast* args)
   }
 
   PotentialType* tau = PotentialType_Product::allocate(storage, i);
-  po_type_map->insert(args, tau, 0);
+  po_type_map->insert(args, tau);
 
   i = 0;
   it.begin(&args->tree);
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    PotentialType* tau_arg = (PotentialType*)po_type_map->lookup(Ast::owner_of(tree), 0);
+    PotentialType* tau_arg = po_type_map->lookup(Ast::owner_of(tree));
     tau->product.set(i, tau_arg);
     i += 1;
   }
@@ -1047,8 +1041,8 @@ void PotentialTypePass::visit_argument(Ast* arg)
   } else if (arg->argument.arg->kind == AstEnum::dontcare) {
     visit_dontcare(arg->argument.arg);
   } else assert(0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(arg->argument.arg, 0);
-  po_type_map->insert(arg, tau, 0);
+  PotentialType* tau = po_type_map->lookup(arg->argument.arg);
+  po_type_map->insert(arg, tau);
 }
 
 void PotentialTypePass::visit_expressionList(Ast* expr_list)
@@ -1066,13 +1060,13 @@ void PotentialTypePass::visit_expressionList(Ast* expr_list)
   }
 
   PotentialType* tau = PotentialType_Product::allocate(storage, i);
-  po_type_map->insert(expr_list, tau, 0);
+  po_type_map->insert(expr_list, tau);
 
   i = 0;
   it.begin(&expr_list->tree);
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    PotentialType* tau_expr = (PotentialType*)po_type_map->lookup(Ast::owner_of(tree), 0);
+    PotentialType* tau_expr = po_type_map->lookup(Ast::owner_of(tree));
     tau->product.set(i, tau_expr);
     i += 1;
   }
@@ -1090,8 +1084,8 @@ void PotentialTypePass::visit_lvalueExpression(Ast* lvalue_expr, PotentialType*
   } else if (lvalue_expr->lvalueExpression.expr->kind == AstEnum::arraySubscript) {
     visit_arraySubscript(lvalue_expr->lvalueExpression.expr);
   } else assert(0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(lvalue_expr->lvalueExpression.expr, 0);
-  po_type_map->insert(lvalue_expr, tau, 0);
+  PotentialType* tau = po_type_map->lookup(lvalue_expr->lvalueExpression.expr);
+  po_type_map->insert(lvalue_expr, tau);
 }
 
 void PotentialTypePass::visit_expression(Ast* expr, PotentialType* potential_args)
@@ -1125,8 +1119,8 @@ void PotentialTypePass::visit_expression(Ast* expr, PotentialType* potential_arg
   } else if (expr->expression.expr->kind == AstEnum::assignmentStatement) {
     visit_assignmentStatement(expr->expression.expr);
   } else assert(0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(expr->expression.expr, 0);
-  po_type_map->insert(expr, tau, 0);
+  PotentialType* tau = po_type_map->lookup(expr->expression.expr);
+  po_type_map->insert(expr, tau);
 }
 
 void PotentialTypePass::visit_castExpression(Ast* cast_expr)
@@ -1135,8 +1129,8 @@ void PotentialTypePass::visit_castExpression(Ast* cast_expr)
 
   visit_typeRef(cast_expr->castExpression.type);
   visit_expression(cast_expr->castExpression.expr, 0);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(cast_expr->castExpression.type, 0);
-  po_type_map->insert(cast_expr, tau, 0);
+  PotentialType* tau = po_type_map->lookup(cast_expr->castExpression.type);
+  po_type_map->insert(cast_expr, tau);
 }
 
 void PotentialTypePass::visit_unaryExpression(Ast* unary_expr)
@@ -1149,14 +1143,14 @@ void PotentialTypePass::visit_binaryExpression(Ast* binary_expr)
 {
   assert(binary_expr->kind == AstEnum::binaryExpression);
 
-  PotentialType* potential_args = PotentialType_Product::allocate(storage, 2);
+  PotentialType* potential_args = PotentialType_Product::allocate(scratch, 2);
   visit_expression(binary_expr->binaryExpression.left_operand, 0);
   visit_expression(binary_expr->binaryExpression.right_operand, 0);
-  potential_args->product.set(0, (PotentialType*)po_type_map->lookup(binary_expr->binaryExpression.left_operand, 0));
-  potential_args->product.set(1, (PotentialType*)po_type_map->lookup(binary_expr->binaryExpression.right_operand, 0));
+  potential_args->product.set(0, po_type_map->lookup(binary_expr->binaryExpression.left_operand));
+  potential_args->product.set(1, po_type_map->lookup(binary_expr->binaryExpression.right_operand));
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(binary_expr, tau, 0);
+  po_type_map->insert(binary_expr, tau);
   for (NameDeclaration* name_decl = root_scope->lookup_builtin(binary_expr->binaryExpression.strname, NameSpace::Type);
        name_decl != 0; name_decl = name_decl->next_in_scope) {
     Type* ty = name_decl->type;
@@ -1171,7 +1165,7 @@ void PotentialTypePass::visit_memberSelector(Ast* selector, PotentialType* poten
   assert(selector->kind == AstEnum::memberSelector);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(selector, tau, 0);
+  po_type_map->insert(selector, tau);
   if (selector->memberSelector.lhs_expr->kind == AstEnum::expression) {
     visit_expression(selector->memberSelector.lhs_expr, 0);
   } else if (selector->memberSelector.lhs_expr->kind == AstEnum::lvalueExpression) {
@@ -1179,11 +1173,11 @@ void PotentialTypePass::visit_memberSelector(Ast* selector, PotentialType* poten
   } else assert(0);
 
   Ast* name = selector->memberSelector.name;
-  PotentialType* tau_lhs = (PotentialType*)po_type_map->lookup(selector->memberSelector.lhs_expr, 0);
+  PotentialType* tau_lhs = po_type_map->lookup(selector->memberSelector.lhs_expr);
   assert(tau_lhs->kind == PotentialTypeEnum::Set);
 
-  for (MapEntry* m = tau_lhs->set.members.first; m != 0; m = m->next) {
-    Type* lhs_ty = ((Type*)m->key)->effective_type();
+  for (int i = 0; i < tau_lhs->set.count; i++) {
+    Type* lhs_ty = tau_lhs->set.get(i)->effective_type();
     if (lhs_ty->kind == TypeEnum::Extern) {
       type_checker->collect_matching_member(tau, lhs_ty->extern_.methods, name->name.strname, potential_args);
     } else if (lhs_ty->kind == TypeEnum::Enum ||
@@ -1212,8 +1206,8 @@ void PotentialTypePass::visit_arraySubscript(Ast* subscript)
     visit_lvalueExpression(subscript->arraySubscript.lhs_expr, 0);
   } else assert(0);
   visit_indexExpression(subscript->arraySubscript.index_expr);
-  PotentialType* tau = (PotentialType*)po_type_map->lookup(subscript->arraySubscript.lhs_expr, 0);
-  po_type_map->insert(subscript, tau, 0);
+  PotentialType* tau = po_type_map->lookup(subscript->arraySubscript.lhs_expr);
+  po_type_map->insert(subscript, tau);
 }
 
 void PotentialTypePass::visit_indexExpression(Ast* index_expr)
@@ -1225,8 +1219,8 @@ void PotentialTypePass::visit_indexExpression(Ast* index_expr)
     visit_expression(index_expr->indexExpression.end_index, 0);
   }
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(index_expr, tau, 0);
-  tau->set.add((Type*)type_env->lookup(index_expr, 0));
+  po_type_map->insert(index_expr, tau);
+  tau->set.add(type_env->lookup(index_expr));
 }
 
 void PotentialTypePass::visit_booleanLiteral(Ast* bool_literal)
@@ -1234,8 +1228,8 @@ void PotentialTypePass::visit_booleanLiteral(Ast* bool_literal)
   assert(bool_literal->kind == AstEnum::booleanLiteral);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(bool_literal, tau, 0);
-  tau->set.add((Type*)type_env->lookup(bool_literal, 0));
+  po_type_map->insert(bool_literal, tau);
+  tau->set.add(type_env->lookup(bool_literal));
 }
 
 void PotentialTypePass::visit_integerLiteral(Ast* int_literal)
@@ -1243,8 +1237,8 @@ void PotentialTypePass::visit_integerLiteral(Ast* int_literal)
   assert(int_literal->kind == AstEnum::integerLiteral);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(int_literal, tau, 0);
-  tau->set.add((Type*)type_env->lookup(int_literal, 0));
+  po_type_map->insert(int_literal, tau);
+  tau->set.add(type_env->lookup(int_literal));
 }
 
 void PotentialTypePass::visit_stringLiteral(Ast* str_literal)
@@ -1252,8 +1246,8 @@ void PotentialTypePass::visit_stringLiteral(Ast* str_literal)
   assert(str_literal->kind == AstEnum::stringLiteral);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(str_literal, tau, 0);
-  tau->set.add((Type*)type_env->lookup(str_literal, 0));
+  po_type_map->insert(str_literal, tau);
+  tau->set.add(type_env->lookup(str_literal));
 }
 
 void PotentialTypePass::visit_default(Ast* default_)
@@ -1261,8 +1255,8 @@ void PotentialTypePass::visit_default(Ast* default_)
   assert(default_->kind == AstEnum::default_);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(default_, tau, 0);
-  tau->set.add((Type*)type_env->lookup(default_, 0));
+  po_type_map->insert(default_, tau);
+  tau->set.add(type_env->lookup(default_));
 }
 
 void PotentialTypePass::visit_dontcare(Ast* dontcare)
@@ -1270,6 +1264,6 @@ void PotentialTypePass::visit_dontcare(Ast* dontcare)
   assert(dontcare->kind == AstEnum::dontcare);
 
   PotentialType* tau = PotentialType_Set::allocate(storage);
-  po_type_map->insert(dontcare, tau, 0);
-  tau->set.add((Type*)type_env->lookup(dontcare, 0));
+  po_type_map->insert(dontcare, tau);
+  tau->set.add(type_env->lookup(dontcare));
 }
@@ -2,8 +2,8 @@
 
 #include "memory/arena.h"
 #include "adt/array.h"
-#include "adt/map.h"
 #include "frontend/ast.h"
+#include "frontend/lexer.h"
 #include "frontend/scope.h"
 #include "midend/potential_type.h"
 #include "midend/type_checker.h"
@@ -11,15 +11,16 @@
 struct PotentialTypePass {
   /* in */
   Arena* storage;
-  char* source_file;
+  Arena* scratch;
+  SourceText* source_text;
   Ast* p4program;
   Scope* root_scope;
-  Map* scope_map;
-  Map* type_env;
+  AstAttribute<Scope*>* scope_map;
+  AstAttribute<Type*>* type_env;
   TypeChecker* type_checker;
 
   /* out */
-  Map* po_type_map;
+  AstAttribute<PotentialType*>* po_type_map;
 
 /** PROGRAM **/
 
@@ -4,8 +4,7 @@
 void ScopeHierarchyPass::do_pass()
 {
   current_scope = root_scope;
-  scope_map = (Map*)storage->allocate(sizeof(Map), 1);
-  scope_map->storage = storage;
+  scope_map = AstAttribute<Scope*>::allocate(storage, Ast::node_count);
   visit_p4program(p4program);
   assert(current_scope == root_scope);
 }
@@ -16,11 +15,11 @@ void ScopeHierarchyPass::visit_p4program(Ast* p4program)
 {
   assert(p4program->kind == AstEnum::p4program);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(p4program, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(p4program, current_scope);
+  assert(inserted);
   visit_declarationList(p4program->p4program.decl_list);
   current_scope = prev_scope;
 }
@@ -64,9 +63,9 @@ void ScopeHierarchyPass::visit_declaration(Ast* decl)
   } else if (decl->declaration.decl->kind == AstEnum::instantiation) {
     visit_instantiation(decl->declaration.decl);
   } else assert(0);
-  Scope* scope = (Scope*)scope_map->lookup(decl->declaration.decl, 0);
-  MapEntry* m = scope_map->insert(decl, scope, 0);
-  assert(m);
+  Scope* scope = scope_map->lookup(decl->declaration.decl);
+  bool inserted = scope_map->insert(decl, scope);
+  assert(inserted);
 }
 
 void ScopeHierarchyPass::visit_name(Ast* name)
@@ -97,11 +96,11 @@ void ScopeHierarchyPass::visit_packageTypeDeclaration(Ast* type_decl)
 {
   assert(type_decl->kind == AstEnum::packageTypeDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 2);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(type_decl, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(type_decl, current_scope);
+  assert(inserted);
   visit_parameterList(type_decl->packageTypeDeclaration.params);
   current_scope = prev_scope;
 }
@@ -121,9 +120,9 @@ void ScopeHierarchyPass::visit_parserDeclaration(Ast* parser_decl)
 
   visit_typeDeclaration(parser_decl->parserDeclaration.proto);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(parser_decl->parserDeclaration.proto, 0);
-  MapEntry* m = scope_map->insert(parser_decl, current_scope, 0);
-  assert(m);
+  current_scope = scope_map->lookup(parser_decl->parserDeclaration.proto);
+  bool inserted = scope_map->insert(parser_decl, current_scope);
+  assert(inserted);
   if (parser_decl->parserDeclaration.ctor_params) {
     visit_parameterList(parser_decl->parserDeclaration.ctor_params);
   }
@@ -136,11 +135,11 @@ void ScopeHierarchyPass::visit_parserTypeDeclaration(Ast* type_decl)
 {
   assert(type_decl->kind == AstEnum::parserTypeDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 2);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(type_decl, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(type_decl, current_scope);
+  assert(inserted);
   visit_parameterList(type_decl->parserTypeDeclaration.params);
   visit_methodPrototypes(type_decl->parserTypeDeclaration.method_protos);
   current_scope = prev_scope;
@@ -180,11 +179,11 @@ void ScopeHierarchyPass::visit_parserState(Ast* state)
 {
   assert(state->kind == AstEnum::parserState);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(state, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(state, current_scope);
+  assert(inserted);
   visit_parserStatements(state->parserState.stmt_list);
   visit_transitionStatement(state->parserState.transition_stmt);
   current_scope = prev_scope;
@@ -223,11 +222,11 @@ void ScopeHierarchyPass::visit_parserBlockStatement(Ast* block_stmt)
 {
   assert(block_stmt->kind == AstEnum::parserBlockStatement);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(block_stmt, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(block_stmt, current_scope);
+  assert(inserted);
   visit_parserStatements(block_stmt->parserBlockStatement.stmt_list);
   current_scope = prev_scope;
 }
@@ -317,9 +316,9 @@ void ScopeHierarchyPass::visit_controlDeclaration(Ast* control_decl)
 
   visit_typeDeclaration(control_decl->controlDeclaration.proto);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(control_decl->controlDeclaration.proto, 0);
-  MapEntry* m = scope_map->insert(control_decl, current_scope, 0);
-  assert(m);
+  current_scope = scope_map->lookup(control_decl->controlDeclaration.proto);
+  bool inserted = scope_map->insert(control_decl, current_scope);
+  assert(inserted);
   if (control_decl->controlDeclaration.ctor_params) {
     visit_parameterList(control_decl->controlDeclaration.ctor_params);
   }
@@ -332,11 +331,11 @@ void ScopeHierarchyPass::visit_controlTypeDeclaration(Ast* type_decl)
 {
   assert(type_decl->kind == AstEnum::controlTypeDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 2);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(type_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(type_decl, scope);
+  assert(inserted);
   visit_parameterList(type_decl->controlTypeDeclaration.params);
   visit_methodPrototypes(type_decl->controlTypeDeclaration.method_protos);
   current_scope = prev_scope;
@@ -377,20 +376,20 @@ void ScopeHierarchyPass::visit_externDeclaration(Ast* extern_decl)
   } else if (extern_decl->externDeclaration.decl->kind == AstEnum::functionPrototype) {
     visit_functionPrototype(extern_decl->externDeclaration.decl);
   } else assert(0);
-  Scope* scope = (Scope*)scope_map->lookup(extern_decl->externDeclaration.decl, 0);
-  MapEntry* m = scope_map->insert(extern_decl, scope, 0);
-  assert(m);
+  Scope* scope = scope_map->lookup(extern_decl->externDeclaration.decl);
+  bool inserted = scope_map->insert(extern_decl, scope);
+  assert(inserted);
 }
 
 void ScopeHierarchyPass::visit_externTypeDeclaration(Ast* type_decl)
 {
   assert(type_decl->kind == AstEnum::externTypeDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 2);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(type_decl, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(type_decl, current_scope);
+  assert(inserted);
   visit_methodPrototypes(type_decl->externTypeDeclaration.method_protos);
   current_scope = prev_scope;
 }
@@ -412,11 +411,11 @@ void ScopeHierarchyPass::visit_functionPrototype(Ast* func_proto)
   if (func_proto->functionPrototype.return_type) {
     visit_typeRef(func_proto->functionPrototype.return_type);
   }
-  Scope* scope = Scope::allocate(storage, 2);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(func_proto, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(func_proto, current_scope);
+  assert(inserted);
   visit_parameterList(func_proto->functionPrototype.params);
   current_scope = prev_scope;
 }
@@ -556,9 +555,9 @@ void ScopeHierarchyPass::visit_typeDeclaration(Ast* type_decl)
   } else if (type_decl->typeDeclaration.decl->kind == AstEnum::packageTypeDeclaration) {
     visit_packageTypeDeclaration(type_decl->typeDeclaration.decl);
   } else assert(0);
-  Scope* scope = (Scope*)scope_map->lookup(type_decl->typeDeclaration.decl, 0);
-  MapEntry* m = scope_map->insert(type_decl, scope, 0);
-  assert(m);
+  Scope* scope = scope_map->lookup(type_decl->typeDeclaration.decl);
+  bool inserted = scope_map->insert(type_decl, scope);
+  assert(inserted);
 }
 
 void ScopeHierarchyPass::visit_derivedTypeDeclaration(Ast* type_decl)
@@ -574,20 +573,20 @@ void ScopeHierarchyPass::visit_derivedTypeDeclaration(Ast* type_decl)
   } else if (type_decl->derivedTypeDeclaration.decl->kind == AstEnum::enumDeclaration) {
     visit_enumDeclaration(type_decl->derivedTypeDeclaration.decl);
   } else assert(0);
-  Scope* scope = (Scope*)scope_map->lookup(type_decl->derivedTypeDeclaration.decl, 0);
-  MapEntry* m = scope_map->insert(type_decl, scope, 0);
-  assert(m);
+  Scope* scope = scope_map->lookup(type_decl->derivedTypeDeclaration.decl);
+  bool inserted = scope_map->insert(type_decl, scope);
+  assert(inserted);
 }
 
 void ScopeHierarchyPass::visit_headerTypeDeclaration(Ast* header_decl)
 {
   assert(header_decl->kind == AstEnum::headerTypeDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(header_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(header_decl, scope);
+  assert(inserted);
   visit_structFieldList(header_decl->headerTypeDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -596,11 +595,11 @@ void ScopeHierarchyPass::visit_headerUnionDeclaration(Ast* union_decl)
 {
   assert(union_decl->kind == AstEnum::headerUnionDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(union_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(union_decl, scope);
+  assert(inserted);
   visit_structFieldList(union_decl->headerUnionDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -609,11 +608,11 @@ void ScopeHierarchyPass::visit_structTypeDeclaration(Ast* struct_decl)
 {
   assert(struct_decl->kind == AstEnum::structTypeDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(struct_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(struct_decl, scope);
+  assert(inserted);
   visit_structFieldList(struct_decl->structTypeDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -638,11 +637,11 @@ void ScopeHierarchyPass::visit_enumDeclaration(Ast* enum_decl)
 {
   assert(enum_decl->kind == AstEnum::enumDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(enum_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(enum_decl, scope);
+  assert(inserted);
   visit_specifiedIdentifierList(enum_decl->enumDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -651,11 +650,11 @@ void ScopeHierarchyPass::visit_errorDeclaration(Ast* error_decl)
 {
   assert(error_decl->kind == AstEnum::errorDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(error_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(error_decl, scope);
+  assert(inserted);
   visit_identifierList(error_decl->errorDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -664,11 +663,11 @@ void ScopeHierarchyPass::visit_matchKindDeclaration(Ast* match_decl)
 {
   assert(match_decl->kind == AstEnum::matchKindDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(match_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(match_decl, scope);
+  assert(inserted);
   visit_identifierList(match_decl->matchKindDeclaration.fields);
   current_scope = prev_scope;
 }
@@ -784,11 +783,11 @@ void ScopeHierarchyPass::visit_statement(Ast* stmt)
   } else if (stmt->statement.stmt->kind == AstEnum::emptyStatement) {
     ;
   } else if (stmt->statement.stmt->kind == AstEnum::blockStatement) {
-    Scope* scope = Scope::allocate(storage, 3);
+    Scope* scope = Scope::allocate(storage);
     Scope* prev_scope = current_scope;
     current_scope = scope->push(current_scope);
-    MapEntry* m = scope_map->insert(stmt, current_scope, 0);
-    assert(m);
+    bool inserted = scope_map->insert(stmt, current_scope);
+    assert(inserted);
     visit_blockStatement(stmt->statement.stmt);
     current_scope = prev_scope;
   } else if (stmt->statement.stmt->kind == AstEnum::exitStatement) {
@@ -870,11 +869,11 @@ void ScopeHierarchyPass::visit_tableDeclaration(Ast* table_decl)
 {
   assert(table_decl->kind == AstEnum::tableDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 3);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(table_decl, scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(table_decl, scope);
+  assert(inserted);
   visit_tablePropertyList(table_decl->tableDeclaration.prop_list);
   visit_methodPrototypes(table_decl->tableDeclaration.method_protos);
   current_scope = prev_scope;
@@ -958,11 +957,11 @@ void ScopeHierarchyPass::visit_actionDeclaration(Ast* action_decl)
 {
   assert(action_decl->kind == AstEnum::actionDeclaration);
 
-  Scope* scope = Scope::allocate(storage, 2);
+  Scope* scope = Scope::allocate(storage);
   Scope* prev_scope = current_scope;
   current_scope = scope->push(current_scope);
-  MapEntry* m = scope_map->insert(action_decl, current_scope, 0);
-  assert(m);
+  bool inserted = scope_map->insert(action_decl, current_scope);
+  assert(inserted);
   visit_parameterList(action_decl->actionDeclaration.params);
   visit_blockStatement(action_decl->actionDeclaration.stmt);
   current_scope = prev_scope;
@@ -987,9 +986,9 @@ void ScopeHierarchyPass::visit_functionDeclaration(Ast* func_decl)
 
   visit_functionPrototype(func_decl->functionDeclaration.proto);
   Scope* prev_scope = current_scope;
-  current_scope = (Scope*)scope_map->lookup(func_decl->functionDeclaration.proto, 0);
-  MapEntry* m = scope_map->insert(func_decl, current_scope, 0);
-  assert(m);
+  current_scope = scope_map->lookup(func_decl->functionDeclaration.proto);
+  bool inserted = scope_map->insert(func_decl, current_scope);
+  assert(inserted);
   visit_blockStatement(func_decl->functionDeclaration.stmt);
   current_scope = prev_scope;
 }
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "memory/arena.h"
-#include "adt/map.h"
 #include "frontend/ast.h"
 #include "frontend/scope.h"
 
@@ -12,7 +11,7 @@ struct ScopeHierarchyPass {
   Scope* root_scope;
 
   /* out */
-  Map* scope_map;
+  AstAttribute<Scope*>* scope_map;
 
   /* local */
   Scope* current_scope;
@@ -58,24 +58,26 @@ void SelectTypePass::visit_name(Ast* name, Type* required_ty)
 {
   assert(name->kind == AstEnum::name);
 
-  PotentialType* name_tau = (PotentialType*)po_type_map->lookup(name, 0);
+  PotentialType* name_tau = po_type_map->lookup(name);
   assert(name_tau->kind == PotentialTypeEnum::Set);
 
-  if (name_tau->set.members.count() != 1) {
+  if (name_tau->set.count != 1) {
     error("%s:%d:%d: error: failed type check.",
-        source_file, name->line_no, name->column_no);
+        source_text->filename, source_text->line_no_at(name->offset),
+        source_text->column_no_at(name->offset));
   }
   if (required_ty) {
     if (!type_checker->match_type(name_tau, required_ty)) {
       error("%s:%d:%d: error: failed type check.",
-          source_file, name->line_no, name->column_no);
+          source_text->filename, source_text->line_no_at(name->offset),
+          source_text->column_no_at(name->offset));
     } else {
-      Type* name_ty = (Type*)name_tau->set.members.first->key;
-      type_env->insert(name, name_ty->effective_type(), 0);
+      Type* name_ty = name_tau->set.single();
+      type_env->insert(name, name_ty->effective_type());
     }
   } else {
-      Type* name_ty = (Type*)name_tau->set.members.first->key;
-      type_env->insert(name, name_ty->effective_type(), 0);
+      Type* name_ty = name_tau->set.single();
+      type_env->insert(name, name_ty->effective_type());
   }
 }
 
@@ -215,7 +217,7 @@ void SelectTypePass::visit_selectExpression(Ast* select_expr)
   assert(select_expr->kind == AstEnum::selectExpression);
 
   visit_expressionList(select_expr->selectExpression.expr_list, 0);
-  Type* list_ty = (Type*)type_env->lookup(select_expr->selectExpression.expr_list, 0);
+  Type* list_ty = type_env->lookup(select_expr->selectExpression.expr_list);
   visit_selectCaseList(select_expr->selectExpression.case_list, list_ty);
 }
 
@@ -245,9 +247,9 @@ void SelectTypePass::visit_keysetExpression(Ast* keyset_expr, Type* required_ty)
   } else if (keyset_expr->keysetExpression.expr->kind == AstEnum::simpleKeysetExpression) {
     visit_simpleKeysetExpression(keyset_expr->keysetExpression.expr, required_ty);
   } else assert(0);
-  Type* keyset_ty = (Type*)type_env->lookup(keyset_expr->keysetExpression.expr, 0);
+  Type* keyset_ty = type_env->lookup(keyset_expr->keysetExpression.expr);
   assert(keyset_ty);
-  type_env->insert(keyset_expr, keyset_ty, 0);
+  type_env->insert(keyset_expr, keyset_ty);
 }
 
 void SelectTypePass::visit_tupleKeysetExpression(Ast* tuple_expr, Type* required_ty)
@@ -255,8 +257,8 @@ void SelectTypePass::visit_tupleKeysetExpression(Ast* tuple_expr, Type* required
   assert(tuple_expr->kind == AstEnum::tupleKeysetExpression);
 
   visit_simpleExpressionList(tuple_expr->tupleKeysetExpression.expr_list, required_ty);
-  Type* tuple_ty = (Type*)type_env->lookup(tuple_expr->tupleKeysetExpression.expr_list, 0);
-  type_env->insert(tuple_expr, tuple_ty, 0);
+  Type* tuple_ty = type_env->lookup(tuple_expr->tupleKeysetExpression.expr_list);
+  type_env->insert(tuple_expr, tuple_ty);
 }
 
 void SelectTypePass::visit_simpleKeysetExpression(Ast* simple_expr, Type* required_ty)
@@ -265,7 +267,8 @@ void SelectTypePass::visit_simpleKeysetExpression(Ast* simple_expr, Type* requir
 
   if (required_ty->product.count != 1) {
     error("%s:%d:%d: error: failed type check.",
-        source_file, simple_expr->line_no, simple_expr->column_no);
+        source_text->filename, source_text->line_no_at(simple_expr->offset),
+        source_text->column_no_at(simple_expr->offset));
   } else {
     if (simple_expr->simpleKeysetExpression.expr->kind == AstEnum::expression) {
       visit_expression(simple_expr->simpleKeysetExpression.expr, required_ty->product.get(0));
@@ -276,8 +279,8 @@ void SelectTypePass::visit_simpleKeysetExpression(Ast* simple_expr, Type* requir
     } else assert(0);
     Type* simple_ty = Type_Product::append(type_array, storage, 1);
     simple_ty->ast = simple_expr;
-    simple_ty->product.set(0, (Type*)type_env->lookup(simple_expr->simpleKeysetExpression.expr, 0));
-    type_env->insert(simple_expr, simple_ty, 0);
+    simple_ty->product.set(0, type_env->lookup(simple_expr->simpleKeysetExpression.expr));
+    type_env->insert(simple_expr, simple_ty);
   }
 }
 
@@ -301,11 +304,11 @@ void SelectTypePass::visit_simpleExpressionList(Ast* expr_list, Type* required_t
   it.begin(&expr_list->tree);
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    list_ty->product.set(i, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    list_ty->product.set(i, type_env->lookup(Ast::owner_of(tree)));
     i += 1;
   }
   assert(i == list_ty->product.count);
-  type_env->insert(expr_list, list_ty, 0);
+  type_env->insert(expr_list, list_ty);
 }
 
 /** CONTROL **/
@@ -409,14 +412,15 @@ void SelectTypePass::visit_typeRef(Ast* type_ref, Type* required_ty)
   } else if (type_ref->typeRef.type->kind == AstEnum::tupleType) {
     visit_tupleType(type_ref->typeRef.type);
   } else assert(0);
-  Type* ref_ty = (Type*)type_env->lookup(type_ref->typeRef.type, 0);
+  Type* ref_ty = type_env->lookup(type_ref->typeRef.type);
   if (required_ty) {
     if (!type_checker->type_equiv(ref_ty, required_ty)) {
       error("%s:%d:%d: error: failed type check.",
-          source_file, type_ref->line_no, type_ref->column_no);
+          source_text->filename, source_text->line_no_at(type_ref->offset),
+          source_text->column_no_at(type_ref->offset));
     }
   }
-  type_env->insert(type_ref, ref_ty, 0);
+  type_env->insert(type_ref, ref_ty);
 }
 
 void SelectTypePass::visit_tupleType(Ast* type_decl)
@@ -438,7 +442,7 @@ void SelectTypePass::visit_baseTypeBoolean(Ast* bool_type)
   assert(bool_type->kind == AstEnum::baseTypeBoolean);
 
   Type* bool_ty = root_scope->lookup_builtin("bool", NameSpace::Type)->type;
-  type_env->insert(bool_type, bool_ty, 0);
+  type_env->insert(bool_type, bool_ty);
 }
 
 void SelectTypePass::visit_baseTypeInteger(Ast* int_type)
@@ -449,7 +453,7 @@ void SelectTypePass::visit_baseTypeInteger(Ast* int_type)
     visit_integerTypeSize(int_type->baseTypeInteger.size);
   }
   Type* int_ty = root_scope->lookup_builtin("int", NameSpace::Type)->type;
-  type_env->insert(int_type, int_ty, 0);
+  type_env->insert(int_type, int_ty);
 }
 
 void SelectTypePass::visit_baseTypeBit(Ast* bit_type)
@@ -460,7 +464,7 @@ void SelectTypePass::visit_baseTypeBit(Ast* bit_type)
     visit_integerTypeSize(bit_type->baseTypeBit.size);
   }
   Type* bit_ty = root_scope->lookup_builtin("bit", NameSpace::Type)->type;
-  type_env->insert(bit_type, bit_ty, 0);
+  type_env->insert(bit_type, bit_ty);
 }
 
 void SelectTypePass::visit_baseTypeVarbit(Ast* varbit_type)
@@ -469,7 +473,7 @@ void SelectTypePass::visit_baseTypeVarbit(Ast* varbit_type)
 
   Type* varbit_ty = root_scope->lookup_builtin("varbit", NameSpace::Type)->type;
   visit_integerTypeSize(varbit_type->baseTypeVarbit.size);
-  type_env->insert(varbit_type, varbit_ty, 0);
+  type_env->insert(varbit_type, varbit_ty);
 }
 
 void SelectTypePass::visit_baseTypeString(Ast* string_type)
@@ -477,7 +481,7 @@ void SelectTypePass::visit_baseTypeString(Ast* string_type)
   assert(string_type->kind == AstEnum::baseTypeString);
 
   Type* string_ty = root_scope->lookup_builtin("string", NameSpace::Type)->type;
-  type_env->insert(string_type, string_ty, 0);
+  type_env->insert(string_type, string_ty);
 }
 
 void SelectTypePass::visit_baseTypeVoid(Ast* void_type)
@@ -485,7 +489,7 @@ void SelectTypePass::visit_baseTypeVoid(Ast* void_type)
   assert(void_type->kind == AstEnum::baseTypeVoid);
 
   Type* void_ty = root_scope->lookup_builtin("void", NameSpace::Type)->type;
-  type_env->insert(void_type, void_ty, 0);
+  type_env->insert(void_type, void_ty);
 }
 
 void SelectTypePass::visit_baseTypeError(Ast* error_type)
@@ -493,7 +497,7 @@ void SelectTypePass::visit_baseTypeError(Ast* error_type)
   assert(error_type->kind == AstEnum::baseTypeError);
 
   Type* error_ty = root_scope->lookup_builtin("error", NameSpace::Type)->type;
-  type_env->insert(error_type, error_ty, 0);
+  type_env->insert(error_type, error_ty);
 }
 
 void SelectTypePass::visit_integerTypeSize(Ast* type_size)
@@ -562,8 +566,8 @@ void SelectTypePass::visit_derivedTypeDeclaration(Ast* type_decl)
   } else if (type_decl->derivedTypeDeclaration.decl->kind == AstEnum::enumDeclaration) {
     visit_enumDeclaration(type_decl->derivedTypeDeclaration.decl);
   } else assert(0);
-  Type* decl_ty = (Type*)type_env->lookup(type_decl->derivedTypeDeclaration.decl, 0);
-  type_env->insert(type_decl, decl_ty, 0);
+  Type* decl_ty = type_env->lookup(type_decl->derivedTypeDeclaration.decl);
+  type_env->insert(type_decl, decl_ty);
 }
 
 void SelectTypePass::visit_headerTypeDeclaration(Ast* header_decl)
@@ -644,8 +648,8 @@ void SelectTypePass::visit_typedefDeclaration(Ast* typedef_decl, Type* required_
   } else if (typedef_decl->typedefDeclaration.type_ref->kind == AstEnum::derivedTypeDeclaration) {
     visit_derivedTypeDeclaration(typedef_decl->typedefDeclaration.type_ref);
   } else assert(0);
-  Type* ref_ty = (Type*)type_env->lookup(typedef_decl->typedefDeclaration.type_ref, 0);
-  type_env->insert(typedef_decl, ref_ty, 0);
+  Type* ref_ty = type_env->lookup(typedef_decl->typedefDeclaration.type_ref);
+  type_env->insert(typedef_decl, ref_ty);
 }
 
 /** STATEMENTS **/
@@ -659,7 +663,7 @@ void SelectTypePass::visit_assignmentStatement(Ast* assign_stmt)
   } else if (assign_stmt->assignmentStatement.lhs_expr->kind == AstEnum::lvalueExpression) {
     visit_lvalueExpression(assign_stmt->assignmentStatement.lhs_expr, 0);
   } else assert(0);
-  Type* lhs_ty = (Type*)type_env->lookup(assign_stmt->assignmentStatement.lhs_expr, 0);
+  Type* lhs_ty = type_env->lookup(assign_stmt->assignmentStatement.lhs_expr);
   assert(lhs_ty);
   visit_expression(assign_stmt->assignmentStatement.rhs_expr, lhs_ty);
 }
@@ -675,24 +679,26 @@ void SelectTypePass::visit_functionCall(Ast* func_call, Type* required_ty)
   } else assert(0);
   visit_argumentList(func_call->functionCall.args, 0);
 
-  PotentialType* func_tau = (PotentialType*)po_type_map->lookup(func_call, 0);
+  PotentialType* func_tau = po_type_map->lookup(func_call);
   assert(func_tau->kind == PotentialTypeEnum::Set);
 
-  if (func_tau->set.members.count() != 1) {
+  if (func_tau->set.count != 1) {
     error("%s:%d:%d: error: failed type check.",
-        source_file, func_call->line_no, func_call->column_no);
+        source_text->filename, source_text->line_no_at(func_call->offset),
+        source_text->column_no_at(func_call->offset));
   }
   if (required_ty) {
     if (!type_checker->match_type(func_tau, required_ty)) {
       error("%s:%d:%d: error: failed type check.",
-            source_file, func_call->line_no, func_call->column_no);
+            source_text->filename, source_text->line_no_at(func_call->offset),
+            source_text->column_no_at(func_call->offset));
     } else {
-      Type* func_ty = (Type*)func_tau->set.members.first->key;
-      type_env->insert(func_call, func_ty->effective_type(), 0);
+      Type* func_ty = func_tau->set.single();
+      type_env->insert(func_call, func_ty->effective_type());
     }
   } else {
-    Type* func_ty = (Type*)func_tau->set.members.first->key;
-    type_env->insert(func_call, func_ty->effective_type(), 0);
+    Type* func_ty = func_tau->set.single();
+    type_env->insert(func_call, func_ty->effective_type());
   }
 }
 
@@ -945,9 +951,9 @@ void SelectTypePass::visit_argument(Ast* arg, Type* required_ty)
   } else if (arg->argument.arg->kind == AstEnum::dontcare) {
     visit_dontcare(arg->argument.arg);
   } else assert(0);
-  Type* arg_ty = (Type*)type_env->lookup(arg->argument.arg, 0);
+  Type* arg_ty = type_env->lookup(arg->argument.arg);
   assert(arg_ty);
-  type_env->insert(arg, arg_ty, 0);
+  type_env->insert(arg, arg_ty);
 }
 
 void SelectTypePass::visit_expressionList(Ast* expr_list, Type* required_ty)
@@ -970,11 +976,11 @@ void SelectTypePass::visit_expressionList(Ast* expr_list, Type* required_ty)
   it.begin(&expr_list->tree);
   for (Tree* tree = it.next();
        tree != 0; tree = it.next()) {
-    list_ty->product.set(i, (Type*)type_env->lookup(Ast::owner_of(tree), 0));
+    list_ty->product.set(i, type_env->lookup(Ast::owner_of(tree)));
     i += 1;
   }
   assert(i == list_ty->product.count);
-  type_env->insert(expr_list, list_ty, 0);
+  type_env->insert(expr_list, list_ty);
 }
 
 void SelectTypePass::visit_lvalueExpression(Ast* lvalue_expr, Type* required_ty)
@@ -988,9 +994,9 @@ void SelectTypePass::visit_lvalueExpression(Ast* lvalue_expr, Type* required_ty)
   } else if (lvalue_expr->lvalueExpression.expr->kind == AstEnum::arraySubscript) {
     visit_arraySubscript(lvalue_expr->lvalueExpression.expr);
   } else assert(0);
-  Type* expr_ty = (Type*)type_env->lookup(lvalue_expr->lvalueExpression.expr, 0);
+  Type* expr_ty = type_env->lookup(lvalue_expr->lvalueExpression.expr);
   assert(expr_ty);
-  type_env->insert(lvalue_expr, expr_ty, 0);
+  type_env->insert(lvalue_expr, expr_ty);
 }
 
 void SelectTypePass::visit_expression(Ast* expr, Type* required_ty)
@@ -1024,9 +1030,9 @@ void SelectTypePass::visit_expression(Ast* expr, Type* required_ty)
   } else if (expr->expression.expr->kind == AstEnum::assignmentStatement) {
     visit_assignmentStatement(expr->expression.expr);
   } else assert(0);
-  Type* expr_ty = (Type*)type_env->lookup(expr->expression.expr, 0);
+  Type* expr_ty = type_env->lookup(expr->expression.expr);
   assert(expr_ty);
-  type_env->insert(expr, expr_ty, 0);
+  type_env->insert(expr, expr_ty);
 }
 
 void SelectTypePass::visit_castExpression(Ast* cast_expr, Type* required_ty)
@@ -1035,8 +1041,8 @@ void SelectTypePass::visit_castExpression(Ast* cast_expr, Type* required_ty)
 
   visit_typeRef(cast_expr->castExpression.type, required_ty);
   visit_expression(cast_expr->castExpression.expr, 0);
-  Type* cast_ty = (Type*)type_env->lookup(cast_expr->castExpression.type, 0);
-  type_env->insert(cast_expr, cast_ty, 0);
+  Type* cast_ty = type_env->lookup(cast_expr->castExpression.type);
+  type_env->insert(cast_expr, cast_ty);
 }
 
 void SelectTypePass::visit_unaryExpression(Ast* unary_expr, Type* required_ty)
@@ -1052,24 +1058,26 @@ void SelectTypePass::visit_binaryExpression(Ast* binary_expr, Type* required_ty)
   visit_expression(binary_expr->binaryExpression.left_operand, required_ty);
   visit_expression(binary_expr->binaryExpression.right_operand, required_ty);
 
-  PotentialType* op_tau = (PotentialType*)po_type_map->lookup(binary_expr, 0);
+  PotentialType* op_tau = po_type_map->lookup(binary_expr);
   assert(op_tau->kind == PotentialTypeEnum::Set);
 
-  if (op_tau->set.members.count() != 1) {
+  if (op_tau->set.count != 1) {
     error("%s:%d:%d: error: failed type check.",
-        source_file, binary_expr->line_no, binary_expr->column_no);
+        source_text->filename, source_text->line_no_at(binary_expr->offset),
+        source_text->column_no_at(binary_expr->offset));
   }
   if (required_ty) {
     if (!type_checker->match_type(op_tau, required_ty)) {
       error("%s:%d:%d: error: failed type check.",
-            source_file, binary_expr->line_no, binary_expr->column_no);
+            source_text->filename, source_text->line_no_at(binary_expr->offset),
+            source_text->column_no_at(binary_expr->offset));
     } else {
-      Type* op_ty = (Type*)op_tau->set.members.first->key;
-      type_env->insert(binary_expr, op_ty->effective_type(), 0);
+      Type* op_ty = op_tau->set.single();
+      type_env->insert(binary_expr, op_ty->effective_type());
     }
   } else {
-    Type* op_ty = (Type*)op_tau->set.members.first->key;
-    type_env->insert(binary_expr, op_ty->effective_type(), 0);
+    Type* op_ty = op_tau->set.single();
+    type_env->insert(binary_expr, op_ty->effective_type());
   }
 }
 
@@ -1083,24 +1091,26 @@ void SelectTypePass::visit_memberSelector(Ast* selector, Type* required_ty)
     visit_lvalueExpression(selector->memberSelector.lhs_expr, 0);
   } else assert(0);
 
-  PotentialType* selector_tau = (PotentialType*)po_type_map->lookup(selector, 0);
+  PotentialType* selector_tau = po_type_map->lookup(selector);
   assert(selector_tau->kind == PotentialTypeEnum::Set);
 
-  if (selector_tau->set.members.count() != 1) {
+  if (selector_tau->set.count != 1) {
     error("%s:%d:%d: error: failed type check.",
-        source_file, selector->line_no, selector->column_no);
+        source_text->filename, source_text->line_no_at(selector->offset),
+        source_text->column_no_at(selector->offset));
   }
   if (required_ty) {
     if (!type_checker->match_type(selector_tau, required_ty)) {
       error("%s:%d:%d: error: failed type check.",
-            source_file, selector->line_no, selector->column_no);
+            source_text->filename, source_text->line_no_at(selector->offset),
+            source_text->column_no_at(selector->offset));
     } else {
-      Type* selector_ty = (Type*)selector_tau->set.members.first->key;
-      type_env->insert(selector, selector_ty->effective_type(), 0);
+      Type* selector_ty = selector_tau->set.single();
+      type_env->insert(selector, selector_ty->effective_type());
     }
   } else {
-    Type* selector_ty = (Type*)selector_tau->set.members.first->key;
-    type_env->insert(selector, selector_ty->effective_type(), 0);
+    Type* selector_ty = selector_tau->set.single();
+    type_env->insert(selector, selector_ty->effective_type());
   }
 }
 
@@ -1114,8 +1124,8 @@ void SelectTypePass::visit_arraySubscript(Ast* subscript)
     visit_lvalueExpression(subscript->arraySubscript.lhs_expr, 0);
   } else assert(0);
   visit_indexExpression(subscript->arraySubscript.index_expr);
-  Type* lhs_ty = (Type*)type_env->lookup(subscript->arraySubscript.lhs_expr, 0);
-  type_env->insert(subscript, lhs_ty, 0);
+  Type* lhs_ty = type_env->lookup(subscript->arraySubscript.lhs_expr);
+  type_env->insert(subscript, lhs_ty);
 }
 
 void SelectTypePass::visit_indexExpression(Ast* index_expr)
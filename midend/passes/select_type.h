@@ -1,22 +1,22 @@
 #pragma once
 
 #include "memory/arena.h"
-#include "adt/map.h"
 #include "frontend/scope.h"
 #include "frontend/ast.h"
+#include "frontend/lexer.h"
 #include "midend/type_checker.h"
 
 struct SelectTypePass {
   /* in */
   Arena* storage;
-  char* source_file;
+  SourceText* source_text;
   Ast* p4program;
   Scope* root_scope;
-  Map* scope_map;
-  Array* type_array;
-  Map* type_env;
+  AstAttribute<Scope*>* scope_map;
+  SegmentedArray<Type>* type_array;
+  AstAttribute<Type*>* type_env;
   TypeChecker* type_checker;
-  Map* po_type_map;
+  AstAttribute<PotentialType*>* po_type_map;
 
 /** PROGRAM **/
 
@@ -2,24 +2,84 @@
 
 PotentialType* PotentialType_Set::allocate(Arena* storage)
 {
-  PotentialType* po_type = (PotentialType*)storage->allocate(sizeof(PotentialType), 1);
+  PotentialType* po_type = storage->allocate<PotentialType>();
   po_type->kind = PotentialTypeEnum::Set;
-  po_type->set.members.storage = storage;
+  po_type->set.storage = storage;
+  po_type->set.capacity = POTENTIAL_TYPE_INLINE;
   return po_type;
 }
 
-void PotentialType_Set::add(Type* ty) {
-  members.insert(ty, 0, 0);
-};
+bool PotentialType_Set::contains(Type* ty)
+{
+  if (member_index) {
+    MapEntry* m;
+    member_index->lookup(ty, &m);
+    return m != 0;
+  }
+  for (int i = 0; i < count; i++) {
+    if (get(i) == ty) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PotentialType_Set::add(Type* ty)
+{
+  if (contains(ty)) {
+    return;
+  }
+  if (count < POTENTIAL_TYPE_INLINE) {
+    inline_members[count++] = ty;
+    return;
+  }
+  if (count == capacity) {
+    Type** new_members = storage->allocate<Type*>(2 * capacity);
+    for (int i = 0; i < count; i++) {
+      new_members[i] = get(i);
+    }
+    members = new_members;
+    capacity = 2 * capacity;
+  }
+  members[count++] = ty;
+  if (count == POTENTIAL_TYPE_INDEXED) {
+    member_index = Map::allocate(storage, 2 * POTENTIAL_TYPE_INDEXED);
+    for (int i = 0; i < count; i++) {
+      member_index->insert(members[i], 0, 0);
+    }
+  } else if (member_index) {
+    member_index->insert(ty, 0, 0);
+  }
+}
+
+Type* PotentialType_Set::get(int i)
+{
+  assert(i >= 0 && i < count);
+  if (members) {
+    return members[i];
+  }
+  return inline_members[i];
+}
+
+/**
+ * The only member of the set, or 0 if it has none or several.
+ **/
+Type* PotentialType_Set::single()
+{
+  if (count != 1) {
+    return 0;
+  }
+  return inline_members[0];
+}
 
 PotentialType* PotentialType_Product::allocate(Arena* storage, int arity)
 {
-  PotentialType* po_type = (PotentialType*)storage->allocate(sizeof(PotentialType), 1);
+  PotentialType* po_type = storage->allocate<PotentialType>();
   po_type->kind = PotentialTypeEnum::Product;
   po_type->product.arity = arity;
   po_type->product.members = 0;
   if (arity > 0) {
-    po_type->product.members = (PotentialType**)storage->allocate(sizeof(PotentialType*), arity);
+    po_type->product.members = storage->allocate<PotentialType*>(arity);
   }
   return po_type;
 }
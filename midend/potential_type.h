@@ -11,11 +11,27 @@ enum class PotentialTypeEnum : int {
 
 struct PotentialType;
 
+/**
+ * Most sets hold one or two types, which are kept inline. Larger sets
+ * move the members to an arena array, and past POTENTIAL_TYPE_INDEXED
+ * members the membership test goes through a Map.
+ **/
+#define POTENTIAL_TYPE_INLINE   3
+#define POTENTIAL_TYPE_INDEXED  8
+
 struct PotentialType_Set {
-  Map members;
+  Arena* storage;
+  int count;
+  int capacity;
+  Type** members;
+  Map* member_index;
+  Type* inline_members[POTENTIAL_TYPE_INLINE];
 
   static PotentialType* allocate(Arena* storage);
+  bool contains(Type* ty);
   void add(Type* ty);
+  Type* get(int i);
+  Type* single();
 };
 
 struct PotentialType_Product {
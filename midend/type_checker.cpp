@@ -1,9 +1,9 @@
-#include "adt/cstring.h"
+#include "adt/atom.h"
 #include "midend/type_checker.h"
 
 void TypeChecker::allocate(Arena* storage)
 {
-  type_equiv_pairs = Array::allocate(storage, sizeof(Type), 2);
+  type_equiv_pairs = SegmentedArray<Type>::allocate(storage, 2);
 }
 
 bool TypeChecker::match_type(PotentialType* potential_types, Type* required_ty)
@@ -11,8 +11,8 @@ bool TypeChecker::match_type(PotentialType* potential_types, Type* required_ty)
   assert(potential_types->kind == PotentialTypeEnum::Set);
 
   int i = 0;
-  for (MapEntry* m = potential_types->set.members.first; m != 0; m = m->next) {
-    Type* ty = ((Type*)m->key)->effective_type();
+  for (int j = 0; j < potential_types->set.count; j++) {
+    Type* ty = potential_types->set.get(j)->effective_type();
     if (type_equiv(ty, required_ty->actual_type())) {
       i += 1;
     }
@@ -39,14 +39,14 @@ void TypeChecker::collect_matching_member(PotentialType* tau, Type* product_ty,
 
   for (int i = 0; i < product_ty->product.count; i++) {
     Type* member_ty = product_ty->product.get(i);
-    if (cstring::match(member_ty->strname, strname)) {
+    if (atom::match(member_ty->strname, strname)) {
       if (member_ty->kind == TypeEnum::Function) {
         assert(potential_args->kind == PotentialTypeEnum::Product);
         if (match_params(potential_args, member_ty->function.params)) {
-          tau->set.members.insert(member_ty, 0, 1);
+          tau->set.add(member_ty);
         }
       } else {
-        tau->set.members.insert(member_ty, 0, 1);
+        tau->set.add(member_ty);
       }
     }
   }
@@ -68,7 +68,7 @@ bool TypeChecker::structural_type_equiv(Type* left, Type* right)
   if (left == right) return 1;
 
   for (i = 0; i < type_equiv_pairs->element_count; i++) {
-    type_pair = (Type*)type_equiv_pairs->get(i);
+    type_pair = type_equiv_pairs->get(i);
     assert(type_pair->kind == TypeEnum::Tuple);
     if ((left == type_pair->tuple.left || left == type_pair->tuple.right) &&
         (right == type_pair->tuple.left || right == type_pair->tuple.right)) {
@@ -76,7 +76,7 @@ bool TypeChecker::structural_type_equiv(Type* left, Type* right)
     }
   }
 
-  type_pair = (Type*)type_equiv_pairs->append();
+  type_pair = type_equiv_pairs->append();
   type_pair->kind = TypeEnum::Tuple;
   type_pair->tuple.left = left;
   type_pair->tuple.right = right;
@@ -92,17 +92,17 @@ bool TypeChecker::structural_type_equiv(Type* left, Type* right)
     return 1;
   } else if (left->kind == TypeEnum::Enum) {
     if (right->kind == left->kind) {
-      return cstring::match(left->strname, right->strname);
+      return atom::match(left->strname, right->strname);
     }
     return 0;
   } else if (left->kind == TypeEnum::Extern) {
     if (right->kind == left->kind) {
-      return cstring::match(left->strname, right->strname);
+      return atom::match(left->strname, right->strname);
     }
     return 0;
   } else if (left->kind == TypeEnum::Table) {
     if (right->kind == left->kind) {
-      return cstring::match(left->strname, right->strname);
+      return atom::match(left->strname, right->strname);
     }
     return 0;
   } else if (left->kind == TypeEnum::Product) {
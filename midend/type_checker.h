@@ -5,7 +5,7 @@
 #include "midend/potential_type.h"
 
 struct TypeChecker {
-  Array* type_equiv_pairs;
+  SegmentedArray<Type>* type_equiv_pairs;
 
   void allocate(Arena* storage);
   bool match_type(PotentialType* potential_types, Type* required_ty);
@@ -0,0 +1,93 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "memory/arena.h"
+#include "tests/test.h"
+
+/**
+ * Huge page mode over a pool fragmented into blocks that don't start on a huge
+ * page boundary. Every arena that grows then has to split a free block to align
+ * its pages, and each split takes a descriptor. There are many more splits than
+ * descriptors on a page of descriptor storage, so the storage grows while there
+ * are still misaligned blocks to split.
+ *
+ * The release threshold is above the size of a hole, so the freed blocks keep
+ * their dirty pages until coalescing grows them past it. Their retained size
+ * has to be shared out between the parts of every split, and taken off the
+ * pool's count as the pages are taken.
+ *
+ * It runs on a small stack, so that growing the storage can't recurse once per
+ * misaligned block without overflowing it.
+ **/
+#define HOLE_COUNT        1000
+#define HUGE_ARENA_COUNT  (HOLE_COUNT / 2)
+#define ROUND_COUNT       3
+#define TEST_STACK_SIZE   (64 * KILOBYTE)
+
+static Arena hole_arenas[2 * HOLE_COUNT];
+static Arena huge_arenas[HUGE_ARENA_COUNT];
+static uint64_t* huge_allocations[HUGE_ARENA_COUNT];
+static uint64_t huge_sizes[HUGE_ARENA_COUNT];
+
+static void* run_test(void* arg)
+{
+  int page_size = getpagesize();
+  Memory::set_release_policy(PageRelease::DontNeed, 4 * HUGE_PAGE_SIZE);
+
+  /* Blocks of two huge pages and an odd number of base pages, every other one freed. */
+  for (int i = 0; i < 2 * HOLE_COUNT; i++) {
+    hole_arenas[i].allocate(2 * HUGE_PAGE_SIZE + (1 + 2 * (i % 5)) * page_size, 1);
+  }
+  for (int i = 0; i < 2 * HOLE_COUNT; i += 2) {
+    hole_arenas[i].free();
+  }
+  CHECK(Memory::check_retained());
+
+  Memory::use_huge_pages();
+
+  for (int round = 0; round < ROUND_COUNT; round++) {
+    for (int i = 0; i < HUGE_ARENA_COUNT; i++) {
+      huge_sizes[i] = HUGE_PAGE_SIZE + (uint64_t)(i % 7) * page_size;
+      huge_allocations[i] = (uint64_t*)huge_arenas[i].allocate(huge_sizes[i], 1);
+      CHECK(huge_allocations[i]);
+      CHECK(((uintptr_t)huge_allocations[i] & (HUGE_PAGE_SIZE - 1)) == 0);
+      uint64_t last = huge_sizes[i] / sizeof(uint64_t) - 1;
+      CHECK(huge_allocations[i][0] == 0 && huge_allocations[i][last] == 0);
+      huge_allocations[i][0] = huge_allocations[i][last] = round * HUGE_ARENA_COUNT + i + 1;
+    }
+    CHECK(Memory::check_retained());
+    /* No two arenas were given the same pages. */
+    for (int i = 0; i < HUGE_ARENA_COUNT; i++) {
+      uint64_t last = huge_sizes[i] / sizeof(uint64_t) - 1;
+      CHECK(huge_allocations[i][0] == (uint64_t)(round * HUGE_ARENA_COUNT + i + 1));
+      CHECK(huge_allocations[i][last] == (uint64_t)(round * HUGE_ARENA_COUNT + i + 1));
+    }
+    /* Odd ones first, so that the pool is fragmented while the even ones go back. */
+    for (int i = 1; i < HUGE_ARENA_COUNT; i += 2) {
+      huge_arenas[i].free();
+    }
+    for (int i = 0; i < HUGE_ARENA_COUNT; i += 2) {
+      huge_arenas[i].free();
+    }
+    CHECK(Memory::check_retained());
+  }
+
+  for (int i = 1; i < 2 * HOLE_COUNT; i += 2) {
+    hole_arenas[i].free();
+  }
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  Memory::reserve(8 * GIGABYTE);
+
+  pthread_attr_t thread_attr;
+  pthread_attr_init(&thread_attr);
+  pthread_attr_setstacksize(&thread_attr, TEST_STACK_SIZE);
+  pthread_t thread;
+  CHECK(pthread_create(&thread, &thread_attr, run_test, 0) == 0);
+  pthread_join(thread, 0);
+  pthread_attr_destroy(&thread_attr);
+  return 0;
+}
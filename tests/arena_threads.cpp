@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include <pthread.h>
+#include "memory/arena.h"
+#include "tests/test.h"
+
+/**
+ * Several threads, each with its own arenas, growing, rewinding and freeing
+ * them against the shared page pool. Every allocation must read as zero, and
+ * keeps the thread's own fill pattern until it is rewound or freed: a page
+ * handed to two threads at once shows up as the other thread's pattern.
+ **/
+#define THREAD_COUNT      4
+#define ROUND_COUNT       200
+#define ALLOCATION_COUNT  48
+
+struct Worker {
+  pthread_t thread;
+  int id;
+  int error_count;
+};
+
+static bool check_bytes(uint8_t* bytes, uint32_t size, uint8_t value)
+{
+  for (uint32_t i = 0; i < size; i++) {
+    if (bytes[i] != value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void* run_worker(void* arg)
+{
+  Worker* worker = (Worker*)arg;
+  unsigned int seed = worker->id;
+  uint8_t pattern = (uint8_t)(0x10 + worker->id);
+  Arena arenas[2] = {};
+  uint8_t* allocations[ALLOCATION_COUNT];
+  uint32_t sizes[ALLOCATION_COUNT];
+
+  for (int round = 0; round < ROUND_COUNT; round++) {
+    Arena* arena = &arenas[round % 2];
+    ArenaMark mark = arena->mark();
+    int allocation_count = 1 + rand_r(&seed) % ALLOCATION_COUNT;
+    for (int i = 0; i < allocation_count; i++) {
+      /* Mostly below the page cache size, now and then past it. */
+      sizes[i] = (rand_r(&seed) % 16 == 0) ? PAGE_CACHE_SIZE + rand_r(&seed) % PAGE_CACHE_SIZE
+                                            : 1 + rand_r(&seed) % 20000;
+      allocations[i] = (uint8_t*)arena->allocate(sizes[i], 1);
+      if (!check_bytes(allocations[i], sizes[i], 0)) {
+        worker->error_count += 1;
+      }
+      memset(allocations[i], pattern, sizes[i]);
+    }
+    sched_yield();
+    for (int i = 0; i < allocation_count; i++) {
+      if (!check_bytes(allocations[i], sizes[i], pattern)) {
+        worker->error_count += 1;
+      }
+    }
+    if (round % 5 == 0) {
+      arena->free();
+    } else {
+      arena->rewind(mark);
+    }
+  }
+  arenas[0].free();
+  arenas[1].free();
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  Memory::reserve(64 * MEGABYTE);
+
+  Worker workers[THREAD_COUNT] = {};
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    workers[i].id = i + 1;
+    CHECK(pthread_create(&workers[i].thread, 0, run_worker, &workers[i]) == 0);
+  }
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    pthread_join(workers[i].thread, 0);
+    if (workers[i].error_count > 0) {
+      printf("thread %d: %d allocations were not zero or were overwritten\n", workers[i].id, workers[i].error_count);
+    }
+    CHECK(workers[i].error_count == 0);
+  }
+  return 0;
+}
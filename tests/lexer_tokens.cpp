@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include "frontend/lexer.h"
+#include "tests/test.h"
+
+/**
+ * Lexes every .p4 file of testdata/ and compares the tokens with a reference
+ * dump: line, column, class and lexeme of each token, and the value of
+ * integer literals. The line and column are looked up in the line table. After a change to the lexer's output that is intended,
+ * the reference is rewritten with -update.
+ *
+ *   test_lexer_tokens <testdata dir> <reference file> [-update]
+ **/
+#define FILE_COUNT_MAX  1024
+
+static int compare_names(const void* a, const void* b)
+{
+  return strcmp(*(char**)a, *(char**)b);
+}
+
+/* Control characters and backslashes are escaped, to keep one token per line. */
+static void dump_lexeme(FILE* out, char* lexeme)
+{
+  for (char* c = lexeme; *c; c++) {
+    if ((uint8_t)*c < 0x20 || *c == '\\') {
+      fprintf(out, "\\x%02x", (uint8_t)*c);
+    } else {
+      fputc(*c, out);
+    }
+  }
+}
+
+static void dump_tokens(FILE* out, char* directory, char* name)
+{
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+
+  Arena storage = {}, scratch = {};
+  SourceText source_text = {};
+  source_text.read_source(&storage, &scratch, path);
+  Lexer lexer = {};
+  lexer.storage = &storage;
+  lexer.scratch = &scratch;
+  lexer.tokenize(&source_text);
+
+  fprintf(out, "%s\n", name);
+  TokenStream* tokens = lexer.tokens;
+  TokenCursor at = {};
+  Token token;
+  for (int i = 0; i < tokens->count(); i++) {
+    tokens->read(&at, &token);
+    /* The reference has no location for the start of input, and no column for comments
+     * and the end of input. */
+    int line_no = 0, column_no = 0;
+    if (token.klass != TokenClass::StartOfInput) {
+      line_no = source_text.line_no_at(token.offset);
+      if (token.klass != TokenClass::Comment && token.klass != TokenClass::EndOfInput) {
+        column_no = source_text.column_no_at(token.offset);
+      }
+    }
+    fprintf(out, "%d:%d %d ", line_no, column_no, (int)token.klass);
+    if (token.lexeme) {
+      dump_lexeme(out, token.lexeme);
+    }
+    if (token.klass == TokenClass::IntegerLiteral) {
+      fprintf(out, " = %s%d'%lld", token.integer.is_signed ? "s" : "u", token.integer.width,
+              (long long)token.integer.value);
+    }
+    fputc('\n', out);
+    tokens->advance(&at);
+  }
+  scratch.free();
+  storage.free();
+}
+
+static char* read_file(char* path, size_t* size)
+{
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    return 0;
+  }
+  fseek(file, 0, SEEK_END);
+  *size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char* contents = (char*)malloc(*size + 1);
+  CHECK(fread(contents, 1, *size, file) == *size);
+  contents[*size] = '\0';
+  fclose(file);
+  return contents;
+}
+
+int main(int argc, char* argv[])
+{
+  CHECK(argc >= 3);
+  char* directory = argv[1];
+  char* reference_path = argv[2];
+  bool update = (argc > 3 && strcmp(argv[3], "-update") == 0);
+
+  Memory::reserve(1 * GIGABYTE);
+
+  char* names[FILE_COUNT_MAX];
+  int name_count = 0;
+  DIR* dir = opendir(directory);
+  CHECK(dir);
+  for (struct dirent* entry = readdir(dir); entry != 0; entry = readdir(dir)) {
+    int len = strlen(entry->d_name);
+    if (len > 3 && strcmp(entry->d_name + len - 3, ".p4") == 0) {
+      CHECK(name_count < FILE_COUNT_MAX);
+      names[name_count++] = strdup(entry->d_name);
+    }
+  }
+  closedir(dir);
+  qsort(names, name_count, sizeof(char*), compare_names);
+
+  char* dump = 0;
+  size_t dump_size = 0;
+  FILE* out = open_memstream(&dump, &dump_size);
+  for (int i = 0; i < name_count; i++) {
+    dump_tokens(out, directory, names[i]);
+  }
+  fclose(out);
+
+  if (update) {
+    FILE* reference = fopen(reference_path, "w");
+    CHECK(reference);
+    fwrite(dump, 1, dump_size, reference);
+    fclose(reference);
+    printf("%s: %d files.\n", reference_path, name_count);
+    return 0;
+  }
+
+  size_t reference_size = 0;
+  char* reference = read_file(reference_path, &reference_size);
+  CHECK(reference);
+  /* Report the first line that differs. */
+  char* a = dump, *b = reference;
+  int line_no = 1;
+  while (*a && *a == *b) {
+    if (*a == '\n') {
+      line_no += 1;
+    }
+    a++, b++;
+  }
+  if (*a != *b) {
+    while (a > dump && a[-1] != '\n') {
+      a--, b--;
+    }
+    printf("%s:%d: the tokens differ\n  expected: %.*s\n  got:      %.*s\n", reference_path, line_no,
+           (int)strcspn(b, "\n"), b, (int)strcspn(a, "\n"), a);
+  }
+  CHECK(dump_size == reference_size && memcmp(dump, reference, dump_size) == 0);
+  return 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * The tests are plain programs run by ctest: a failed check prints where it
+ * failed and exits with a non-zero status. Unlike `assert`, the checks stay
+ * in whatever the build type.
+ **/
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      exit(1); \
+    } \
+  } while (0)